@@ -0,0 +1,102 @@
+/**
+ * @file SWE_BatchedSolver.hh
+ * @brief Row-batched interface of the Riemann solvers
+ *
+ * The solvers of the submodule compute one edge per call with scalar references,
+ * and keep the states of the edge in their members. The batched solver takes
+ * contiguous rows of states instead and fills contiguous rows of net-updates,
+ * with the interface of the explicitly vectorized f-wave kernel (see SWE_FWaveSIMD.hh).
+ */
+
+#ifndef _SWE_BATCHED_SOLVER_HPP
+#define _SWE_BATCHED_SOLVER_HPP
+
+#include <algorithm>
+#include <type_traits>
+
+class SWE_FWaveBranchFree;
+
+/**
+ * @brief Whether the solver keeps no states of an edge in its members (its computeNetUpdates() is const)
+ */
+template <class RiemannSolver>
+struct IsStatelessSolver : std::false_type {};
+
+template <>
+struct IsStatelessSolver<SWE_FWaveBranchFree> : std::true_type {};
+
+/**
+ * @brief Computes rows of edges with a Riemann solver
+ *
+ * The solvers of the submodule are copied for every edge, so the edges of a row are independent
+ * and the loop over them is free to be vectorized. A stateless solver is shared by all edges instead:
+ * a copy inside the loop would be privatized per SIMD lane, which keeps compilers from vectorizing it.
+ * The template is used with SWE_FWaveBranchFree, solver::AugRie, solver::Hybrid, solver::FWaveVec
+ * and solver::AugRieFun.
+ */
+template <class RiemannSolver>
+class SWE_BatchedSolver
+{
+  private:
+    //! The solver, which is copied for every edge, unless it is stateless
+    RiemannSolver solver;
+
+    //! Solves an edge with a copy of the solver
+    static inline void computeEdge(std::false_type, const RiemannSolver& i_solver,
+        float i_hLeft, float i_hRight, float i_huLeft, float i_huRight, float i_bLeft, float i_bRight,
+        float& o_hUpdateLeft, float& o_hUpdateRight, float& o_huUpdateLeft, float& o_huUpdateRight,
+        float& o_maxEdgeSpeed)
+    {
+        RiemannSolver l_solver(i_solver);
+        l_solver.computeNetUpdates(i_hLeft, i_hRight, i_huLeft, i_huRight, i_bLeft, i_bRight,
+            o_hUpdateLeft, o_hUpdateRight, o_huUpdateLeft, o_huUpdateRight, o_maxEdgeSpeed);
+    }
+
+    //! Solves an edge with the shared solver
+    static inline void computeEdge(std::true_type, const RiemannSolver& i_solver,
+        float i_hLeft, float i_hRight, float i_huLeft, float i_huRight, float i_bLeft, float i_bRight,
+        float& o_hUpdateLeft, float& o_hUpdateRight, float& o_huUpdateLeft, float& o_huUpdateRight,
+        float& o_maxEdgeSpeed)
+    {
+        i_solver.computeNetUpdates(i_hLeft, i_hRight, i_huLeft, i_huRight, i_bLeft, i_bRight,
+            o_hUpdateLeft, o_hUpdateRight, o_huUpdateLeft, o_huUpdateRight, o_maxEdgeSpeed);
+    }
+
+  public:
+    /**
+     * @brief Computes the net-updates of n consecutive edges
+     *
+     * The states may be stored in any type, which converts to float (see ReducedFloat.hh).
+     *
+     * @param n Amount of edges
+     * @return Maximum wave speed of the edges
+     */
+    template <class StorageReal>
+    inline float computeNetUpdates(int n,
+        const StorageReal* i_hLeft, const StorageReal* i_hRight,
+        const StorageReal* i_huLeft, const StorageReal* i_huRight,
+        const StorageReal* i_bLeft, const StorageReal* i_bRight,
+        float* o_hUpdateLeft, float* o_hUpdateRight,
+        float* o_huUpdateLeft, float* o_huUpdateRight)
+    {
+        const IsStatelessSolver<RiemannSolver> l_stateless;
+        float maxWaveSpeed = (float) 0.;
+        #pragma omp simd reduction(max: maxWaveSpeed)
+        for (int k = 0; k < n; k++)
+        {
+            const float l_hLeft = i_hLeft[k], l_hRight = i_hRight[k];
+            const float l_huLeft = i_huLeft[k], l_huRight = i_huRight[k];
+            const float l_bLeft = i_bLeft[k], l_bRight = i_bRight[k];
+            float l_maxEdgeSpeed;
+            computeEdge(l_stateless, solver,
+                l_hLeft, l_hRight, l_huLeft, l_huRight, l_bLeft, l_bRight,
+                o_hUpdateLeft[k], o_hUpdateRight[k], o_huUpdateLeft[k], o_huUpdateRight[k],
+                l_maxEdgeSpeed
+            );
+            maxWaveSpeed = std::max(maxWaveSpeed, l_maxEdgeSpeed);
+        }
+        return maxWaveSpeed;
+    }
+};
+
+#endif
@@ -28,14 +28,27 @@
 
 #include "SWE_Block.hh"
 #include "tools/help.hh"
+#include "tools/FastMath.hh"
+#include "tools/ThreadPool.hh"
 
 #include <cmath>
 #include <iostream>
 #include <cassert>
 #include <limits>
+#include <stdexcept>
 
 // gravitational acceleration
 const float SWE_Block::g = 9.81f;
+// dry tolerance of the activity mask
+const float SWE_Block::tileDryTol = 0.01f;
+
+// the CUDA blocks copy the unknowns to the device as one contiguous chunk,
+// all other blocks use columns padded to full cache lines
+#ifndef CUDA
+static const bool paddedUnknowns = true;
+#else
+static const bool paddedUnknowns = false;
+#endif
 
 /**
  * Constructor: allocate variables for simulation
@@ -45,18 +58,37 @@ const float SWE_Block::g = 9.81f;
  * -> computational domain is [1,..,nx]*[1,..,ny]
  * -> plus ghost cell layer
  *
+ * With deeper ghost layers, nx and ny include the inner l_ghostWidth-1 ghost layers on both sides.
+ *
  * The constructor is protected: no instances of SWE_Block can be 
  * generated.
  *
+ * @param l_nx number of cells of the block in x-direction
+ * @param l_ny number of cells of the block in y-direction
+ * @param l_ghostWidth depth of the ghost layers, at most the number of cells in both directions
  */
 SWE_Block::SWE_Block(int l_nx, int l_ny,
-		float l_dx, float l_dy)
-	: nx(l_nx), ny(l_ny),
+		float l_dx, float l_dy, int l_ghostWidth)
+	: nx(l_nx + 2*(l_ghostWidth-1)), ny(l_ny + 2*(l_ghostWidth-1)),
+	  ghostWidth(l_ghostWidth),
 	  dx(l_dx), dy(l_dy),
-	  h(nx+2,ny+2), hu(nx+2,ny+2), hv(nx+2,ny+2), b(nx+2,ny+2),
+	  h(nx+2,ny+2,true,paddedUnknowns), hu(nx+2,ny+2,true,paddedUnknowns),
+	  hv(nx+2,ny+2,true,paddedUnknowns), b(nx+2,ny+2,true,paddedUnknowns),
+#if defined(STORAGE_FP16) || defined(STORAGE_BF16)
+	  hOutput(nx+2,ny+2), huOutput(nx+2,ny+2), hvOutput(nx+2,ny+2), bOutput(nx+2,ny+2),
+#endif
 	  // This three are only set here, so eclipse does not complain
-	  maxTimestep(0), offsetX(0), offsetY(0)
+	  maxTimestep(0), offsetX(0), offsetY(0),
+	  tileSize(defaultTileSize),
+	  nTilesX((nx + tileSize - 1) / tileSize), nTilesY((ny + tileSize - 1) / tileSize),
+	  tileStates(nTilesX * nTilesY), activeTiles(nTilesX * nTilesY, 1),
+	  waveFrontTracking(false), restTolerance(0), skippedCells(0), skippedCellsOfAdvance(0),
+	  threadPool(NULL)
 {
+  // the mirrored boundary conditions need as many cells as ghost layers
+  if (l_ghostWidth < 1 || l_ghostWidth > std::min(l_nx, l_ny))
+    throw std::runtime_error("The ghost layers are deeper than the block");
+
   // set WALL as default boundary condition
   for (int i=0; i<4; i++) {
      boundary[i] = PASSIVE;
@@ -90,8 +122,9 @@ SWE_Block::~SWE_Block() {
 void SWE_Block::initScenario( float _offsetX, float _offsetY, SWE_Scenario &i_scenario,
   const bool i_multipleBlocks) 
 {
-	offsetX = _offsetX;
-	offsetY = _offsetY;
+	// the origin of the arrays lies in front of the inner ghost layers
+	offsetX = _offsetX - (ghostWidth-1)*dx;
+	offsetY = _offsetY - (ghostWidth-1)*dy;
   bool useData = i_scenario.providesRawData();
 
 
@@ -128,6 +161,9 @@ void SWE_Block::initScenario( float _offsetX, float _offsetY, SWE_Scenario &i_sc
     setBoundaryType(BND_TOP, i_scenario.getBoundaryType(BND_TOP));
   }
 
+  // the activity mask is rebuilt from the new water heights
+  resetTileActivity();
+
   // perform update after external write to variables 
   synchAfterWrite();
 
@@ -144,6 +180,7 @@ void SWE_Block::setWaterHeight(float (*_h)(float, float)) {
       h[i][j] =  _h(offsetX + (i-0.5f)*dx, offsetY + (j-0.5f)*dy);
     };
 
+  resetTileActivity();
   synchWaterHeightAfterWrite();
 }
 
@@ -162,6 +199,7 @@ void SWE_Block::setDischarge(float (*_u)(float, float), float (*_v)(float, float
       hv[i][j] = _v(x,y) * h[i][j]; 
     };
 
+  resetTileActivity();
   synchDischargeAfterWrite();
 }
 
@@ -176,6 +214,7 @@ void SWE_Block::setBathymetry(float _b) {
     for(int j=0; j<=ny+1; j++)
       b[i][j] = _b;
 
+  resetTileActivity();
   synchBathymetryAfterWrite();
 }
 
@@ -190,6 +229,7 @@ void SWE_Block::setBathymetry(float (*_b)(float, float)) {
     for(int j=0; j<=ny+1; j++)
       b[i][j] = _b(offsetX + (i-0.5f)*dx, offsetY + (j-0.5f)*dy);
 
+  resetTileActivity();
   synchBathymetryAfterWrite();
 }
 
@@ -228,7 +268,12 @@ void SWE_Block::setBathymetry(float (*_b)(float, float)) {
  */
 const Float2D& SWE_Block::getWaterHeight() { 
   synchWaterHeightBeforeRead();
+#if defined(STORAGE_FP16) || defined(STORAGE_BF16)
+  convertToFloat(h, hOutput);
+  return hOutput;
+#else
   return h; 
+#endif
 };
 
 /**
@@ -236,7 +281,12 @@ const Float2D& SWE_Block::getWaterHeight() {
  */
 const Float2D& SWE_Block::getDischarge_hu() { 
   synchDischargeBeforeRead();
+#if defined(STORAGE_FP16) || defined(STORAGE_BF16)
+  convertToFloat(hu, huOutput);
+  return huOutput;
+#else
   return hu; 
+#endif
 };
 
 /**
@@ -244,7 +294,12 @@ const Float2D& SWE_Block::getDischarge_hu() {
  */
 const Float2D& SWE_Block::getDischarge_hv() { 
   synchDischargeBeforeRead();
+#if defined(STORAGE_FP16) || defined(STORAGE_BF16)
+  convertToFloat(hv, hvOutput);
+  return hvOutput;
+#else
   return hv;
+#endif
 };
 
 /**
@@ -252,7 +307,12 @@ const Float2D& SWE_Block::getDischarge_hv() {
  */
 const Float2D& SWE_Block::getBathymetry() { 
   synchBathymetryBeforeRead();
+#if defined(STORAGE_FP16) || defined(STORAGE_BF16)
+  convertToFloat(b, bOutput);
+  return bOutput;
+#else
   return b; 
+#endif
 };
 
 //==================================================================
@@ -304,6 +364,36 @@ SWE_Block::simulate (float i_tStart, float i_tEnd)
 	return t;
 }
 
+/**
+ * advance runs the time steps between two outputs within the block;
+ * this default implementation calls the virtual methods of the numerical method
+ * for every step, subclasses may run all steps within one parallel region.
+ * @param	io_time	simulation time, advanced by the time steps
+ * @param	i_tEnd	time of the next output
+ * @param	i_maxSteps	maximum number of time steps
+ * @return	number of time steps done
+ */
+int
+SWE_Block::advance (float& io_time, float i_tEnd, int i_maxSteps)
+{
+	int steps = 0;
+	skippedCellsOfAdvance = 0;
+	for (; steps < i_maxSteps && io_time < i_tEnd; steps++) {
+		//set values in ghost cells
+		setGhostLayer ();
+
+		// compute numerical fluxes for every edge
+		// -> computeNumericalFluxes might update maxTimestep
+		computeNumericalFluxes ();
+		// update unknowns accordingly
+		updateUnknowns (maxTimestep);
+		io_time += maxTimestep;
+		skippedCellsOfAdvance += skippedCells;
+	}
+
+	return steps;
+}
+
 /**
  * Set the boundary type for specific block boundary.
  *
@@ -314,6 +404,9 @@ SWE_Block::simulate (float i_tStart, float i_tEnd)
 void SWE_Block::setBoundaryType( const BoundaryEdge i_edge,
                                  const BoundaryType i_boundaryType,
                                  const SWE_Block1D* i_inflow) {
+	// a CONNECT proxy covers only a single ghost layer
+	assert(i_boundaryType != CONNECT || ghostWidth == 1);
+
 	boundary[i_edge] = i_boundaryType;
 	neighbour[i_edge] = i_inflow;
 
@@ -330,30 +423,34 @@ void SWE_Block::setBoundaryType( const BoundaryEdge i_edge,
  */
 void SWE_Block::setBoundaryBathymetry()
 {
-	// set bathymetry values in the ghost layer, if necessary
-	if( boundary[BND_LEFT] == OUTFLOW || boundary[BND_LEFT] == WALL ) {
-		memcpy(b[0], b[1], sizeof(float)*(ny+2));
-	}
-	if( boundary[BND_RIGHT] == OUTFLOW || boundary[BND_RIGHT] == WALL ) {
-		memcpy(b[nx+1], b[nx], sizeof(float)*(ny+2));
-	}
-	if( boundary[BND_BOTTOM] == OUTFLOW || boundary[BND_BOTTOM] == WALL ) {
-		for(int i=0; i<=nx+1; i++) {
-			b[i][0] = b[i][1];
+	// set bathymetry values in the ghost layers, if necessary (mirrored as in setBoundaryConditions())
+	for(int d=0; d<ghostWidth; d++) {
+		if( boundary[BND_LEFT] == OUTFLOW || boundary[BND_LEFT] == WALL ) {
+			memcpy(b[ghostWidth-1-d], b[ghostWidth+d], sizeof(float)*(ny+2));
+		}
+		if( boundary[BND_RIGHT] == OUTFLOW || boundary[BND_RIGHT] == WALL ) {
+			memcpy(b[nx+2-ghostWidth+d], b[nx+1-ghostWidth-d], sizeof(float)*(ny+2));
 		}
 	}
-	if( boundary[BND_TOP] == OUTFLOW || boundary[BND_TOP] == WALL ) {
-		for(int i=0; i<=nx+1; i++) {
-			b[i][ny+1] = b[i][ny];
+	for(int d=0; d<ghostWidth; d++) {
+		if( boundary[BND_BOTTOM] == OUTFLOW || boundary[BND_BOTTOM] == WALL ) {
+			for(int i=0; i<=nx+1; i++) {
+				b[i][ghostWidth-1-d] = b[i][ghostWidth+d];
+			}
+		}
+		if( boundary[BND_TOP] == OUTFLOW || boundary[BND_TOP] == WALL ) {
+			for(int i=0; i<=nx+1; i++) {
+				b[i][ny+2-ghostWidth+d] = b[i][ny+1-ghostWidth-d];
+			}
 		}
 	}
 
 
 	// set corner values
-        b[0][0]       = b[1][1];
-        b[0][ny+1]    = b[1][ny];
-        b[nx+1][0]    = b[nx][1];
-        b[nx+1][ny+1] = b[nx][ny];
+	setCornerGhostCells(b);
+
+	// the tiles at rest depend on the bathymetry
+	resetTileActivity();
 
 	// synchronize after an external update of the bathymetry
 	synchBathymetryAfterWrite();
@@ -365,16 +462,26 @@ void SWE_Block::setBoundaryBathymetry()
  * @return	a SWE_Block1D object that contains row variables h, hu, and hv
  */
 SWE_Block1D* SWE_Block::registerCopyLayer(BoundaryEdge edge){
+  return registerCopyLayer(edge, 0);
+}
+
+/**
+ * register a row or column layer of the block as a "copy layer" for deep ghost layers:
+ * it is copied into the ghost layer of the same depth of the neighbour.
+ * @param	i_depth	distance to the ghost layers, in [0, ghostWidth)
+ * @return	a SWE_Block1D object that contains row variables h, hu, and hv
+ */
+SWE_Block1D* SWE_Block::registerCopyLayer(BoundaryEdge edge, int i_depth){
 
   switch (edge) {
     case BND_LEFT:
-      return new SWE_Block1D( h.getColProxy(1), hu.getColProxy(1), hv.getColProxy(1) );
+      return new SWE_Block1D( h.getColProxy(ghostWidth+i_depth), hu.getColProxy(ghostWidth+i_depth), hv.getColProxy(ghostWidth+i_depth) );
     case BND_RIGHT:
-      return new SWE_Block1D( h.getColProxy(nx), hu.getColProxy(nx), hv.getColProxy(nx) );
+      return new SWE_Block1D( h.getColProxy(nx+1-ghostWidth-i_depth), hu.getColProxy(nx+1-ghostWidth-i_depth), hv.getColProxy(nx+1-ghostWidth-i_depth) );
     case BND_BOTTOM:
-      return new SWE_Block1D( h.getRowProxy(1), hu.getRowProxy(1), hv.getRowProxy(1));
+      return new SWE_Block1D( h.getRowProxy(ghostWidth+i_depth), hu.getRowProxy(ghostWidth+i_depth), hv.getRowProxy(ghostWidth+i_depth));
     case BND_TOP:
-      return new SWE_Block1D( h.getRowProxy(ny), hu.getRowProxy(ny), hv.getRowProxy(ny));
+      return new SWE_Block1D( h.getRowProxy(ny+1-ghostWidth-i_depth), hu.getRowProxy(ny+1-ghostWidth-i_depth), hv.getRowProxy(ny+1-ghostWidth-i_depth));
   };
   return NULL;
 }
@@ -390,17 +497,26 @@ SWE_Block1D* SWE_Block::registerCopyLayer(BoundaryEdge edge){
  * @return	a SWE_Block1D object that contains row variables h, hu, and hv
  */
 SWE_Block1D* SWE_Block::grabGhostLayer(BoundaryEdge edge){
+  return grabGhostLayer(edge, 0);
+}
+
+/**
+ * "grab" one of the deep ghost layers, as grabGhostLayer(BoundaryEdge).
+ * @param	i_depth	distance to the cells of the block, in [0, ghostWidth)
+ * @return	a SWE_Block1D object that contains row variables h, hu, and hv
+ */
+SWE_Block1D* SWE_Block::grabGhostLayer(BoundaryEdge edge, int i_depth){
 
   boundary[edge] = PASSIVE;
   switch (edge) {
     case BND_LEFT:
-      return new SWE_Block1D( h.getColProxy(0), hu.getColProxy(0), hv.getColProxy(0) );
+      return new SWE_Block1D( h.getColProxy(ghostWidth-1-i_depth), hu.getColProxy(ghostWidth-1-i_depth), hv.getColProxy(ghostWidth-1-i_depth) );
     case BND_RIGHT:
-      return new SWE_Block1D( h.getColProxy(nx+1), hu.getColProxy(nx+1), hv.getColProxy(nx+1) );
+      return new SWE_Block1D( h.getColProxy(nx+2-ghostWidth+i_depth), hu.getColProxy(nx+2-ghostWidth+i_depth), hv.getColProxy(nx+2-ghostWidth+i_depth) );
     case BND_BOTTOM:
-      return new SWE_Block1D( h.getRowProxy(0), hu.getRowProxy(0), hv.getRowProxy(0));
+      return new SWE_Block1D( h.getRowProxy(ghostWidth-1-i_depth), hu.getRowProxy(ghostWidth-1-i_depth), hv.getRowProxy(ghostWidth-1-i_depth));
     case BND_TOP:
-      return new SWE_Block1D( h.getRowProxy(ny+1), hu.getRowProxy(ny+1), hv.getRowProxy(ny+1));
+      return new SWE_Block1D( h.getRowProxy(ny+2-ghostWidth+i_depth), hu.getRowProxy(ny+2-ghostWidth+i_depth), hv.getRowProxy(ny+2-ghostWidth+i_depth));
   };
   return NULL;
 }
@@ -422,6 +538,8 @@ void SWE_Block::setGhostLayer() {
 
   // for a CONNECT boundary, data will be copied from a neighbouring
   // SWE_Block (via a SWE_Block1D proxy object)
+  // -> the proxy holds a single layer, deep ghost layers have to be PASSIVE
+  //    and set by the grabbing component (see grabGhostLayer(BoundaryEdge, int))
   // -> these copy operations cannot be executed in GPU/accelerator memory, e.g.
   //    setBoundaryConditions then has to take care that values are copied.
   
@@ -494,10 +612,20 @@ void SWE_Block::computeMaxTimestep( const float i_dryTol,
         float l_momentum = std::max( std::abs( hu[i][j] ),
                                      std::abs( hv[i][j] ) );
 
+#ifdef FAST_MATH
+        // sqrt(g*h) = g*h * rsqrt(g*h) and 1/h = g * rsqrt(g*h)^2
+        const float l_gh = g * h[i][j];
+        const float l_rsqrtGh = fastmath::rsqrt( l_gh );
+        float l_particleVelocity = l_momentum * g * l_rsqrtGh * l_rsqrtGh;
+
+        // approximate the wave speed
+        float l_waveSpeed = l_particleVelocity + l_gh * l_rsqrtGh;
+#else
         float l_particleVelocity = l_momentum / h[i][j];
         
         // approximate the wave speed
         float l_waveSpeed = l_particleVelocity + std::sqrt( g * h[i][j] );
+#endif
         
         l_maximumWaveSpeed = std::max( l_maximumWaveSpeed, l_waveSpeed );
       }
@@ -530,24 +658,29 @@ void SWE_Block::setBoundaryConditions() {
   // CONNECT boundary conditions are set in the calling function setGhostLayer
   // PASSIVE boundary conditions need to be set by the component using SWE_Block
 
+  // WALL and OUTFLOW: the ghost layers mirror the cells at the boundary of the block,
+  // the innermost ghost layer copies the boundary cells
+
   // left boundary
   switch(boundary[BND_LEFT]) {
     case WALL:
     {
-      for(int j=1; j<=ny; j++) {
-        h[0][j] = h[1][j];
-        hu[0][j] = -hu[1][j];
-        hv[0][j] = hv[1][j];
-      };
+      for(int d=0; d<ghostWidth; d++)
+        for(int j=1; j<=ny; j++) {
+          h[ghostWidth-1-d][j] = h[ghostWidth+d][j];
+          hu[ghostWidth-1-d][j] = -hu[ghostWidth+d][j];
+          hv[ghostWidth-1-d][j] = hv[ghostWidth+d][j];
+        };
       break;
     }
     case OUTFLOW:
     {
-      for(int j=1; j<=ny; j++) {
-        h[0][j] = h[1][j];
-        hu[0][j] = hu[1][j];
-        hv[0][j] = hv[1][j];
-      };
+      for(int d=0; d<ghostWidth; d++)
+        for(int j=1; j<=ny; j++) {
+          h[ghostWidth-1-d][j] = h[ghostWidth+d][j];
+          hu[ghostWidth-1-d][j] = hu[ghostWidth+d][j];
+          hv[ghostWidth-1-d][j] = hv[ghostWidth+d][j];
+        };
       break;
     }
     case CONNECT:
@@ -562,20 +695,22 @@ void SWE_Block::setBoundaryConditions() {
   switch(boundary[BND_RIGHT]) {
     case WALL:
     {
-      for(int j=1; j<=ny; j++) {
-        h[nx+1][j] = h[nx][j];
-        hu[nx+1][j] = -hu[nx][j];
-        hv[nx+1][j] = hv[nx][j];
-      };
+      for(int d=0; d<ghostWidth; d++)
+        for(int j=1; j<=ny; j++) {
+          h[nx+2-ghostWidth+d][j] = h[nx+1-ghostWidth-d][j];
+          hu[nx+2-ghostWidth+d][j] = -hu[nx+1-ghostWidth-d][j];
+          hv[nx+2-ghostWidth+d][j] = hv[nx+1-ghostWidth-d][j];
+        };
       break;
     }
     case OUTFLOW:
     {
-      for(int j=1; j<=ny; j++) {
-        h[nx+1][j] = h[nx][j];
-        hu[nx+1][j] = hu[nx][j];
-        hv[nx+1][j] = hv[nx][j];
-      };
+      for(int d=0; d<ghostWidth; d++)
+        for(int j=1; j<=ny; j++) {
+          h[nx+2-ghostWidth+d][j] = h[nx+1-ghostWidth-d][j];
+          hu[nx+2-ghostWidth+d][j] = hu[nx+1-ghostWidth-d][j];
+          hv[nx+2-ghostWidth+d][j] = hv[nx+1-ghostWidth-d][j];
+        };
       break;
     }
     case CONNECT:
@@ -590,20 +725,22 @@ void SWE_Block::setBoundaryConditions() {
   switch(boundary[BND_BOTTOM]) {
     case WALL:
     {
-      for(int i=1; i<=nx; i++) {
-        h[i][0] = h[i][1];
-        hu[i][0] = hu[i][1];
-        hv[i][0] = -hv[i][1];
-      };
+      for(int d=0; d<ghostWidth; d++)
+        for(int i=1; i<=nx; i++) {
+          h[i][ghostWidth-1-d] = h[i][ghostWidth+d];
+          hu[i][ghostWidth-1-d] = hu[i][ghostWidth+d];
+          hv[i][ghostWidth-1-d] = -hv[i][ghostWidth+d];
+        };
       break;
     }
     case OUTFLOW:
     {
-      for(int i=1; i<=nx; i++) {
-        h[i][0] = h[i][1];
-        hu[i][0] = hu[i][1];
-        hv[i][0] = hv[i][1];
-      };
+      for(int d=0; d<ghostWidth; d++)
+        for(int i=1; i<=nx; i++) {
+          h[i][ghostWidth-1-d] = h[i][ghostWidth+d];
+          hu[i][ghostWidth-1-d] = hu[i][ghostWidth+d];
+          hv[i][ghostWidth-1-d] = hv[i][ghostWidth+d];
+        };
       break;
     }
     case CONNECT:
@@ -618,20 +755,22 @@ void SWE_Block::setBoundaryConditions() {
   switch(boundary[BND_TOP]) {
     case WALL:
     {
-      for(int i=1; i<=nx; i++) {
-        h[i][ny+1] = h[i][ny];
-        hu[i][ny+1] = hu[i][ny];
-        hv[i][ny+1] = -hv[i][ny];
-      };
+      for(int d=0; d<ghostWidth; d++)
+        for(int i=1; i<=nx; i++) {
+          h[i][ny+2-ghostWidth+d] = h[i][ny+1-ghostWidth-d];
+          hu[i][ny+2-ghostWidth+d] = hu[i][ny+1-ghostWidth-d];
+          hv[i][ny+2-ghostWidth+d] = -hv[i][ny+1-ghostWidth-d];
+        };
       break;
     }
     case OUTFLOW:
     {
-      for(int i=1; i<=nx; i++) {
-        h[i][ny+1] = h[i][ny];
-        hu[i][ny+1] = hu[i][ny];
-        hv[i][ny+1] = hv[i][ny];
-      };
+      for(int d=0; d<ghostWidth; d++)
+        for(int i=1; i<=nx; i++) {
+          h[i][ny+2-ghostWidth+d] = h[i][ny+1-ghostWidth-d];
+          hu[i][ny+2-ghostWidth+d] = hu[i][ny+1-ghostWidth-d];
+          hv[i][ny+2-ghostWidth+d] = hv[i][ny+1-ghostWidth-d];
+        };
       break;
     }
     case CONNECT:
@@ -668,23 +807,289 @@ void SWE_Block::setBoundaryConditions() {
    *                  **************************
    * </pre>
    */
-  h [0][0] = h [1][1];
-  hu[0][0] = hu[1][1];
-  hv[0][0] = hv[1][1];
+  setCornerGhostCells(h);
+  setCornerGhostCells(hu);
+  setCornerGhostCells(hv);
+}
 
-  h [0][ny+1] = h [1][ny];
-  hu[0][ny+1] = hu[1][ny];
-  hv[0][ny+1] = hv[1][ny];
-  
-  h [nx+1][0] = h [nx][1];
-  hu[nx+1][0] = hu[nx][1];
-  hv[nx+1][0] = hv[nx][1];
+/**
+ * Sets the corner ghost cells of a variable (see setBoundaryConditions()).
+ *
+ * Between two WALL or OUTFLOW boundaries, the whole k x k corner block of deep ghost layers
+ * is mirrored diagonally at the corner cell of the block.
+ * Otherwise, the corner block holds the cells of a neighbour, which are exchanged with the
+ * bottom and top ghost layers (see tools::GhostLayerExchange), and only the outermost corner
+ * cell is set from its diagonal neighbour.
+ *
+ * @param io_q variable, whose corner ghost cells are set.
+ */
+void SWE_Block::setCornerGhostCells(Storage2D& io_q) {
+  const bool l_left   = boundary[BND_LEFT] == WALL || boundary[BND_LEFT] == OUTFLOW;
+  const bool l_right  = boundary[BND_RIGHT] == WALL || boundary[BND_RIGHT] == OUTFLOW;
+  const bool l_bottom = boundary[BND_BOTTOM] == WALL || boundary[BND_BOTTOM] == OUTFLOW;
+  const bool l_top    = boundary[BND_TOP] == WALL || boundary[BND_TOP] == OUTFLOW;
+
+  for(int di=0; di<ghostWidth; di++)
+    for(int dj=0; dj<ghostWidth; dj++) {
+      if (l_left && l_bottom)
+        io_q[ghostWidth-1-di][ghostWidth-1-dj] = io_q[ghostWidth+di][ghostWidth+dj];
+      if (l_left && l_top)
+        io_q[ghostWidth-1-di][ny+2-ghostWidth+dj] = io_q[ghostWidth+di][ny+1-ghostWidth-dj];
+      if (l_right && l_bottom)
+        io_q[nx+2-ghostWidth+di][ghostWidth-1-dj] = io_q[nx+1-ghostWidth-di][ghostWidth+dj];
+      if (l_right && l_top)
+        io_q[nx+2-ghostWidth+di][ny+2-ghostWidth+dj] = io_q[nx+1-ghostWidth-di][ny+1-ghostWidth-dj];
+    }
+
+  // the other corners hold the cells of a neighbour, except for the outermost corner cell
+  if (!(l_left && l_bottom))
+    io_q[0][0] = io_q[1][1];
+  if (!(l_left && l_top))
+    io_q[0][ny+1] = io_q[1][ny];
+  if (!(l_right && l_bottom))
+    io_q[nx+1][0] = io_q[nx][1];
+  if (!(l_right && l_top))
+    io_q[nx+1][ny+1] = io_q[nx][ny];
+}
 
-  h [nx+1][ny+1] = h [nx][ny];
-  hu[nx+1][ny+1] = hu[nx][ny];
-  hv[nx+1][ny+1] = hv[nx][ny];
+/**
+ * Enables or disables the wave-front tracking.
+ *
+ * Without wave-front tracking, only the tiles, which are dry together with their neighbours,
+ * are skipped. With wave-front tracking, the tiles of a sea at rest are skipped as well,
+ * until a wave reaches one of their neighbours. The wave speeds of the skipped tiles do not
+ * limit the time step, they are activated before a wave can enter them.
+ *
+ * @param i_enable enable the wave-front tracking.
+ * @param i_restTolerance maximum deviation of the surface elevation (in m) of a tile at rest.
+ *        The momentum of the cells must be within the momentum of a linear wave of this amplitude.
+ *        Zero requires the sea to be exactly at rest, but then the round-off of the Riemann solvers
+ *        over a varying bathymetry lets the front of active tiles run ahead of the wave.
+ */
+void SWE_Block::setWaveFrontTracking(bool i_enable, float i_restTolerance) {
+  waveFrontTracking = i_enable;
+  restTolerance = i_restTolerance;
+  resetTileActivity();
 }
 
+/**
+ * Sets the edge length of the tiles of the activity mask.
+ * Small tiles skip more cells next to the wet or moving ones, large tiles keep
+ * the inner loops long and the mask small.
+ * All tiles are active afterwards.
+ *
+ * @param i_tileSize edge length of the tiles in cells
+ */
+void SWE_Block::setTileSize(int i_tileSize) {
+  assert(i_tileSize > 0);
+  tileSize = i_tileSize;
+  nTilesX = (nx + tileSize - 1) / tileSize;
+  nTilesY = (ny + tileSize - 1) / tileSize;
+  tileStates.resize(nTilesX * nTilesY);
+  activeTiles.assign(nTilesX * nTilesY, 1);
+}
+
+/**
+ * Marks all tiles of the activity mask as active.
+ * Has to be called after an external update of the unknowns or of the bathymetry,
+ * the next call of updateTileActivity() rescans all tiles.
+ */
+void SWE_Block::resetTileActivity() {
+  std::fill(activeTiles.begin(), activeTiles.end(), 1);
+}
+
+/**
+ * Resets the summary to a tile without cells.
+ */
+void SWE_Block::TileState::clear() {
+  wet = false;
+  atRest = true;
+  etaMin = bDryMin = std::numeric_limits<float>::infinity();
+  etaMax = -std::numeric_limits<float>::infinity();
+}
+
+/**
+ * Adds a cell to the summary of its tile.
+ *
+ * A wet cell is at rest, if its momentum does not exceed the momentum
+ * of a linear wave with an amplitude of the rest tolerance: |(hu,hv)| <= tol * sqrt(g*h).
+ */
+void SWE_Block::TileState::addCell(float i_h, float i_hu, float i_hv, float i_b, float i_restTolerance) {
+  if (i_h >= tileDryTol) {
+    wet = true;
+    atRest = atRest && (i_hu*i_hu + i_hv*i_hv <= i_restTolerance*i_restTolerance * g * i_h);
+    etaMin = std::min(etaMin, i_h + i_b);
+    etaMax = std::max(etaMax, i_h + i_b);
+  } else
+    bDryMin = std::min(bDryMin, i_b);
+}
+
+/**
+ * Updates the activity mask of the tiles.
+ *
+ * An edge between two dry cells yields no net-updates, so the loops may skip all tiles,
+ * which are quiet together with their 8 neighbours: no water can reach such a tile within one
+ * time step (the CFL number is below 1, even when the x- and y-sweep are applied one after another).
+ * A tile is quiet, if it is dry or, with wave-front tracking enabled, if its water is at rest.
+ * Water at rest, but with different surface elevations or above a lower dry cell, starts to flow,
+ * such neighbourhoods stay active.
+ * Only the tiles, which have been active in the last time step, can have changed and are rescanned.
+ * The ghost layers have to be set before, water entering through a boundary activates the adjacent tiles.
+ * Without them, e.g. while they are still received from the neighbours, the ghost cells are not read
+ * and the tiles next to them stay active, until addGhostLayersToTileActivity() adds them.
+ *
+ * @param i_ghostLayersSet wether the ghost layers have been set
+ */
+void SWE_Block::updateTileActivity(bool i_ghostLayersSet) {
+  if (threadPool == NULL) {
+#pragma omp parallel
+    updateTileActivityInTeam(i_ghostLayersSet);
+    return;
+  }
+
+  // the tile columns are balanced among the threads of the pool
+  auto l_scan = [this](int ti, int) { scanTileColumn(ti); };
+  threadPool->run(nTilesX, l_scan);
+  if (i_ghostLayersSet)
+    addGhostCellsToTiles();
+  std::vector<long> l_skipped(threadPool->getNumThreads(), 0);
+  auto l_update = [this, &l_skipped](int ti, int worker) { l_skipped[worker] += updateTileColumnActivity(ti); };
+  threadPool->run(nTilesX, l_update);
+  skippedCells = 0;
+  for(size_t w=0; w<l_skipped.size(); w++)
+    skippedCells += l_skipped[w];
+  if (!i_ghostLayersSet)
+    activateTilesNextToGhostLayers();
+}
+
+/**
+ * Updates the activity mask with the threads of the enclosing parallel region.
+ *
+ * All threads of the team have to call it, its loops are shared among them (orphaned worksharing),
+ * and the mask is complete for all of them on return. Outside of a parallel region,
+ * the calling thread runs all loops.
+ *
+ * @param i_ghostLayersSet wether the ghost layers have been set (see updateTileActivity())
+ */
+void SWE_Block::updateTileActivityInTeam(bool i_ghostLayersSet) {
+
+  // rescan the tiles, which have been updated in the last time step
+#pragma omp for
+  for(int ti=0; ti<nTilesX; ti++)
+    scanTileColumn(ti);
+
+#pragma omp single
+  {
+    if (i_ghostLayersSet)
+      addGhostCellsToTiles();
+    skippedCells = 0;
+  }
+
+  long skipped = 0;
+#pragma omp for nowait
+  for(int ti=0; ti<nTilesX; ti++)
+    skipped += updateTileColumnActivity(ti);
+#pragma omp atomic
+  skippedCells += skipped;
+#pragma omp barrier
+
+  if (!i_ghostLayersSet) {
+#pragma omp single
+    activateTilesNextToGhostLayers();
+  }
+}
+
+/**
+ * Rescans the tiles of the tile column ti, which have been updated in the last time step.
+ */
+void SWE_Block::scanTileColumn(int ti) {
+  for(int tj=0; tj<nTilesY; tj++) {
+    if (!activeTiles[ti*nTilesY + tj])
+      continue;
+    TileState& state = tileStates[ti*nTilesY + tj];
+    state.clear();
+    const int iEnd = std::min((ti+1)*tileSize + 1, nx + 1);
+    // without wave-front tracking, the first wet cell decides
+    for(int i=ti*tileSize + 1; i<iEnd && (waveFrontTracking || !state.wet); i++)
+      for(int j=tileBeginY(tj); j<tileEndY(tj); j++)
+        state.addCell(h[i][j], hu[i][j], hv[i][j], b[i][j], restTolerance);
+  }
+}
+
+/**
+ * Adds the ghost cells to the summaries of the adjacent tiles.
+ */
+void SWE_Block::addGhostCellsToTiles() {
+  for(int j=1; j<=ny; j++) {
+    tileStates[(j-1)/tileSize].addCell(h[0][j], hu[0][j], hv[0][j], b[0][j], restTolerance);
+    tileStates[(nTilesX-1)*nTilesY + (j-1)/tileSize].addCell(h[nx+1][j], hu[nx+1][j], hv[nx+1][j], b[nx+1][j], restTolerance);
+  }
+  for(int i=1; i<=nx; i++) {
+    tileStates[tileX(i)*nTilesY].addCell(h[i][0], hu[i][0], hv[i][0], b[i][0], restTolerance);
+    tileStates[tileX(i)*nTilesY + nTilesY-1].addCell(h[i][ny+1], hu[i][ny+1], hv[i][ny+1], b[i][ny+1], restTolerance);
+  }
+}
+
+/**
+ * Activates the tiles, whose activity depends on the ghost cells: the tiles next to the ghost layers
+ * and their neighbours. The summaries are not changed, addGhostLayersToTileActivity() counts the skipped cells again.
+ */
+void SWE_Block::activateTilesNextToGhostLayers() {
+  for(int ti=0; ti<nTilesX; ti++)
+    for(int tj=0; tj<nTilesY; tj++)
+      if (ti < 2 || ti >= nTilesX-2 || tj < 2 || tj >= nTilesY-2)
+        activeTiles[ti*nTilesY + tj] = 1;
+}
+
+/**
+ * Adds the ghost layers to the activity mask, which has been updated without them before
+ * (see updateTileActivity()), e.g. while they were still received from the neighbours.
+ * If the mask has been updated with older ghost layers instead, the summaries contain the cells of both,
+ * so the mask may be too active, but never misses a tile.
+ */
+void SWE_Block::addGhostLayersToTileActivity() {
+  addGhostCellsToTiles();
+  skippedCells = 0;
+  for(int ti=0; ti<nTilesX; ti++)
+    skippedCells += updateTileColumnActivity(ti);
+}
+
+/**
+ * Updates the activity of the tiles of the tile column ti:
+ * a tile is active, if itself or one of its 8 neighbours is not quiet.
+ * @return number of cells in the skipped tiles of the column
+ */
+long SWE_Block::updateTileColumnActivity(int ti) {
+  long skipped = 0;
+  for(int tj=0; tj<nTilesY; tj++) {
+    bool active = false;
+    float etaMin = std::numeric_limits<float>::infinity();
+    float etaMax = -etaMin, bDryMin = etaMin;
+    for(int ni=std::max(ti-1, 0); ni<=std::min(ti+1, nTilesX-1); ni++)
+      for(int nj=std::max(tj-1, 0); nj<=std::min(tj+1, nTilesY-1); nj++) {
+        const TileState& state = tileStates[ni*nTilesY + nj];
+        active = active || (state.wet && !(waveFrontTracking && state.atRest));
+        etaMin = std::min(etaMin, state.etaMin);
+        etaMax = std::max(etaMax, state.etaMax);
+        bDryMin = std::min(bDryMin, state.bDryMin);
+      }
+    if (waveFrontTracking && etaMin <= etaMax)
+      active = active || etaMax - etaMin > restTolerance || bDryMin < etaMax;
+    activeTiles[ti*nTilesY + tj] = active;
+    if (!active)
+      skipped += (long) (std::min((ti+1)*tileSize, nx) - ti*tileSize) * (tileEndY(tj) - tileBeginY(tj));
+  }
+  return skipped;
+}
+
+/**
+ * Sets the thread pool, which runs the loops of the block instead of OpenMP.
+ * The pool is not owned by the block, NULL selects OpenMP again.
+ * @param i_threadPool thread pool or NULL
+ */
+void SWE_Block::setThreadPool(tools::ThreadPool* i_threadPool) {
+  threadPool = i_threadPool;
+}
 
 //==================================================================
 // protected member functions for memory model: 
@@ -34,11 +34,15 @@
 
 #include <iostream>
 #include <fstream>
+#include <algorithm>
+#include <limits>
+#include <vector>
 
 using namespace std;
 
 // forward declaration
 class SWE_Block1D;
+namespace tools { class ThreadPool; }
 
 /**
  * SWE_Block is the main data structure to compute our shallow water model 
@@ -54,9 +58,12 @@ class SWE_Block1D;
  * - the momentum components #hu and #hv (in x- and y- direction, resp.)
  * - the bathymetry #b
  * 
- * Each of the components is stored as a 2D array, implemented as a Float2D object, 
+ * Each of the components is stored as a 2D array, implemented as a Storage2D object, 
  * and are defined on grid indices [0,..,#nx+1]*[0,..,#ny+1]. 
  * The computational domain is indexed with [1,..,#nx]*[1,..,#ny].
+ * Storage2D is a Float2D, unless the block is built with 16-bit storage of the unknowns
+ * (see ReducedFloat.hh): then every value is converted to float when it is read, so all
+ * computations stay in float, and the get-methods return converted copies.
  * 
  * The mesh sizes of the grid in x- and y-direction are stored in static variables 
  * #dx and #dy. The position of the Cartesian grid in space is stored via the 
@@ -72,6 +79,12 @@ class SWE_Block1D;
  * Cells in the ghost layer have indices 0 or #nx+1 / #ny+1.
  *
  * \image html ghost_cells.gif
+ *
+ * A block may have deeper ghost layers of #ghostWidth k > 1 cells, e.g. for an MPI driver,
+ * which exchanges the ghost layers only every k time steps. The inner k-1 ghost layers are
+ * computed like the cells of the block, so #nx and #ny include them and the arrays stay indexed as above:
+ * the cells of the block are [k,..,#nx+1-k]*[k,..,#ny+1-k]. After s time steps, the ghost layers
+ * hold valid values only up to a depth of k-s, the cells of the block stay valid for k time steps.
  * 
  * <h3>Memory Model:</h3>
  * 
@@ -147,6 +160,10 @@ class SWE_Block {
     virtual SWE_Block1D* registerCopyLayer(BoundaryEdge edge);
     /// "grab" the ghost layer in order to set these values externally
     virtual SWE_Block1D* grabGhostLayer(BoundaryEdge edge);
+    /// return a pointer to proxy class to access the copy layer i_depth cells away from the ghost layers
+    SWE_Block1D* registerCopyLayer(BoundaryEdge edge, int i_depth);
+    /// "grab" the ghost layer i_depth cells away from the cells of the block
+    SWE_Block1D* grabGhostLayer(BoundaryEdge edge, int i_depth);
     
     /// set values in ghost layers
     void setGhostLayer();
@@ -166,6 +183,21 @@ class SWE_Block {
     /// perform the simulation starting with simulation time tStart,
     /// until simulation time tEnd is reached
     virtual float simulate(float tStart, float tEnd);
+
+    /// runs time steps with the maximum allowed time step size, until tEnd or maxSteps is reached
+    /**
+     * The block sets its ghost layers, computes the time step and updates the cells for every step,
+     * without returning to the caller in between, so the caller only has to act at output times.
+     * As in the drivers, the last time step may end after tEnd.
+     * Only simple boundary conditions are set, the copy and ghost layers are not exchanged with
+     * neighbouring blocks (see simulate()).
+     * The cells skipped by the activity mask are summed up over the steps (see getSkippedCellsOfAdvance()).
+     * @param	io_time	simulation time, advanced by the time steps
+     * @param	i_tEnd	time of the next output
+     * @param	i_maxSteps	maximum number of time steps
+     * @return	number of time steps done
+     */
+    virtual int advance(float& io_time, float i_tEnd, int i_maxSteps = std::numeric_limits<int>::max());
     
     /// compute the numerical fluxes for each edge of the Cartesian grid
     /**
@@ -174,6 +206,18 @@ class SWE_Block {
      * in the respective derived classes.
      */
     virtual void computeNumericalFluxes() = 0;
+
+    /// compute the numerical fluxes of the edges, which do not touch the ghost layers
+    /**
+     * Together with computeNumericalFluxesBoundary(), this does the same as computeNumericalFluxes(),
+     * but only the second part reads the ghost layers: they can be received from the neighbouring
+     * blocks, while the interior edges are computed.
+     * The default computes nothing, all edges are computed by computeNumericalFluxesBoundary().
+     */
+    virtual void computeNumericalFluxesInterior() {}
+
+    /// compute the numerical fluxes of the remaining edges and #maxTimestep, after the ghost layers have been set
+    virtual void computeNumericalFluxesBoundary() { computeNumericalFluxes(); }
     
     /// compute the new values of the unknowns h, hu, and hv in all grid cells
     /**
@@ -191,20 +235,43 @@ class SWE_Block {
     int getNx() { return nx; }
     /// returns #ny, i.e. the grid size in y-direction 
     int getNy() { return ny; }
+    /// returns #ghostWidth, the depth of the ghost layers
+    int getGhostWidth() const { return ghostWidth; }
+
+    // wave-front tracking
+    /// additionally skip the tiles, which are at rest together with their neighbours
+    void setWaveFrontTracking(bool i_enable, float i_restTolerance = 0.001f);
+    /// returns the number of cells skipped by the activity mask in the current time step
+    long getSkippedCells() const { return skippedCells; }
+    /// returns the number of cells skipped by the activity mask in all time steps of the last advance()
+    long getSkippedCellsOfAdvance() const { return skippedCellsOfAdvance; }
+    /// sets the edge length of the tiles of the activity mask (in cells)
+    void setTileSize(int i_tileSize);
+    /// returns the edge length of the tiles of the activity mask
+    int getTileSize() const { return tileSize; }
+
+    // parallelization
+    /// runs the loops of the block on a thread pool instead of OpenMP (NULL selects OpenMP), the block does not own it
+    virtual void setThreadPool(tools::ThreadPool* i_threadPool);
+
+    /// public, so blocks created by blocks::createBlock() can be deleted through an SWE_Block pointer
+    virtual ~SWE_Block();
 
   // Konstanten:
     /// static variable that holds the gravity constant (g = 9.81 m/s^2):
     static const float g;
 	
   protected:
-    // Constructor und Destructor
+    // Constructor
     SWE_Block(int l_nx, int l_ny,
-    		float l_dx, float l_dy);
-    virtual ~SWE_Block();
+    		float l_dx, float l_dy, int l_ghostWidth = 1);
 
     // Sets the bathymetry on outflow and wall boundaries
     void setBoundaryBathymetry();
 
+    // Sets the corner ghost cells of a variable
+    void setCornerGhostCells(Storage2D& io_q);
+
     // synchronization Methods
     virtual void synchAfterWrite();
     virtual void synchWaterHeightAfterWrite();
@@ -224,6 +291,7 @@ class SWE_Block {
     // grid size: number of cells (incl. ghost layer in x and y direction:
     int nx;	///< size of Cartesian arrays in x-direction
     int ny;	///< size of Cartesian arrays in y-direction
+    int ghostWidth;	///< depth of the ghost layers, the inner #ghostWidth-1 layers are included in #nx and #ny
     // mesh size dx and dy:
     float dx;	///<  mesh size of the Cartesian grid in x-direction
     float dy;	///<  mesh size of the Cartesian grid in y-direction
@@ -231,10 +299,17 @@ class SWE_Block {
     // define arrays for unknowns: 
     // h (water level) and u,v (velocity in x and y direction)
     // hd, ud, and vd are respective CUDA arrays on GPU
-    Float2D h;	///< array that holds the water height for each element
-    Float2D hu; ///< array that holds the x-component of the momentum for each element (water height h multiplied by velocity in x-direction)
-    Float2D hv; ///< array that holds the y-component of the momentum for each element (water height h multiplied by velocity in y-direction)
-    Float2D b;  ///< array that holds the bathymetry data (sea floor elevation) for each element
+    Storage2D h;	///< array that holds the water height for each element
+    Storage2D hu; ///< array that holds the x-component of the momentum for each element (water height h multiplied by velocity in x-direction)
+    Storage2D hv; ///< array that holds the y-component of the momentum for each element (water height h multiplied by velocity in y-direction)
+    Storage2D b;  ///< array that holds the bathymetry data (sea floor elevation) for each element
+#if defined(STORAGE_FP16) || defined(STORAGE_BF16)
+    // float copies of the unknowns, returned by the get-methods
+    Float2D hOutput;	///< float copy of #h
+    Float2D huOutput;	///< float copy of #hu
+    Float2D hvOutput;	///< float copy of #hv
+    Float2D bOutput;	///< float copy of #b
+#endif
     
     /// type of boundary conditions at LEFT, RIGHT, TOP, and BOTTOM boundary
     BoundaryType boundary[4];
@@ -251,24 +326,98 @@ class SWE_Block {
     // offset of current block
     float offsetX;	///< x-coordinate of the origin (left-bottom corner) of the Cartesian grid
     float offsetY;	///< y-coordinate of the origin (left-bottom corner) of the Cartesian grid
+
+    // activity mask: tiles of tileSize x tileSize cells, which are dry together with their
+    // neighbouring tiles, can be skipped by the flux and update loops
+    /// marks all tiles as active, the next call of updateTileActivity() rescans the whole block
+    void resetTileActivity();
+    /// updates the activity mask, has to be called after setting the ghost layers, unless i_ghostLayersSet is false
+    void updateTileActivity(bool i_ghostLayersSet = true);
+    /// updates the activity mask with the threads of the enclosing parallel region, which all have to call it
+    void updateTileActivityInTeam(bool i_ghostLayersSet = true);
+    /// rescans the tiles of the tile column ti, which have been active in the last time step
+    void scanTileColumn(int ti);
+    /// adds the ghost cells to the summaries of the adjacent tiles
+    void addGhostCellsToTiles();
+    /// activates the tiles, whose activity depends on the ghost cells
+    void activateTilesNextToGhostLayers();
+    /// adds the ghost layers, which have been set after updateTileActivity(), to the activity mask
+    void addGhostLayersToTileActivity();
+    /// updates the activity of the tiles of the tile column ti, returns the number of cells in its skipped tiles
+    long updateTileColumnActivity(int ti);
+
+    /// returns the tile column of the cell column i (ghost cells belong to the adjacent tiles)
+    int tileX(int i) const { return std::min(std::max(i - 1, 0) / tileSize, nTilesX - 1); }
+    /// returns the first cell row of the tile row tj
+    int tileBeginY(int tj) const { return tj * tileSize + 1; }
+    /// returns the cell row after the tile row tj
+    int tileEndY(int tj) const { return std::min((tj + 1) * tileSize + 1, ny + 1); }
+    /// returns wether the tile (ti,tj) is active
+    bool isTileActive(int ti, int tj) const { return activeTiles[ti * nTilesY + tj] != 0; }
+    /// returns wether the vertical edges between the columns i-1 and i within the tile row tj have to be computed
+    bool hasActiveVerticalEdges(int i, int tj) const {
+      return isTileActive(tileX(i - 1), tj) || isTileActive(tileX(i), tj);
+    }
+    /// returns wether the horizontal edges of column i within the tile row tj (incl. the edge below) have to be computed
+    bool hasActiveHorizontalEdges(int i, int tj) const {
+      return isTileActive(tileX(i), tj) || (tj > 0 && isTileActive(tileX(i), tj - 1));
+    }
+
+    /// summary of the cells of a tile (and of the adjacent ghost cells)
+    struct TileState {
+      bool wet;	///< at least one cell is wet
+      bool atRest;	///< the momentum of all wet cells is within the rest tolerance
+      float etaMin;	///< minimum surface elevation h+b of the wet cells
+      float etaMax;	///< maximum surface elevation h+b of the wet cells
+      float bDryMin;	///< minimum bathymetry of the dry cells
+
+      /// resets the summary to an empty tile
+      void clear();
+      /// adds a cell to the summary
+      void addCell(float i_h, float i_hu, float i_hv, float i_b, float i_restTolerance);
+    };
+
+    /// default edge length of the tiles of the activity mask
+    static const int defaultTileSize = 32;
+    /// edge length of the tiles of the activity mask
+    int tileSize;
+    /// water height below which a cell is dry (dry tolerance of the Riemann solvers)
+    static const float tileDryTol;
+    int nTilesX;	///< number of tiles in x-direction
+    int nTilesY;	///< number of tiles in y-direction
+    /// per tile: summary of the cells
+    std::vector<TileState> tileStates;
+    /// per tile: the tile or one of its 8 neighbours is not quiet
+    std::vector<char> activeTiles;
+    /// skip the tiles at rest, not only the dry ones
+    bool waveFrontTracking;
+    /// maximum deviation of the surface elevation (in m) of a tile at rest
+    float restTolerance;
+    /// number of cells in the skipped tiles
+    long skippedCells;
+    /// number of cells in the skipped tiles, summed over the time steps of the last advance()
+    long skippedCellsOfAdvance;
+
+    /// thread pool, which runs the loops of the block, NULL for OpenMP
+    tools::ThreadPool* threadPool;
 };
 
 /**
  * SWE_Block1D is a simple struct that can represent a single line or row of 
- * SWE_Block unknowns (using the Float1D proxy class).
+ * SWE_Block unknowns (using the Storage1D proxy class).
  * It is intended to unify the implementation of inflow and periodic boundary 
  * conditions, as well as the ghost/copy-layer connection between several SWE_Block
  * grids. 
  */ 
 struct SWE_Block1D {
-    SWE_Block1D(const Float1D& _h, const Float1D& _hu, const Float1D& _hv)
+    SWE_Block1D(const Storage1D& _h, const Storage1D& _hu, const Storage1D& _hv)
     : h(_h), hu(_hu), hv(_hv) {};
-    SWE_Block1D(float* _h, float* _hu, float* _hv, int _size, int _stride=1)
+    SWE_Block1D(StorageFloat* _h, StorageFloat* _hu, StorageFloat* _hv, int _size, int _stride=1)
     : h(_h,_size,_stride), hu(_hu,_size,_stride), hv(_hv,_size,_stride) {};
    
-    Float1D h;
-    Float1D hu;
-    Float1D hv;
+    Storage1D h;
+    Storage1D hu;
+    Storage1D hv;
 };
 
 
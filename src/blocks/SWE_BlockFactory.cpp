@@ -0,0 +1,117 @@
+/**
+ * @file SWE_BlockFactory.cpp
+ * @brief Implements the functionality defined in SWE_BlockFactory.hh
+ */
+
+#include "SWE_BlockFactory.hh"
+
+#include "blocks/SWE_DimensionalSplittingBlock.hh"
+#include "blocks/SWE_WavePropagationBlock.hh"
+#include "blocks/rusanov/SWE_RusanovBlockOMP.hh"
+#if defined(VECTOR_SSE4_FLOAT32) || defined(VECTOR_AVX_FLOAT32) || defined(VECTOR_AVX512_FLOAT32) || defined(VECTOR_DISPATCH)
+#include "blocks/SWE_DimensionalSplittingBlockSIMD.hh"
+#define SWE_BLOCK_FACTORY_SIMD
+#endif
+
+namespace
+{
+
+//! Creates a block of the given type
+typedef SWE_Block* (*BlockCreator)(int i_nx, int i_ny, float i_dx, float i_dy, int i_numThreads, bool i_fused);
+
+/**
+ * @brief An entry of the registry
+ */
+struct Entry
+{
+    //! Name of the block type
+    const char* blockType;
+    //! Name of the Riemann solver
+    const char* solver;
+    //! Creates the block
+    BlockCreator create;
+};
+
+template <class Block>
+SWE_Block* createSplittingBlock(int i_nx, int i_ny, float i_dx, float i_dy, int i_numThreads, bool i_fused)
+{
+    return new Block(i_nx, i_ny, i_dx, i_dy, i_numThreads, i_fused);
+}
+
+template <class Block>
+SWE_Block* createUnsplitBlock(int i_nx, int i_ny, float i_dx, float i_dy, int, bool)
+{
+    return new Block(i_nx, i_ny, i_dx, i_dy);
+}
+
+template <class Block>
+SWE_Block* createParallelBlock(int i_nx, int i_ny, float i_dx, float i_dy, int i_numThreads, bool)
+{
+    return new Block(i_nx, i_ny, i_dx, i_dy, i_numThreads);
+}
+
+//! The registry, the block type and the solver of the first entry are the default
+const Entry registry[] = {
+#ifdef RUSANOV_SOLVER
+    { "rusanov", "rusanov", createParallelBlock<SWE_RusanovBlockOMP> },
+#endif
+#ifdef SWE_BLOCK_FACTORY_SIMD
+    { "dimsplit-simd", "fwave", createSplittingBlock<SWE_DimensionalSplittingBlockSIMD> },
+#endif
+    { "dimsplit", "fwave", createSplittingBlock<SWE_DimensionalSplittingBlockT<SWE_FWaveBranchFree> > },
+    { "dimsplit", "augrie", createSplittingBlock<SWE_DimensionalSplittingBlockT<solver::AugRie<float> > > },
+    { "dimsplit", "hybrid", createSplittingBlock<SWE_DimensionalSplittingBlockT<solver::Hybrid<float> > > },
+    { "wavepropagation", "fwave", createUnsplitBlock<SWE_WavePropagationBlockT<SWE_FWaveBranchFree> > },
+    { "wavepropagation", "augrie", createUnsplitBlock<SWE_WavePropagationBlockT<solver::AugRie<float> > > },
+    { "wavepropagation", "hybrid", createUnsplitBlock<SWE_WavePropagationBlockT<solver::Hybrid<float> > > },
+#ifndef RUSANOV_SOLVER
+    { "rusanov", "rusanov", createParallelBlock<SWE_RusanovBlockOMP> },
+#endif
+};
+
+const unsigned int registrySize = sizeof(registry) / sizeof(registry[0]);
+
+}
+
+SWE_Block* blocks::createBlock(const std::string& i_blockType, const std::string& i_solver,
+    int i_nx, int i_ny, float i_dx, float i_dy, int i_numThreads, bool i_fused)
+{
+    for (unsigned int i = 0; i < registrySize; i++)
+    {
+        if (i_blockType == registry[i].blockType && i_solver == registry[i].solver)
+            return registry[i].create(i_nx, i_ny, i_dx, i_dy, i_numThreads, i_fused);
+    }
+    return NULL;
+}
+
+bool blocks::isAvailable(const std::string& i_blockType, const std::string& i_solver)
+{
+    for (unsigned int i = 0; i < registrySize; i++)
+    {
+        if (i_blockType == registry[i].blockType && i_solver == registry[i].solver)
+            return true;
+    }
+    return false;
+}
+
+std::string blocks::getAvailableBlocks()
+{
+    std::string l_list;
+    for (unsigned int i = 0; i < registrySize; i++)
+    {
+        if (i > 0)
+            l_list += ", ";
+        l_list += std::string(registry[i].blockType) + "/" + registry[i].solver;
+    }
+    return l_list;
+}
+
+const char* blocks::getDefaultBlockType()
+{
+    return registry[0].blockType;
+}
+
+const char* blocks::getDefaultSolver()
+{
+    return registry[0].solver;
+}
@@ -0,0 +1,66 @@
+/**
+ * @file SWE_BlockFactory.hh
+ * @brief Runtime selection of the block type and the Riemann solver
+ *
+ * Every block type is instantiated for each of its Riemann solvers at build time,
+ * so the solvers are still inlined into the loops over the edges. The registry of
+ * SWE_BlockFactory.cpp maps the names of the block type and the solver to the instances.
+ */
+
+#ifndef _SWE_BLOCK_FACTORY_HPP
+#define _SWE_BLOCK_FACTORY_HPP
+
+#include "blocks/SWE_Block.hh"
+
+#include <string>
+
+namespace blocks
+{
+
+/**
+ * @brief Creates a block
+ *
+ * Block types are "dimsplit" (SWE_DimensionalSplittingBlockT), "wavepropagation"
+ * (SWE_WavePropagationBlockT, no splitting) and, if built with simdExtensions,
+ * "dimsplit-simd" (SWE_DimensionalSplittingBlockSIMD, f-wave only).
+ * Solvers are "fwave", "augrie" and "hybrid". The block type "rusanov"
+ * (SWE_RusanovBlockOMP, no splitting) only has the solver "rusanov".
+ *
+ * @param i_blockType Name of the block type
+ * @param i_solver Name of the Riemann solver
+ * @param i_nx Amount of cells in x dimension
+ * @param i_ny Amount of cells in y dimension
+ * @param i_dx Width of a cell
+ * @param i_dy Height of a cell
+ * @param i_numThreads The amount of parallel threads to use (dimensional splitting and rusanov only)
+ * @param i_fused Wether to use the fused sweeps (dimensional splitting only). Their time step bounds
+ *  the wave speeds of the edges for the solver "fwave" only, so the drivers reject the other solvers
+ * @return The block, or NULL if the combination of block type and solver is not available
+ */
+SWE_Block* createBlock(const std::string& i_blockType, const std::string& i_solver,
+    int i_nx, int i_ny, float i_dx, float i_dy, int i_numThreads, bool i_fused);
+
+/**
+ * @brief Wether the combination of block type and solver is available
+ */
+bool isAvailable(const std::string& i_blockType, const std::string& i_solver);
+
+/**
+ * @brief Lists the available combinations as "blocktype/solver", separated by ", "
+ */
+std::string getAvailableBlocks();
+
+/**
+ * @brief Name of the default block type: "rusanov", if built with the rusanov solver,
+ *  the vectorized one, if it is built, "dimsplit" otherwise
+ */
+const char* getDefaultBlockType();
+
+/**
+ * @brief Name of the default Riemann solver: "rusanov", if built with the rusanov solver, "fwave" otherwise
+ */
+const char* getDefaultSolver();
+
+}
+
+#endif
@@ -4,85 +4,371 @@
  */
 
 #include "SWE_DimensionalSplittingBlock.hh"
+#include "tools/ThreadPool.hh"
 
+#include <algorithm>
 #include <cassert>
+#include <cmath>
+#include <stdexcept>
 #include <string>
 #include <limits>
 #include <omp.h>
 
+const float SWE_DimensionalSplittingBlock::dryTol = 0.01f;
 
-SWE_DimensionalSplittingBlock::SWE_DimensionalSplittingBlock (int l_nx, int l_ny, float l_dx, float l_dy, int numthreads) :
+SWE_DimensionalSplittingBlock::SWE_DimensionalSplittingBlock (int l_nx, int l_ny, float l_dx, float l_dy, int numthreads, bool fused) :
 	SWE_Block (l_nx, l_ny, l_dx, l_dy),
-	hNetUpdatesLeft (nx + 1, ny),
-	hNetUpdatesRight (nx + 1, ny),
-	huNetUpdatesLeft (nx + 1, ny),
-	huNetUpdatesRight (nx + 1, ny),
-	hNetUpdatesBelow (nx, ny + 1),
-	hNetUpdatesAbove (nx, ny + 1),
-	hvNetUpdatesBelow (nx, ny + 1),
-	hvNetUpdatesAbove (nx, ny + 1),
-	numThreads(numthreads)
+	// The net-update buffers are not needed by the fused sweeps
+	hNetUpdatesLeft (nx + 1, ny, !fused, true),
+	hNetUpdatesRight (nx + 1, ny, !fused, true),
+	huNetUpdatesLeft (nx + 1, ny, !fused, true),
+	huNetUpdatesRight (nx + 1, ny, !fused, true),
+	hNetUpdatesBelow (nx, ny + 1, !fused, true),
+	hNetUpdatesAbove (nx, ny + 1, !fused, true),
+	hvNetUpdatesBelow (nx, ny + 1, !fused, true),
+	hvNetUpdatesAbove (nx, ny + 1, !fused, true),
+	hNetUpdatesCarried (numthreads, ny, fused),
+	huNetUpdatesCarried (numthreads, ny, fused),
+	hNetUpdatesStripEdge (numthreads, ny, fused),
+	huNetUpdatesStripEdge (numthreads, ny, fused),
+	fusedSweeps(fused),
+	tiledSweeps(false),
+	numThreads(numthreads),
+	cellSpeedsTileSize(0),
+	maxCellSpeedHorizontal(0.f),
+	maxCellSpeedVertical(0.f),
+	maxCellSpeedsValid(false)
 {
 	workPerThread_horizontal = (int)ceil((float)nx / (float)numThreads);
 	workPerThread_vertical = (int)ceil((float)ny / (float)numThreads);
+	stripMaxWaveSpeeds.assign(numThreads, 0.f);
+	stripMaxCellSpeedsHorizontal.assign(numThreads, 0.f);
+	stripMaxCellSpeedsVertical.assign(numThreads, 0.f);
 }
 
-float SWE_DimensionalSplittingBlock::computeNumericalFluxesVertical()
+void SWE_DimensionalSplittingBlock::scanCellSpeeds()
 {
-	float maxWaveSpeed = (float) 0.;
-	#pragma omp parallel for reduction(max: maxWaveSpeed)
-#ifdef CUSTOM_OPT
-	for(int t = 0; t < numThreads; t++)
+	cellSpeedsHorizontal.assign(nx * nTilesY, 0.f);
+	cellSpeedsVertical.assign(nx * nTilesY, 0.f);
+	float maxSpeedX = (float) 0., maxSpeedY = (float) 0.;
+	#pragma omp parallel for reduction(max: maxSpeedX, maxSpeedY)
+	for (int i = 1; i < nx + 1; i++)
 	{
-		for (int j = (t*workPerThread_vertical) + 1; j < ((t+1)*workPerThread_vertical) + 1 && j < ny + 1; j++) 
-#else
-	for (int j = 1; j < ny + 2; j++) 
-#endif
+		for (int tj = 0; tj < nTilesY; tj++)
 		{
-			for (int i = 1; i < nx + 1; i++) 
+			float speedX = (float) 0., speedY = (float) 0.;
+			#pragma omp simd reduction(max: speedX, speedY)
+			for (int j = tileBeginY(tj); j < tileEndY(tj); j++)
 			{
-				float maxEdgeSpeed;
-				wavePropagationSolver.computeNetUpdates(
-					h[i][j - 1], h[i][j], hv[i][j - 1], hv[i][j], b[i][j - 1], b[i][j],
-					hNetUpdatesBelow[i - 1][j - 1], hNetUpdatesAbove[i - 1][j - 1],
-					hvNetUpdatesBelow[i - 1][j - 1], hvNetUpdatesAbove[i - 1][j - 1],
-					maxEdgeSpeed
-				);
-				maxWaveSpeed = std::max (maxWaveSpeed, maxEdgeSpeed);
+				speedX = std::max(speedX, cellSpeed(h[i][j], hu[i][j]));
+				speedY = std::max(speedY, cellSpeed(h[i][j], hv[i][j]));
 			}
+			cellSpeedsHorizontal[(i - 1) * nTilesY + tj] = speedX;
+			cellSpeedsVertical[(i - 1) * nTilesY + tj] = speedY;
+			maxSpeedX = std::max(maxSpeedX, speedX);
+			maxSpeedY = std::max(maxSpeedY, speedY);
 		}
-#ifdef CUSTOM_OPT
 	}
-#endif
+	maxCellSpeedHorizontal = maxSpeedX;
+	maxCellSpeedVertical = maxSpeedY;
+	maxCellSpeedsValid = true;
+	cellSpeedsTileSize = tileSize;
+}
+
+float SWE_DimensionalSplittingBlock::getMaxCellSpeedHorizontal()
+{
+	if (!maxCellSpeedsValid)
+		scanCellSpeeds();
+	return maxCellSpeedHorizontal;
+}
+
+float SWE_DimensionalSplittingBlock::getMaxCellSpeedVertical()
+{
+	if (!maxCellSpeedsValid)
+		scanCellSpeeds();
+	return maxCellSpeedVertical;
+}
+
+void SWE_DimensionalSplittingBlock::synchWaterHeightAfterWrite()
+{
+	SWE_Block::synchWaterHeightAfterWrite();
+	cellSpeedsTileSize = 0;
+	maxCellSpeedsValid = false;
+}
+
+void SWE_DimensionalSplittingBlock::synchDischargeAfterWrite()
+{
+	SWE_Block::synchDischargeAfterWrite();
+	cellSpeedsTileSize = 0;
+	maxCellSpeedsValid = false;
+}
+
+void SWE_DimensionalSplittingBlock::setThreadPool(tools::ThreadPool* i_threadPool)
+{
+	if (i_threadPool != NULL && i_threadPool->getNumThreads() > numThreads)
+		throw std::runtime_error("The thread pool has more threads than the block");
+	SWE_Block::setThreadPool(i_threadPool);
+}
+
+void SWE_DimensionalSplittingBlock::sweepStripsHorizontal(float dtdx)
+{
+	//the results are stored per strip, the barrier at the end of the loop makes them visible to all threads
+	#pragma omp for
+	for (int t = 0; t < numThreads; t++)
+	{
+		const int jBegin = (t*workPerThread_vertical) + 1;
+		const int jEnd = std::min(((t+1)*workPerThread_vertical) + 1, ny + 1);
+		stripMaxWaveSpeeds[t] = computeNumericalFluxesAndUpdateRowsHorizontal(jBegin, jEnd, t, dtdx);
+	}
+}
+
+void SWE_DimensionalSplittingBlock::sweepStripsVertical(float dtdy)
+{
+	#pragma omp for
+	for (int t = 0; t < numThreads; t++)
+	{
+		const int iBegin = (t*workPerThread_horizontal) + 1;
+		const int iEnd = std::min(((t+1)*workPerThread_horizontal) + 1, nx + 1);
+		float speedX = (float) 0., speedY = (float) 0.;
+		stripMaxWaveSpeeds[t] = computeNumericalFluxesAndUpdateColumnsVertical(iBegin, iEnd, t, dtdy, speedX, speedY);
+		stripMaxCellSpeedsHorizontal[t] = speedX;
+		stripMaxCellSpeedsVertical[t] = speedY;
+	}
+}
+
+void SWE_DimensionalSplittingBlock::sweepStripsTiled(float dtdx, float dtdy)
+{
+	//the first edge of every strip, its left net-updates are needed by the previous strip
+	#pragma omp for
+	for (int t = 0; t < numThreads; t++)
+		stripMaxWaveSpeeds[t] = computeNumericalFluxesStripEdge(t);
+	#pragma omp for
+	for (int t = 0; t < numThreads; t++)
+	{
+		float speedX = (float) 0., speedY = (float) 0.;
+		const float maxWaveSpeed = computeNumericalFluxesAndUpdateStrip(t, dtdx, dtdy, speedX, speedY);
+		stripMaxWaveSpeeds[t] = std::max(stripMaxWaveSpeeds[t], maxWaveSpeed);
+		stripMaxCellSpeedsHorizontal[t] = speedX;
+		stripMaxCellSpeedsVertical[t] = speedY;
+	}
+}
+
+float SWE_DimensionalSplittingBlock::reduceStrips(bool i_cellSpeeds)
+{
+	float maxWaveSpeed = (float) 0.;
+	for (int t = 0; t < numThreads; t++)
+		maxWaveSpeed = std::max(maxWaveSpeed, stripMaxWaveSpeeds[t]);
+	if (i_cellSpeeds)
+	{
+		maxCellSpeedHorizontal = *std::max_element(stripMaxCellSpeedsHorizontal.begin(), stripMaxCellSpeedsHorizontal.end());
+		maxCellSpeedVertical = *std::max_element(stripMaxCellSpeedsVertical.begin(), stripMaxCellSpeedsVertical.end());
+		maxCellSpeedsValid = true;
+	}
 	return maxWaveSpeed;
 }
 
+float SWE_DimensionalSplittingBlock::computeNumericalFluxesAndUpdateHorizontal(float dt)
+{
+	assert(fusedSweeps);
+	//the horizontal sweep starts the time step
+	updateTileActivity();
+	//the speeds of the updated cells are reduced again by the vertical sweep
+	maxCellSpeedsValid = false;
+	const float dtdx = dt / dx;
+	if (threadPool != NULL)
+	{
+		//the tile rows are the tasks, they share the carried column, but not its rows
+		auto rows = [this, dtdx](int tj, int worker) {
+			return computeNumericalFluxesAndUpdateRowsHorizontal(tileBeginY(tj), tileEndY(tj), worker, dtdx);
+		};
+		return threadPool->reduceMax(nTilesY, rows);
+	}
+	#pragma omp parallel
+	sweepStripsHorizontal(dtdx);
+	return reduceStrips(false);
+}
+
+float SWE_DimensionalSplittingBlock::computeNumericalFluxesAndUpdateVertical(float dt)
+{
+	assert(fusedSweeps);
+	prepareCellSpeeds();
+	const float dtdy = dt / dy;
+	if (threadPool != NULL)
+	{
+		//the tile columns are the tasks, the results are kept per worker in the strip vectors
+		std::fill(stripMaxWaveSpeeds.begin(), stripMaxWaveSpeeds.end(), 0.f);
+		std::fill(stripMaxCellSpeedsHorizontal.begin(), stripMaxCellSpeedsHorizontal.end(), 0.f);
+		std::fill(stripMaxCellSpeedsVertical.begin(), stripMaxCellSpeedsVertical.end(), 0.f);
+		auto columns = [this, dtdy](int ti, int worker) {
+			const int iBegin = ti*tileSize + 1;
+			const int iEnd = std::min((ti+1)*tileSize + 1, nx + 1);
+			const float maxWaveSpeed = computeNumericalFluxesAndUpdateColumnsVertical(iBegin, iEnd, worker, dtdy,
+				stripMaxCellSpeedsHorizontal[worker], stripMaxCellSpeedsVertical[worker]);
+			stripMaxWaveSpeeds[worker] = std::max(stripMaxWaveSpeeds[worker], maxWaveSpeed);
+		};
+		threadPool->run(nTilesX, columns);
+		return reduceStrips(true);
+	}
+	#pragma omp parallel
+	sweepStripsVertical(dtdy);
+	return reduceStrips(true);
+}
+
+float SWE_DimensionalSplittingBlock::computeNumericalFluxesAndUpdate(float dt)
+{
+	assert(fusedSweeps);
+	//the horizontal sweep starts the time step
+	updateTileActivity();
+	prepareCellSpeeds();
+	if (threadPool != NULL)
+	{
+		//a strip depends on the first edge of the next one, so the strips are the tasks
+		const float dtdx = dt / dx, dtdy = dt / dy;
+		auto stripEdges = [this](int t, int) {
+			stripMaxWaveSpeeds[t] = computeNumericalFluxesStripEdge(t);
+		};
+		auto strips = [this, dtdx, dtdy](int t, int) {
+			float speedX = (float) 0., speedY = (float) 0.;
+			const float maxWaveSpeed = computeNumericalFluxesAndUpdateStrip(t, dtdx, dtdy, speedX, speedY);
+			stripMaxWaveSpeeds[t] = std::max(stripMaxWaveSpeeds[t], maxWaveSpeed);
+			stripMaxCellSpeedsHorizontal[t] = speedX;
+			stripMaxCellSpeedsVertical[t] = speedY;
+		};
+		threadPool->run(numThreads, stripEdges);
+		threadPool->run(numThreads, strips);
+		return reduceStrips(true);
+	}
+	#pragma omp parallel
+	sweepStripsTiled(dt / dx, dt / dy);
+	return reduceStrips(true);
+}
+
+int SWE_DimensionalSplittingBlock::advance(float& io_time, float i_tEnd, int i_maxSteps)
+{
+	int steps = 0;
+	skippedCellsOfAdvance = 0;
+	if (!fusedSweeps)
+	{
+		//the time step of the horizontal sweep, see the dimensional splitting driver
+		for (; steps < i_maxSteps && io_time < i_tEnd; steps++)
+		{
+			setGhostLayer();
+			const float maxWaveSpeedHorizontal = computeNumericalFluxesHorizontal();
+			computeMaxTimestep(maxWaveSpeedHorizontal, getMaxCellSpeedVertical());
+			updateUnknownsHorizontal(maxTimestep);
+			computeNumericalFluxesVertical();
+			updateUnknownsVertical(maxTimestep);
+			io_time += maxTimestep;
+			skippedCellsOfAdvance += skippedCells;
+		}
+		return steps;
+	}
+
+	if (threadPool != NULL)
+	{
+		//the threads of the pool wait between its loops already, so the time steps run one by one
+		for (; steps < i_maxSteps && io_time < i_tEnd; steps++)
+		{
+			setGhostLayer();
+			computeMaxTimestep(getMaxCellSpeedHorizontal(), getMaxCellSpeedVertical());
+			if (tiledSweeps)
+				computeNumericalFluxesAndUpdate(maxTimestep);
+			else
+			{
+				computeNumericalFluxesAndUpdateHorizontal(maxTimestep);
+				computeNumericalFluxesAndUpdateVertical(maxTimestep);
+			}
+			io_time += maxTimestep;
+			skippedCellsOfAdvance += skippedCells;
+		}
+		return steps;
+	}
+
+	//the speeds of the cells, which are written outside of the sweeps
+	getMaxCellSpeedHorizontal();
+	prepareCellSpeeds();
+	bool done = false;
+	#pragma omp parallel
+	{
+		while (true)
+		{
+			//the implicit barrier of single publishes the time step and the ghost layers to the team
+			#pragma omp single
+			{
+				if (steps > 0)
+				{
+					reduceStrips(true);
+					skippedCellsOfAdvance += skippedCells;
+				}
+				done = steps >= i_maxSteps || !(io_time < i_tEnd);
+				if (!done)
+				{
+					setGhostLayer();
+					computeMaxTimestep(maxCellSpeedHorizontal, maxCellSpeedVertical);
+					io_time += maxTimestep;
+					steps++;
+				}
+			}
+			if (done)
+				break;
+			updateTileActivityInTeam();
+			if (tiledSweeps)
+				sweepStripsTiled(maxTimestep / dx, maxTimestep / dy);
+			else
+			{
+				sweepStripsHorizontal(maxTimestep / dx);
+				sweepStripsVertical(maxTimestep / dy);
+			}
+		}
+	}
+	return steps;
+}
+
 float SWE_DimensionalSplittingBlock::computeNumericalFluxesHorizontal()
 {
+	assert(!fusedSweeps);
+	//the horizontal sweep starts the time step
+	updateTileActivity();
+	if (threadPool != NULL)
+	{
+		//the tile columns are the tasks, the last one includes the right boundary edge (i = nx + 1)
+		auto columns = [this](int ti, int) {
+			return computeNetUpdatesHorizontal(ti*tileSize + 1, (ti == nTilesX - 1) ? nx + 2 : (ti+1)*tileSize + 1);
+		};
+		return threadPool->reduceMax(nTilesX, columns);
+	}
 	float maxWaveSpeed = (float) 0.;
 	#pragma omp parallel for reduction(max: maxWaveSpeed)
 #ifdef CUSTOM_OPT
 	for(int t = 0; t < numThreads; t++)
-	{
-		for (int i = (t*workPerThread_horizontal) + 1; i < ((t+1)*workPerThread_horizontal) + 1 && i < nx + 1; i++) 
+		maxWaveSpeed = std::max(maxWaveSpeed, computeNetUpdatesHorizontal((t*workPerThread_horizontal) + 1,
+			std::min(((t+1)*workPerThread_horizontal) + 1, nx + 2)));
 #else
-	for (int i = 1; i < nx + 2; i++) 
+	for (int i = 1; i < nx + 2; i++)
+		maxWaveSpeed = std::max(maxWaveSpeed, computeNetUpdatesHorizontal(i, i + 1));
 #endif
-		{
-			for (int j = 1; j < ny + 1; j++) 
-			{
-				float maxEdgeSpeed;
-				wavePropagationSolver.computeNetUpdates(
-					h[i - 1][j], h[i][j], hu[i - 1][j], hu[i][j], b[i - 1][j], b[i][j],
-					hNetUpdatesLeft[i - 1][j - 1], hNetUpdatesRight[i - 1][j - 1],
-					huNetUpdatesLeft[i - 1][j - 1], huNetUpdatesRight[i - 1][j - 1],
-					maxEdgeSpeed
-				);
-				maxWaveSpeed = std::max(maxWaveSpeed, maxEdgeSpeed);
-			}
-		}
-#ifdef CUSTOM_OPT
+	return maxWaveSpeed;
+}
+
+float SWE_DimensionalSplittingBlock::computeNumericalFluxesVertical()
+{
+	assert(!fusedSweeps);
+	if (threadPool != NULL)
+	{
+		auto columns = [this](int ti, int) {
+			return computeNetUpdatesVertical(ti*tileSize + 1, std::min((ti+1)*tileSize + 1, nx + 1));
+		};
+		return threadPool->reduceMax(nTilesX, columns);
 	}
+	float maxWaveSpeed = (float) 0.;
+	#pragma omp parallel for reduction(max: maxWaveSpeed)
+#ifdef CUSTOM_OPT
+	for(int t = 0; t < numThreads; t++)
+		maxWaveSpeed = std::max(maxWaveSpeed, computeNetUpdatesVertical((t*workPerThread_horizontal) + 1,
+			std::min(((t+1)*workPerThread_horizontal) + 1, nx + 1)));
+#else
+	for (int i = 1; i < nx + 1; i++)
+		maxWaveSpeed = std::max(maxWaveSpeed, computeNetUpdatesVertical(i, i + 1));
 #endif
 	return maxWaveSpeed;
 }
@@ -121,73 +407,419 @@ void SWE_DimensionalSplittingBlock::computeMaxTimestep(float max, bool is_horizo
 	}
 }
 
-void SWE_DimensionalSplittingBlock::updateUnknownsHorizontal(float dt)
+void SWE_DimensionalSplittingBlock::computeMaxTimestep(float maxHorizontal, float maxVertical)
 {
-	//update cell averages with the net-updates
-	for (int i = 1; i < nx + 1; i++)
+	//the direction with the most cells crossed per time determines the time step
+	computeMaxTimestep(std::min(dx, dy) * std::max(maxHorizontal / dx, maxVertical / dy), dx < dy);
+}
+
+void SWE_DimensionalSplittingBlock::updateUnknownsColumnHorizontal(float dt, int i)
+{
+	for (int tj = 0; tj < nTilesY; tj++)
 	{
-		for (int j = 1; j < ny + 1; j++)
+		//the cells of quiet tiles are skipped
+		if (!isTileActive(tileX(i), tj))
+			continue;
+		for (int j = tileBeginY(tj); j < tileEndY(tj); j++)
 		{
 			h[i][j] -= dt / dx * (hNetUpdatesRight[i - 1][j - 1] + hNetUpdatesLeft[i][j - 1]);
 			hu[i][j] -= dt / dx * (huNetUpdatesRight[i - 1][j - 1] + huNetUpdatesLeft[i][j - 1]);
 		}
 	}
-	//zeroSmallValues();
 }
 
-void SWE_DimensionalSplittingBlock::updateUnknownsVertical(float dt)
+void SWE_DimensionalSplittingBlock::updateUnknownsColumnVertical(float dt, int i,
+	float& io_maxCellSpeedHorizontal, float& io_maxCellSpeedVertical)
 {
-	//update cell averages with the net-updates
-	for (int i = 1; i < nx + 1; i++)
+	for (int tj = 0; tj < nTilesY; tj++)
 	{
-		for (int j = 1; j < ny + 1; j++)
+		float& speedX = cellSpeedsHorizontal[(i - 1) * nTilesY + tj];
+		float& speedY = cellSpeedsVertical[(i - 1) * nTilesY + tj];
+		//the cells of quiet tiles are skipped, they keep their speeds
+		if (isTileActive(tileX(i), tj))
 		{
-			h[i][j] -= dt / dy * (hNetUpdatesAbove[i - 1][j - 1] + hNetUpdatesBelow[i - 1][j]);
-			hv[i][j] -= dt / dy * (hvNetUpdatesAbove[i - 1][j - 1] + hvNetUpdatesBelow[i - 1][j]);
+			float tileSpeedX = (float) 0., tileSpeedY = (float) 0.;
+			#pragma omp simd reduction(max: tileSpeedX, tileSpeedY)
+			for (int j = tileBeginY(tj); j < tileEndY(tj); j++)
+			{
+				h[i][j] -= dt / dy * (hNetUpdatesAbove[i - 1][j - 1] + hNetUpdatesBelow[i - 1][j]);
+				hv[i][j] -= dt / dy * (hvNetUpdatesAbove[i - 1][j - 1] + hvNetUpdatesBelow[i - 1][j]);
+				tileSpeedX = std::max(tileSpeedX, cellSpeed(h[i][j], hu[i][j]));
+				tileSpeedY = std::max(tileSpeedY, cellSpeed(h[i][j], hv[i][j]));
+			}
+			speedX = tileSpeedX;
+			speedY = tileSpeedY;
 		}
+		io_maxCellSpeedHorizontal = std::max(io_maxCellSpeedHorizontal, speedX);
+		io_maxCellSpeedVertical = std::max(io_maxCellSpeedVertical, speedY);
 	}
-	//zeroSmallValues();
 }
 
-void SWE_DimensionalSplittingBlock::updateUnknowns(float dt)
+void SWE_DimensionalSplittingBlock::updateUnknownsColumn(float dt, int i)
 {
-	//update cell averages with the net-updates
-	for (int i = 1; i < nx + 1; i++)
+	for (int tj = 0; tj < nTilesY; tj++)
 	{
-		for (int j = 1; j < ny + 1; j++)
+		//the cells of quiet tiles are skipped
+		if (!isTileActive(tileX(i), tj))
+			continue;
+		for (int j = tileBeginY(tj); j < tileEndY(tj); j++)
 		{
 			h[i][j] -= dt / dx * (hNetUpdatesRight[i - 1][j - 1] + hNetUpdatesLeft[i][j - 1]) + dt / dy * (hNetUpdatesAbove[i - 1][j - 1] + hNetUpdatesBelow[i - 1][j]);
 			hu[i][j] -= dt / dx * (huNetUpdatesRight[i - 1][j - 1] + huNetUpdatesLeft[i][j - 1]);
 			hv[i][j] -= dt / dy * (hvNetUpdatesAbove[i - 1][j - 1] + hvNetUpdatesBelow[i - 1][j]);
 		}
 	}
-	//zeroSmallValues();
 }
 
-void SWE_DimensionalSplittingBlock::zeroSmallValues()
+void SWE_DimensionalSplittingBlock::updateUnknownsHorizontal(float dt)
 {
-	for (int i = 1; i < nx + 1; i++)
+	assert(!fusedSweeps);
+	//the speeds of the updated cells are reduced again by the vertical update
+	maxCellSpeedsValid = false;
+	//update cell averages with the net-updates
+	if (threadPool != NULL)
+	{
+		auto columns = [this, dt](int ti, int) {
+			for (int i = ti*tileSize + 1; i < std::min((ti+1)*tileSize + 1, nx + 1); i++)
+				updateUnknownsColumnHorizontal(dt, i);
+		};
+		threadPool->run(nTilesX, columns);
+	}
+	else
+	{
+		#pragma omp parallel for
+		for (int i = 1; i < nx + 1; i++)
+			updateUnknownsColumnHorizontal(dt, i);
+	}
+}
+
+void SWE_DimensionalSplittingBlock::updateUnknownsVertical(float dt)
+{
+	assert(!fusedSweeps);
+	prepareCellSpeeds();
+	float maxSpeedX = (float) 0., maxSpeedY = (float) 0.;
+	//update cell averages with the net-updates, and reduce the wave speeds of the updated cells
+	if (threadPool != NULL)
+	{
+		//the maxima are kept per worker in the strip vectors
+		std::fill(stripMaxCellSpeedsHorizontal.begin(), stripMaxCellSpeedsHorizontal.end(), 0.f);
+		std::fill(stripMaxCellSpeedsVertical.begin(), stripMaxCellSpeedsVertical.end(), 0.f);
+		auto columns = [this, dt](int ti, int worker) {
+			for (int i = ti*tileSize + 1; i < std::min((ti+1)*tileSize + 1, nx + 1); i++)
+				updateUnknownsColumnVertical(dt, i, stripMaxCellSpeedsHorizontal[worker], stripMaxCellSpeedsVertical[worker]);
+		};
+		threadPool->run(nTilesX, columns);
+		maxSpeedX = *std::max_element(stripMaxCellSpeedsHorizontal.begin(), stripMaxCellSpeedsHorizontal.end());
+		maxSpeedY = *std::max_element(stripMaxCellSpeedsVertical.begin(), stripMaxCellSpeedsVertical.end());
+	}
+	else
+	{
+		#pragma omp parallel for reduction(max: maxSpeedX, maxSpeedY)
+		for (int i = 1; i < nx + 1; i++)
+			updateUnknownsColumnVertical(dt, i, maxSpeedX, maxSpeedY);
+	}
+	maxCellSpeedHorizontal = maxSpeedX;
+	maxCellSpeedVertical = maxSpeedY;
+	maxCellSpeedsValid = true;
+}
+
+void SWE_DimensionalSplittingBlock::updateUnknowns(float dt)
+{
+	assert(!fusedSweeps);
+	maxCellSpeedsValid = false;
+	//update cell averages with the net-updates
+	if (threadPool != NULL)
+	{
+		auto columns = [this, dt](int ti, int) {
+			for (int i = ti*tileSize + 1; i < std::min((ti+1)*tileSize + 1, nx + 1); i++)
+				updateUnknownsColumn(dt, i);
+		};
+		threadPool->run(nTilesX, columns);
+	}
+	else
+	{
+		#pragma omp parallel for
+		for (int i = 1; i < nx + 1; i++)
+			updateUnknownsColumn(dt, i);
+	}
+}
+
+template <class RiemannSolver>
+SWE_DimensionalSplittingBlockT<RiemannSolver>::SWE_DimensionalSplittingBlockT (int l_nx, int l_ny, float l_dx, float l_dy, int numthreads, bool fused) :
+	SWE_DimensionalSplittingBlock (l_nx, l_ny, l_dx, l_dy, numthreads, fused),
+	hNetUpdatesBuffer (2 * numthreads, ny + 1, fused, true),
+	huvNetUpdatesBuffer (2 * numthreads, ny + 1, fused, true)
+{
+}
+
+template <class RiemannSolver>
+float SWE_DimensionalSplittingBlockT<RiemannSolver>::computeNetUpdatesVertical(int iBegin, int iEnd)
+{
+	float maxWaveSpeed = (float) 0.;
+	//traverse the horizontal edges column by column, the columns are contiguous in memory
+	for (int i = iBegin; i < iEnd; i++)
+	{
+		for (int tj = 0; tj < nTilesY; tj++)
+		{
+			//the edges between quiet tiles are skipped, the last tile row includes the top boundary edge
+			if (!hasActiveHorizontalEdges(i, tj))
+				continue;
+			const int j = tileBeginY(tj);
+			const int jEnd = (tj == nTilesY - 1) ? ny + 2 : tileEndY(tj);
+			float maxSegmentSpeed = wavePropagationSolver.computeNetUpdates(jEnd - j,
+				h[i] + j - 1, h[i] + j, hv[i] + j - 1, hv[i] + j, b[i] + j - 1, b[i] + j,
+				hNetUpdatesBelow[i - 1] + j - 1, hNetUpdatesAbove[i - 1] + j - 1,
+				hvNetUpdatesBelow[i - 1] + j - 1, hvNetUpdatesAbove[i - 1] + j - 1
+			);
+			maxWaveSpeed = std::max (maxWaveSpeed, maxSegmentSpeed);
+		}
+	}
+	return maxWaveSpeed;
+}
+
+template <class RiemannSolver>
+float SWE_DimensionalSplittingBlockT<RiemannSolver>::computeNetUpdatesHorizontal(int iBegin, int iEnd)
+{
+	float maxWaveSpeed = (float) 0.;
+	for (int i = iBegin; i < iEnd; i++)
+	{
+		for (int tj = 0; tj < nTilesY; tj++)
+		{
+			//the edges between quiet tiles are skipped
+			if (!hasActiveVerticalEdges(i, tj))
+				continue;
+			const int j = tileBeginY(tj);
+			float maxSegmentSpeed = wavePropagationSolver.computeNetUpdates(tileEndY(tj) - j,
+				h[i - 1] + j, h[i] + j, hu[i - 1] + j, hu[i] + j, b[i - 1] + j, b[i] + j,
+				hNetUpdatesLeft[i - 1] + j - 1, hNetUpdatesRight[i - 1] + j - 1,
+				huNetUpdatesLeft[i - 1] + j - 1, huNetUpdatesRight[i - 1] + j - 1
+			);
+			maxWaveSpeed = std::max(maxWaveSpeed, maxSegmentSpeed);
+		}
+	}
+	return maxWaveSpeed;
+}
+
+template <class RiemannSolver>
+float SWE_DimensionalSplittingBlockT<RiemannSolver>::computeNumericalFluxesAndUpdateRowsHorizontal(int jBegin, int jEnd, int t, float dtdx)
+{
+	float maxWaveSpeed = (float) 0.;
+	if (jBegin >= jEnd)
+		return maxWaveSpeed;
+	//cell i-1 is updated as soon as the edges to cell i are computed, the right net-updates are carried
+	float* hCarried = hNetUpdatesCarried[0];
+	float* huCarried = huNetUpdatesCarried[0];
+	float* hLeft = hNetUpdatesBuffer[2*t];
+	float* huLeft = huvNetUpdatesBuffer[2*t];
+	float* hRight = hNetUpdatesBuffer[2*t + 1];
+	float* huRight = huvNetUpdatesBuffer[2*t + 1];
+	maxWaveSpeed = std::max(maxWaveSpeed, wavePropagationSolver.computeNetUpdates(jEnd - jBegin,
+		h[0] + jBegin, h[1] + jBegin, hu[0] + jBegin, hu[1] + jBegin, b[0] + jBegin, b[1] + jBegin,
+		hLeft, hCarried + jBegin - 1, huLeft, huCarried + jBegin - 1
+	));
+	for (int i = 2; i < nx + 2; i++)
+	{
+		for (int tj = (jBegin - 1) / tileSize; tj <= (jEnd - 2) / tileSize; tj++)
+		{
+			const int jTileBegin = std::max(jBegin, tileBeginY(tj));
+			const int jTileEnd = std::min(jEnd, tileEndY(tj));
+			if (!hasActiveVerticalEdges(i, tj))
+			{
+				//cell i-1 is quiet, the net-updates of its edges are neglected
+				std::fill(hCarried + jTileBegin - 1, hCarried + jTileEnd - 1, 0.f);
+				std::fill(huCarried + jTileBegin - 1, huCarried + jTileEnd - 1, 0.f);
+				continue;
+			}
+			maxWaveSpeed = std::max(maxWaveSpeed, wavePropagationSolver.computeNetUpdates(jTileEnd - jTileBegin,
+				h[i - 1] + jTileBegin, h[i] + jTileBegin, hu[i - 1] + jTileBegin, hu[i] + jTileBegin,
+				b[i - 1] + jTileBegin, b[i] + jTileBegin,
+				hLeft, hRight, huLeft, huRight
+			));
+			for (int j = jTileBegin; j < jTileEnd; j++)
+			{
+				const int k = j - jTileBegin;
+				h[i - 1][j] -= dtdx * (hCarried[j - 1] + hLeft[k]);
+				hu[i - 1][j] -= dtdx * (huCarried[j - 1] + huLeft[k]);
+				hCarried[j - 1] = hRight[k];
+				huCarried[j - 1] = huRight[k];
+			}
+		}
+	}
+	return maxWaveSpeed;
+}
+
+template <class RiemannSolver>
+float SWE_DimensionalSplittingBlockT<RiemannSolver>::computeNumericalFluxesAndUpdateColumnsVertical(int iBegin, int iEnd, int t, float dtdy,
+	float& io_maxCellSpeedHorizontal, float& io_maxCellSpeedVertical)
+{
+	float maxWaveSpeed = (float) 0.;
+	//the net-updates of one column of edges are kept per thread
+	for (int i = iBegin; i < iEnd; i++)
+		maxWaveSpeed = std::max(maxWaveSpeed, computeNumericalFluxesAndUpdateColumnVertical(i, dtdy,
+			hNetUpdatesBuffer[2*t], hNetUpdatesBuffer[2*t + 1], huvNetUpdatesBuffer[2*t], huvNetUpdatesBuffer[2*t + 1],
+			io_maxCellSpeedHorizontal, io_maxCellSpeedVertical));
+	return maxWaveSpeed;
+}
+
+template <class RiemannSolver>
+float SWE_DimensionalSplittingBlockT<RiemannSolver>::computeNumericalFluxesStripEdge(int t)
+{
+	const int iBegin = (t*workPerThread_horizontal) + 1;
+	if (iBegin >= nx + 1)
+		return (float) 0.;
+	return computeNumericalFluxesColumnHorizontal(iBegin,
+		hNetUpdatesStripEdge[t], hNetUpdatesCarried[t], huNetUpdatesStripEdge[t], huNetUpdatesCarried[t]);
+}
+
+template <class RiemannSolver>
+float SWE_DimensionalSplittingBlockT<RiemannSolver>::computeNumericalFluxesAndUpdateStrip(int t, float dtdx, float dtdy,
+	float& io_maxCellSpeedHorizontal, float& io_maxCellSpeedVertical)
+{
+	float maxWaveSpeed = (float) 0.;
+	const int iBegin = (t*workPerThread_horizontal) + 1;
+	const int iEnd = std::min(((t+1)*workPerThread_horizontal) + 1, nx + 1);
+	float* hCarried = hNetUpdatesCarried[t];
+	float* huCarried = huNetUpdatesCarried[t];
+	//the buffers of the thread keep the net-updates of one tile of edges,
+	//they are free again for the vertical sweep of the column
+	float* hLeft = hNetUpdatesBuffer[2*t];
+	float* huLeft = huvNetUpdatesBuffer[2*t];
+	float* hRight = hNetUpdatesBuffer[2*t + 1];
+	float* huRight = huvNetUpdatesBuffer[2*t + 1];
+	for (int i = iBegin + 1; i <= iEnd; i++)
 	{
-		for (int j = 1; j < ny + 1; j++) 
+		//the last edge of a strip is the first edge of the next one, except for the right boundary
+		const bool isStripEdge = (i == iEnd && i < nx + 1);
+		for (int tj = 0; tj < nTilesY; tj++)
 		{
-			if (h[i][j] < 0)
+			if (!hasActiveVerticalEdges(i, tj))
+			{
+				//cell i-1 is quiet, the net-updates of its edges are neglected
+				std::fill(hCarried + tileBeginY(tj) - 1, hCarried + tileEndY(tj) - 1, 0.f);
+				std::fill(huCarried + tileBeginY(tj) - 1, huCarried + tileEndY(tj) - 1, 0.f);
+				continue;
+			}
+			if (isStripEdge)
 			{
-				//TODO: dryTol
-#ifndef NDEBUG
-				// Only print this warning when debug is enabled
-				// Otherwise we cannot vectorize this loop
-				if (h[i][j] - b[i][j] < -0.1) 
+				const float* hStripLeft = hNetUpdatesStripEdge[t + 1];
+				const float* huStripLeft = huNetUpdatesStripEdge[t + 1];
+				for (int j = tileBeginY(tj); j < tileEndY(tj); j++)
 				{
-					std::cerr << "Warning, negative height-bathy: (i,j)=(" << i << "," << j << ")=" << h[i][j] << "-" << b[i][j] << std::endl;
+					h[i - 1][j] -= dtdx * (hCarried[j - 1] + hStripLeft[j - 1]);
+					hu[i - 1][j] -= dtdx * (huCarried[j - 1] + huStripLeft[j - 1]);
 				}
-#endif
-				//zero (small) negative depths
-				h[i][j] = hu[i][j] = hv[i][j] = 0.;
-			} 
-			else if (h[i][j] < 0.1)
+				continue;
+			}
+			const int jBegin = tileBeginY(tj);
+			maxWaveSpeed = std::max(maxWaveSpeed, wavePropagationSolver.computeNetUpdates(tileEndY(tj) - jBegin,
+				h[i - 1] + jBegin, h[i] + jBegin, hu[i - 1] + jBegin, hu[i] + jBegin, b[i - 1] + jBegin, b[i] + jBegin,
+				hLeft, hRight, huLeft, huRight
+			));
+			for (int j = jBegin; j < tileEndY(tj); j++)
 			{
-				hu[i][j] = hv[i][j] = 0.; //no water, no speed!
+				const int k = j - jBegin;
+				h[i - 1][j] -= dtdx * (hCarried[j - 1] + hLeft[k]);
+				hu[i - 1][j] -= dtdx * (huCarried[j - 1] + huLeft[k]);
+				hCarried[j - 1] = hRight[k];
+				huCarried[j - 1] = huRight[k];
 			}
 		}
+		//column i-1 is complete in x direction, the vertical sweep only reads the column itself
+		maxWaveSpeed = std::max(maxWaveSpeed, computeNumericalFluxesAndUpdateColumnVertical(i - 1, dtdy,
+			hLeft, hRight, huLeft, huRight, io_maxCellSpeedHorizontal, io_maxCellSpeedVertical));
+	}
+	return maxWaveSpeed;
+}
+
+template <class RiemannSolver>
+float SWE_DimensionalSplittingBlockT<RiemannSolver>::computeNumericalFluxesColumnHorizontal(int i,
+	float* o_hNetUpdatesLeft, float* o_hNetUpdatesRight, float* o_huNetUpdatesLeft, float* o_huNetUpdatesRight)
+{
+	float maxWaveSpeed = (float) 0.;
+	for (int tj = 0; tj < nTilesY; tj++)
+	{
+		//the left boundary edges are always computed, as by the fused horizontal sweep
+		if (i > 1 && !hasActiveVerticalEdges(i, tj))
+		{
+			//the net-updates of the edges between quiet tiles are neglected
+			std::fill(o_hNetUpdatesRight + tileBeginY(tj) - 1, o_hNetUpdatesRight + tileEndY(tj) - 1, 0.f);
+			std::fill(o_huNetUpdatesRight + tileBeginY(tj) - 1, o_huNetUpdatesRight + tileEndY(tj) - 1, 0.f);
+			continue;
+		}
+		const int j = tileBeginY(tj);
+		maxWaveSpeed = std::max(maxWaveSpeed, wavePropagationSolver.computeNetUpdates(tileEndY(tj) - j,
+			h[i - 1] + j, h[i] + j, hu[i - 1] + j, hu[i] + j, b[i - 1] + j, b[i] + j,
+			o_hNetUpdatesLeft + j - 1, o_hNetUpdatesRight + j - 1,
+			o_huNetUpdatesLeft + j - 1, o_huNetUpdatesRight + j - 1
+		));
+	}
+	return maxWaveSpeed;
+}
+
+template <class RiemannSolver>
+float SWE_DimensionalSplittingBlockT<RiemannSolver>::computeNumericalFluxesAndUpdateColumnVertical(int i, float dtdy,
+	float* hBelow, float* hAbove, float* hvBelow, float* hvAbove,
+	float& io_maxCellSpeedHorizontal, float& io_maxCellSpeedVertical)
+{
+	float maxWaveSpeed = (float) 0.;
+	//the above net-update is carried along the column
+	float hNetUpdateAbove = 0.f, hvNetUpdateAbove = 0.f;
+	float* cellSpeedsX = &cellSpeedsHorizontal[(i - 1) * nTilesY];
+	float* cellSpeedsY = &cellSpeedsVertical[(i - 1) * nTilesY];
+	for (int tj = 0; tj < nTilesY; tj++)
+	{
+		//the last tile row includes the top boundary edge
+		const int jBegin = tileBeginY(tj);
+		const int jEnd = (tj == nTilesY - 1) ? ny + 2 : tileEndY(tj);
+		if (!hasActiveHorizontalEdges(i, tj))
+		{
+			//cell j-1 is quiet, the net-updates of its edges are neglected, the cells keep their speeds
+			hNetUpdateAbove = hvNetUpdateAbove = 0.f;
+			io_maxCellSpeedHorizontal = std::max(io_maxCellSpeedHorizontal, cellSpeedsX[tj]);
+			io_maxCellSpeedVertical = std::max(io_maxCellSpeedVertical, cellSpeedsY[tj]);
+			continue;
+		}
+		maxWaveSpeed = std::max(maxWaveSpeed, wavePropagationSolver.computeNetUpdates(jEnd - jBegin,
+			h[i] + jBegin - 1, h[i] + jBegin, hv[i] + jBegin - 1, hv[i] + jBegin, b[i] + jBegin - 1, b[i] + jBegin,
+			hBelow, hAbove, hvBelow, hvAbove
+		));
+		//the first edge completes the last cell of the previous tile row, the ghost cell below the first edge is not updated
+		if (jBegin > 1)
+		{
+			h[i][jBegin - 1] -= dtdy * (hNetUpdateAbove + hBelow[0]);
+			hv[i][jBegin - 1] -= dtdy * (hvNetUpdateAbove + hvBelow[0]);
+			const float speedX = cellSpeed(h[i][jBegin - 1], hu[i][jBegin - 1]);
+			const float speedY = cellSpeed(h[i][jBegin - 1], hv[i][jBegin - 1]);
+			cellSpeedsX[tj - 1] = std::max(cellSpeedsX[tj - 1], speedX);
+			cellSpeedsY[tj - 1] = std::max(cellSpeedsY[tj - 1], speedY);
+			io_maxCellSpeedHorizontal = std::max(io_maxCellSpeedHorizontal, speedX);
+			io_maxCellSpeedVertical = std::max(io_maxCellSpeedVertical, speedY);
+		}
+		//the other cells take the carried net-update from the buffer, so the loop has no dependency
+		StorageFloat* hCell = h[i] + jBegin - 1;
+		StorageFloat* hvCell = hv[i] + jBegin - 1;
+		const StorageFloat* huCell = hu[i] + jBegin - 1;
+		float speedX = (float) 0., speedY = (float) 0.;
+		#pragma omp simd reduction(max: speedX, speedY)
+		for (int k = 1; k < jEnd - jBegin; k++)
+		{
+			hCell[k] -= dtdy * (hAbove[k - 1] + hBelow[k]);
+			hvCell[k] -= dtdy * (hvAbove[k - 1] + hvBelow[k]);
+			speedX = std::max(speedX, cellSpeed(hCell[k], huCell[k]));
+			speedY = std::max(speedY, cellSpeed(hCell[k], hvCell[k]));
+		}
+		//the tile row is complete except for its last cell, which the next tile row adds
+		cellSpeedsX[tj] = speedX;
+		cellSpeedsY[tj] = speedY;
+		io_maxCellSpeedHorizontal = std::max(io_maxCellSpeedHorizontal, speedX);
+		io_maxCellSpeedVertical = std::max(io_maxCellSpeedVertical, speedY);
+		hNetUpdateAbove = hAbove[jEnd - jBegin - 1];
+		hvNetUpdateAbove = hvAbove[jEnd - jBegin - 1];
 	}
-}
\ No newline at end of file
+	return maxWaveSpeed;
+}
+
+// The Riemann solvers, which can be selected at runtime (see SWE_BlockFactory.cpp)
+template class SWE_DimensionalSplittingBlockT<SWE_FWaveBranchFree>;
+template class SWE_DimensionalSplittingBlockT<solver::AugRie<float> >;
+template class SWE_DimensionalSplittingBlockT<solver::Hybrid<float> >;
@@ -7,26 +7,34 @@
 #define _SWE_DIMENSIONAL_SPLITTING_HPP
 
 #include "blocks/SWE_Block.hh"
+#include "blocks/SWE_BatchedSolver.hh"
+#include "blocks/SWE_FWaveBranchFree.hh"
+#include "tools/FastMath.hh"
 #include "tools/help.hh"
 
+#include <algorithm>
+#include <cmath>
 #include <string>
+#include <vector>
 
 #define SUPPRESS_SOLVER_DEBUG_OUTPUT
 // #define SOLVER_DEBUG_OUTPUT_ONLYNONZERO
 
 #include "../submodules/solvers/src/solver/FWave.hpp"
+#include "../submodules/solvers/src/solver/AugRie.hpp"
+#include "../submodules/solvers/src/solver/Hybrid.hpp"
 
 /**
- * @brief This is an implementation of the SWE_Block abstract class.
- *  It uses a f-wave solver.
+ * @brief This is an implementation of the SWE_Block abstract class,
+ *  which splits a time step into a horizontal and a vertical sweep.
+ *
+ * The sweeps, which solve the Riemann problems, are implemented by the subclasses
+ * SWE_DimensionalSplittingBlockT (for every Riemann solver) and SWE_DimensionalSplittingBlockSIMD.
  */
 class SWE_DimensionalSplittingBlock : public SWE_Block 
 {
     
-private:
-
-    //! The actual f-wave solver itself
-    solver::FWave<float> wavePropagationSolver;
+protected:
 
     //! Net-updates for the heights of the cells on the left sides of the vertical edges.
     Float2D hNetUpdatesLeft;
@@ -48,18 +56,186 @@ private:
     //! Net-updates for the y-momentums of the cells above the horizontal edges.
     Float2D hvNetUpdatesAbove;
 
+    //! Carried net-updates for the heights (right side of the last vertical edge, one column per thread), used by the fused sweeps
+    Float2D hNetUpdatesCarried;
+    //! Carried net-updates for the x-momentums (right side of the last vertical edge, one column per thread), used by the fused sweeps
+    Float2D huNetUpdatesCarried;
+
+    //! Net-updates for the heights of the cells left of the first vertical edge of each strip, used by the tiled sweeps
+    Float2D hNetUpdatesStripEdge;
+    //! Net-updates for the x-momentums of the cells left of the first vertical edge of each strip, used by the tiled sweeps
+    Float2D huNetUpdatesStripEdge;
+
+    //! Wether the fused sweeps are used (the net-update buffers are not allocated in this case)
+    bool fusedSweeps;
+    //! Wether advance() runs the fused sweeps tiled, see computeNumericalFluxesAndUpdate()
+    bool tiledSweeps;
+
     //! Amount of threads used
     int numThreads;
     //! Amount ofrows/cols per thread
     int workPerThread_horizontal, workPerThread_vertical;
 
+    //! Dry tolerance of the solvers, cells with less water have no wave speed
+    static const float dryTol;
+
+    //! Upper bounds of the wave speeds |u| + sqrt(g*h) of the cells, per column and tile row ((i-1) * nTilesY + tj)
+    std::vector<float> cellSpeedsHorizontal;
+    //! Upper bounds of the wave speeds |v| + sqrt(g*h) of the cells, per column and tile row ((i-1) * nTilesY + tj)
+    std::vector<float> cellSpeedsVertical;
+    //! Tile size of the cell speeds, 0 if they do not describe the unknowns anymore
+    int cellSpeedsTileSize;
+
+    //! Maximum wave speeds of the cells in x and y direction, reduced by the last vertical sweep
+    float maxCellSpeedHorizontal, maxCellSpeedVertical;
+    //! Wether the maximum wave speeds of the cells describe the current unknowns
+    bool maxCellSpeedsValid;
+
+    /**
+     * @brief Wave speed of a cell in one direction
+     * 
+     * The speed |u| + sqrt(g*h) (or |v| + sqrt(g*h)) bounds the wave speeds at the edges of the cell,
+     * dry cells have none. The cell is selected, not branched on, so the loops calling this are vectorized,
+     * the common terms of both directions are computed once after inlining.
+     * 
+     * @param i_h Water height of the cell
+     * @param i_momentum Momentum of the cell in the direction
+     */
+    static inline float cellSpeed(float i_h, float i_momentum)
+    {
+        const bool wet = i_h >= dryTol;
+#ifdef FAST_MATH
+        //1/h = g * rsqrt(gh)^2 and sqrt(gh) = gh * rsqrt(gh), see FastMath.hh
+        const float gh = g * i_h;
+        const float rsqrtGh = fastmath::rsqrt(gh);
+        const float inverseH = g * rsqrtGh * rsqrtGh;
+        const float celerity = gh * rsqrtGh;
+#else
+        const float inverseH = 1.f / i_h;
+        const float celerity = std::sqrt(g * i_h);
+#endif
+        return wet ? std::abs(i_momentum) * inverseH + celerity : 0.f;
+    }
+
+    /**
+     * @brief Computes the wave speeds of all cells
+     * 
+     * Only needed before the first sweep, after the unknowns were written from outside
+     * or after the tile size changed, the sweeps keep the speeds up to date otherwise.
+     */
+    void scanCellSpeeds();
+
+    /**
+     * @brief Scans the cell speeds, if the quiet tiles of a vertical sweep cannot use their stored speeds
+     */
+    void prepareCellSpeeds() { if (cellSpeedsTileSize != tileSize) scanCellSpeeds(); }
+
+    // the cell speeds are invalid after an external update of the unknowns
+    void synchWaterHeightAfterWrite();
+    void synchDischargeAfterWrite();
+
+    //! Maximum wave speed of the edges of each strip in the last fused sweep
+    std::vector<float> stripMaxWaveSpeeds;
+    //! Maximum wave speeds of the cells of each strip in x direction, reduced by the last vertical sweep
+    std::vector<float> stripMaxCellSpeedsHorizontal;
+    //! Maximum wave speeds of the cells of each strip in y direction, reduced by the last vertical sweep
+    std::vector<float> stripMaxCellSpeedsVertical;
+
+    /**
+     * @brief Computes the net-updates of the vertical edges left of the columns [iBegin, iEnd)
+     * 
+     * Column nx + 1 stands for the right boundary edge.
+     * 
+     * @return Maximum wave speed of the edges
+     */
+    virtual float computeNetUpdatesHorizontal(int iBegin, int iEnd) = 0;
+
     /**
-     * @brief Converts small values to zero
+     * @brief Computes the net-updates of the horizontal edges of the columns [iBegin, iEnd)
      * 
-     * Sets small values of h, hv and hu to zero
-     * This is not used currently
+     * @return Maximum wave speed of the edges
      */
-    void zeroSmallValues();
+    virtual float computeNetUpdatesVertical(int iBegin, int iEnd) = 0;
+
+    /**
+     * @brief Computes the vertical edges of the rows [jBegin, jEnd) and updates their cells in one pass
+     * 
+     * The fused horizontal sweep splits the rows into one strip per thread
+     * (or into the tile rows, if a thread pool is set), every strip streams through all columns.
+     * 
+     * @param t Thread, whose net-update buffers are used
+     * @param dtdx delta time divided by the width of a cell
+     * @return Maximum wave speed of the edges
+     */
+    virtual float computeNumericalFluxesAndUpdateRowsHorizontal(int jBegin, int jEnd, int t, float dtdx) = 0;
+
+    /**
+     * @brief Computes the horizontal edges of the columns [iBegin, iEnd) and updates their cells in one pass
+     * 
+     * The fused vertical sweep splits the columns into one strip per thread
+     * (or into the tile columns, if a thread pool is set).
+     * 
+     * @param t Thread, whose net-update buffers are used
+     * @param dtdy delta time divided by the height of a cell
+     * @param io_maxCellSpeedHorizontal Maximum wave speed of the cells in x direction, raised to the cells of the columns
+     * @param io_maxCellSpeedVertical Maximum wave speed of the cells in y direction, raised to the cells of the columns
+     * @return Maximum wave speed of the edges
+     */
+    virtual float computeNumericalFluxesAndUpdateColumnsVertical(int iBegin, int iEnd, int t, float dtdy,
+        float& io_maxCellSpeedHorizontal, float& io_maxCellSpeedVertical) = 0;
+
+    /**
+     * @brief Computes the first vertical edge of strip t of the tiled sweeps
+     * 
+     * The right net-updates are carried to the first column of the strip,
+     * the left ones are kept for the last column of the previous strip.
+     * 
+     * @param t Strip
+     * @return Maximum wave speed of the edges
+     */
+    virtual float computeNumericalFluxesStripEdge(int t) = 0;
+
+    /**
+     * @brief Sweeps strip t of the tiled sweeps, after the first edges of all strips are computed
+     * 
+     * @param t Strip
+     * @param dtdx delta time divided by the width of a cell
+     * @param dtdy delta time divided by the height of a cell
+     * @param io_maxCellSpeedHorizontal Maximum wave speed of the cells in x direction, raised to the cells of the strip
+     * @param io_maxCellSpeedVertical Maximum wave speed of the cells in y direction, raised to the cells of the strip
+     * @return Maximum wave speed of the edges
+     */
+    virtual float computeNumericalFluxesAndUpdateStrip(int t, float dtdx, float dtdy,
+        float& io_maxCellSpeedHorizontal, float& io_maxCellSpeedVertical) = 0;
+
+    /**
+     * @brief Runs the strips of the fused horizontal sweep with the threads of the enclosing parallel region
+     * 
+     * All threads of the team have to call it, the strips are shared among them (orphaned worksharing)
+     * and are complete on return. The results are kept per strip, see reduceStrips().
+     * Outside of a parallel region, the calling thread sweeps all strips.
+     * The same holds for sweepStripsVertical() and sweepStripsTiled().
+     */
+    void sweepStripsHorizontal(float dtdx);
+    //! Runs the strips of the fused vertical sweep with the threads of the enclosing parallel region
+    void sweepStripsVertical(float dtdy);
+    //! Runs the strips of the tiled sweeps with the threads of the enclosing parallel region
+    void sweepStripsTiled(float dtdx, float dtdy);
+
+    /**
+     * @brief Reduces the results of the strips of the last fused sweep
+     * 
+     * @param i_cellSpeeds Wether the sweep was a vertical one, which reduced the wave speeds of the cells
+     * @return Maximum wave speed of the edges
+     */
+    float reduceStrips(bool i_cellSpeeds);
+
+    //! Updates the cells of column i with the net-updates of the horizontal sweep
+    void updateUnknownsColumnHorizontal(float dt, int i);
+    //! Updates the cells of column i with the net-updates of the vertical sweep, and raises the maxima to the speeds of its cells
+    void updateUnknownsColumnVertical(float dt, int i, float& io_maxCellSpeedHorizontal, float& io_maxCellSpeedVertical);
+    //! Updates the cells of column i with the net-updates of both sweeps
+    void updateUnknownsColumn(float dt, int i);
 
   public:
 
@@ -71,8 +247,9 @@ private:
      * @param l_dx Width of a cell
      * @param l_dy Height of a cell
      * @param numthreads The amount of parallel threads to use
+     * @param fused Wether to use the fused sweeps, which compute and apply the net-updates in one pass
      */
-    SWE_DimensionalSplittingBlock(int l_nx, int l_ny, float l_dx, float l_dy, int numthreads);
+    SWE_DimensionalSplittingBlock(int l_nx, int l_ny, float l_dx, float l_dy, int numthreads, bool fused = false);
 
     /**
      * @brief Computes the horizontal fluxes
@@ -84,6 +261,105 @@ private:
      */
     float computeNumericalFluxesVertical();
 
+    /**
+     * @brief Adds the bottom and top ghost layers to the activity mask before the vertical sweep
+     * 
+     * The activity mask is updated at the start of the horizontal sweep. If the bottom and top ghost layers
+     * are set after the horizontal sweep, e.g. received from the neighbours, water entering through them
+     * has to activate the adjacent tiles of the vertical sweep. The mask only gains active tiles,
+     * the left and right ghost layers are unchanged and add nothing.
+     */
+    void addBottomTopGhostLayersToTileActivity() { addGhostLayersToTileActivity(); }
+
+    /**
+     * @brief Sets the thread pool, which runs the sweeps in place of OpenMP
+     * 
+     * The fused sweeps keep net-update buffers per thread,
+     * so the pool must not have more threads than the block was created for.
+     */
+    void setThreadPool(tools::ThreadPool* i_threadPool);
+
+    /**
+     * @brief Upper bound of the wave speeds in x direction
+     * 
+     * The maximum of |u| + sqrt(g*h) over the cells. It is reduced by the vertical sweeps,
+     * in the same vectorized loops and threads which update the cells, so it costs no pass over the grid.
+     * The cells of quiet tiles keep the speeds of their last update.
+     * After the unknowns were written from outside or by a horizontal sweep alone, the cells are scanned.
+     * 
+     * @return Upper bound of the horizontal wave speeds
+     */
+    float getMaxCellSpeedHorizontal();
+
+    /**
+     * @brief Upper bound of the wave speeds in y direction
+     * 
+     * The maximum of |v| + sqrt(g*h) over the cells, see getMaxCellSpeedHorizontal().
+     * 
+     * @return Upper bound of the vertical wave speeds
+     */
+    float getMaxCellSpeedVertical();
+
+    /**
+     * @brief Computes the horizontal fluxes and updates the cells in one pass
+     * 
+     * Only the net-updates of the last column of edges are kept.
+     * The time step has to be known in advance, see getMaxCellSpeedHorizontal() and getMaxCellSpeedVertical().
+     * 
+     * @param dt delta time
+     * @return Maximum wave speed of the horizontal sweep
+     */
+    virtual float computeNumericalFluxesAndUpdateHorizontal(float dt);
+
+    /**
+     * @brief Computes the vertical fluxes and updates the cells in one pass
+     * 
+     * @param dt delta time
+     * @return Maximum wave speed of the vertical sweep
+     */
+    virtual float computeNumericalFluxesAndUpdateVertical(float dt);
+
+    /**
+     * @brief Computes both sweeps and updates the cells, column by column
+     * 
+     * Gives the same result as the fused horizontal sweep followed by the fused vertical sweep.
+     * The columns are split into one strip per thread, which is swept from left to right.
+     * Each column gets its horizontal update as soon as the edge to its right neighbour
+     * is computed, and its vertical update right after, while it is still in the cache.
+     * The previous strip updates the cells left of the first edge of a strip,
+     * so these edges are computed before the strips are swept.
+     * 
+     * @param dt delta time
+     * @return Maximum wave speed of both sweeps
+     */
+    virtual float computeNumericalFluxesAndUpdate(float dt);
+
+    /**
+     * @brief Runs time steps until tEnd or maxSteps is reached
+     * 
+     * A time step consists of the sweeps of the dimensional splitting driver, with the time step
+     * of getMaxCellSpeedHorizontal() and getMaxCellSpeedVertical() for the fused sweeps.
+     * The fused sweeps run all time steps within one parallel region: the strips are shared among its threads,
+     * the ghost layers and the time step are set by one of them, so a time step costs the barriers
+     * between its phases, but no fork of a thread team.
+     * 
+     * @param io_time Simulation time, advanced by the time steps
+     * @param i_tEnd Time of the next output
+     * @param i_maxSteps Maximum number of time steps
+     * @return Number of time steps done
+     */
+    int advance(float& io_time, float i_tEnd, int i_maxSteps = std::numeric_limits<int>::max());
+
+    /**
+     * @brief Sets, wether advance() runs the fused sweeps tiled (see computeNumericalFluxesAndUpdate())
+     */
+    void setTiledSweeps(bool i_tiled) { tiledSweeps = i_tiled; }
+
+    /**
+     * @brief Wether the fused sweeps are used
+     */
+    bool usesFusedSweeps() { return fusedSweeps; }
+
     /**
      * @brief Computes all fluxes
      * 
@@ -102,6 +378,14 @@ private:
      */
     void computeMaxTimestep(float max, bool is_horizontal);
 
+    /**
+     * @brief Computes the maximum timestep, which satisfies the CFL condition in both directions
+     * 
+     * @param maxHorizontal Maximum wave speed in x direction
+     * @param maxVertical Maximum wave speed in y direction
+     */
+    void computeMaxTimestep(float maxHorizontal, float maxVertical);
+
     /**
      * @brief Updates the cells horizontal values
      * 
@@ -125,11 +409,97 @@ private:
 
     /**
      * @brief Destructor
-     *
-     * In the case of a hybrid solver (NDEBUG not defined) information about the used solvers will be printed.
      */
     virtual ~SWE_DimensionalSplittingBlock() {}
 
 };
 
+/**
+ * @brief Dimensional splitting block, which solves the Riemann problems of the sweeps
+ *  with the given solver.
+ *
+ * The solver is a template parameter, so its computeNetUpdates() is inlined into the sweeps,
+ * which pass it a contiguous segment of a column of edges at once (see SWE_BatchedSolver).
+ * The block is instantiated for SWE_FWaveBranchFree, solver::AugRie and solver::Hybrid
+ * (see SWE_DimensionalSplittingBlock.cpp), the instances are selected at runtime with
+ * blocks::createBlock().
+ */
+template <class RiemannSolver>
+class SWE_DimensionalSplittingBlockT : public SWE_DimensionalSplittingBlock
+{
+
+private:
+
+    //! The actual Riemann solver itself, batched over the rows
+    SWE_BatchedSolver<RiemannSolver> wavePropagationSolver;
+
+    //! Net-updates for the heights of one segment of edges per thread (left/below and right/above), used by the fused sweeps
+    Float2D hNetUpdatesBuffer;
+    //! Net-updates for the momentums of one segment of edges per thread (left/below and right/above), used by the fused sweeps
+    Float2D huvNetUpdatesBuffer;
+
+    /**
+     * @brief Computes the vertical edges left of column i and keeps their net-updates
+     * 
+     * @param i Column of the cells right of the edges
+     * @param o_hNetUpdatesLeft Net-updates for the heights of the cells left of the edges, one per row
+     * @param o_hNetUpdatesRight Net-updates for the heights of the cells right of the edges, one per row
+     * @param o_huNetUpdatesLeft Net-updates for the x-momentums of the cells left of the edges, one per row
+     * @param o_huNetUpdatesRight Net-updates for the x-momentums of the cells right of the edges, one per row
+     * @return Maximum wave speed of the edges
+     */
+    float computeNumericalFluxesColumnHorizontal(int i, float* o_hNetUpdatesLeft, float* o_hNetUpdatesRight,
+        float* o_huNetUpdatesLeft, float* o_huNetUpdatesRight);
+
+    /**
+     * @brief Computes the horizontal edges of column i and updates its cells in one pass
+     * 
+     * The wave speeds of the updated cells are reduced in the same loop,
+     * the cells of quiet tiles contribute their stored speeds.
+     * 
+     * @param i Column
+     * @param dtdy delta time divided by the height of a cell
+     * @param hBelow Buffer for the net-updates of the heights below the edges of a tile
+     * @param hAbove Buffer for the net-updates of the heights above the edges of a tile
+     * @param hvBelow Buffer for the net-updates of the y-momentums below the edges of a tile
+     * @param hvAbove Buffer for the net-updates of the y-momentums above the edges of a tile
+     * @param io_maxCellSpeedHorizontal Maximum wave speed of the cells in x direction, raised to the cells of the column
+     * @param io_maxCellSpeedVertical Maximum wave speed of the cells in y direction, raised to the cells of the column
+     * @return Maximum wave speed of the edges
+     */
+    float computeNumericalFluxesAndUpdateColumnVertical(int i, float dtdy,
+        float* hBelow, float* hAbove, float* hvBelow, float* hvAbove,
+        float& io_maxCellSpeedHorizontal, float& io_maxCellSpeedVertical);
+
+    // the net-updates of the unfused sweeps and the strips of the fused sweeps, see SWE_DimensionalSplittingBlock
+    float computeNetUpdatesHorizontal(int iBegin, int iEnd);
+    float computeNetUpdatesVertical(int iBegin, int iEnd);
+    float computeNumericalFluxesAndUpdateRowsHorizontal(int jBegin, int jEnd, int t, float dtdx);
+    float computeNumericalFluxesAndUpdateColumnsVertical(int iBegin, int iEnd, int t, float dtdy,
+        float& io_maxCellSpeedHorizontal, float& io_maxCellSpeedVertical);
+    float computeNumericalFluxesStripEdge(int t);
+    float computeNumericalFluxesAndUpdateStrip(int t, float dtdx, float dtdy,
+        float& io_maxCellSpeedHorizontal, float& io_maxCellSpeedVertical);
+
+  public:
+
+    /**
+     * @brief Constructor
+     * 
+     * @param l_nx Amount of cells in x dimension
+     * @param l_ny Amount of cells in y dimension
+     * @param l_dx Width of a cell
+     * @param l_dy Height of a cell
+     * @param numthreads The amount of parallel threads to use
+     * @param fused Wether to use the fused sweeps, which compute and apply the net-updates in one pass
+     */
+    SWE_DimensionalSplittingBlockT(int l_nx, int l_ny, float l_dx, float l_dy, int numthreads, bool fused = false);
+
+    /**
+     * @brief Destructor
+     */
+    virtual ~SWE_DimensionalSplittingBlockT() {}
+
+};
+
 #endif
\ No newline at end of file
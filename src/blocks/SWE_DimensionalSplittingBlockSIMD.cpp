@@ -0,0 +1,276 @@
+/**
+ * @file SWE_DimensionalSplittingBlockSIMD.cpp
+ * @brief Implements the functionality defined in SWE_DimensionalSplittingBlockSIMD.hh
+ */
+
+#include "SWE_DimensionalSplittingBlockSIMD.hh"
+
+#include <algorithm>
+#include <cassert>
+#include <omp.h>
+
+
+SWE_DimensionalSplittingBlockSIMD::SWE_DimensionalSplittingBlockSIMD (int l_nx, int l_ny, float l_dx, float l_dy, int numthreads, bool fused) :
+	SWE_DimensionalSplittingBlock (l_nx, l_ny, l_dx, l_dy, numthreads, fused),
+	hNetUpdatesBuffer (3 * numthreads, ny + 1, fused, true),
+	huvNetUpdatesBuffer (3 * numthreads, ny + 1, fused, true),
+	fWaveNetUpdates (simd::getFWaveKernel().netUpdates)
+{
+}
+
+float SWE_DimensionalSplittingBlockSIMD::computeNetUpdatesHorizontal(int iBegin, int iEnd)
+{
+	float maxWaveSpeed = (float) 0.;
+	//every column of vertical edges is one contiguous vector loop over the rows of a tile
+	for (int i = iBegin; i < iEnd; i++)
+	{
+		for (int tj = 0; tj < nTilesY; tj++)
+		{
+			//the edges between quiet tiles are skipped
+			if (!hasActiveVerticalEdges(i, tj))
+				continue;
+			const int j = tileBeginY(tj);
+			float maxSegmentSpeed = fWaveNetUpdates(tileEndY(tj) - j,
+				h[i - 1] + j, h[i] + j, hu[i - 1] + j, hu[i] + j, b[i - 1] + j, b[i] + j,
+				hNetUpdatesLeft[i - 1] + j - 1, hNetUpdatesRight[i - 1] + j - 1,
+				huNetUpdatesLeft[i - 1] + j - 1, huNetUpdatesRight[i - 1] + j - 1
+			);
+			maxWaveSpeed = std::max(maxWaveSpeed, maxSegmentSpeed);
+		}
+	}
+	return maxWaveSpeed;
+}
+
+float SWE_DimensionalSplittingBlockSIMD::computeNetUpdatesVertical(int iBegin, int iEnd)
+{
+	float maxWaveSpeed = (float) 0.;
+	//the cells below and above the horizontal edges of a column are the same array, shifted by one
+	for (int i = iBegin; i < iEnd; i++)
+	{
+		for (int tj = 0; tj < nTilesY; tj++)
+		{
+			//the edges between quiet tiles are skipped, the last tile row includes the top boundary edge
+			if (!hasActiveHorizontalEdges(i, tj))
+				continue;
+			const int j = tileBeginY(tj);
+			const int jEnd = (tj == nTilesY - 1) ? ny + 2 : tileEndY(tj);
+			float maxSegmentSpeed = fWaveNetUpdates(jEnd - j,
+				h[i] + j - 1, h[i] + j, hv[i] + j - 1, hv[i] + j, b[i] + j - 1, b[i] + j,
+				hNetUpdatesBelow[i - 1] + j - 1, hNetUpdatesAbove[i - 1] + j - 1,
+				hvNetUpdatesBelow[i - 1] + j - 1, hvNetUpdatesAbove[i - 1] + j - 1
+			);
+			maxWaveSpeed = std::max(maxWaveSpeed, maxSegmentSpeed);
+		}
+	}
+	return maxWaveSpeed;
+}
+
+float SWE_DimensionalSplittingBlockSIMD::computeNumericalFluxesAndUpdateRowsHorizontal(int jBegin, int jEnd, int t, float dtdx)
+{
+	float maxWaveSpeed = (float) 0.;
+	if (jBegin >= jEnd)
+		return maxWaveSpeed;
+	const int rows = jEnd - jBegin;
+	float* hCarried = hNetUpdatesCarried[0] + jBegin - 1;
+	float* huCarried = huNetUpdatesCarried[0] + jBegin - 1;
+	float* hLeft = hNetUpdatesBuffer[2*t] + jBegin - 1;
+	float* huLeft = huvNetUpdatesBuffer[2*t] + jBegin - 1;
+	float* hRight = hNetUpdatesBuffer[2*t + 1] + jBegin - 1;
+	float* huRight = huvNetUpdatesBuffer[2*t + 1] + jBegin - 1;
+
+	maxWaveSpeed = std::max(maxWaveSpeed, fWaveNetUpdates(rows,
+		h[0] + jBegin, h[1] + jBegin, hu[0] + jBegin, hu[1] + jBegin, b[0] + jBegin, b[1] + jBegin,
+		hLeft, hCarried, huLeft, huCarried
+	));
+	for (int i = 2; i < nx + 2; i++)
+	{
+		for (int tj = (jBegin - 1) / tileSize; tj <= (jEnd - 2) / tileSize; tj++)
+		{
+			//offsets of the rows of the tile within the rows of the thread
+			const int k = std::max(jBegin, tileBeginY(tj)) - jBegin;
+			const int kEnd = std::min(jEnd, tileEndY(tj)) - jBegin;
+			if (!hasActiveVerticalEdges(i, tj))
+			{
+				//cell i-1 is quiet, the net-updates of its edges are neglected
+				std::fill(hLeft + k, hLeft + kEnd, 0.f);
+				std::fill(huLeft + k, huLeft + kEnd, 0.f);
+				std::fill(hRight + k, hRight + kEnd, 0.f);
+				std::fill(huRight + k, huRight + kEnd, 0.f);
+				std::fill(hCarried + k, hCarried + kEnd, 0.f);
+				std::fill(huCarried + k, huCarried + kEnd, 0.f);
+				continue;
+			}
+			const int j = jBegin + k;
+			maxWaveSpeed = std::max(maxWaveSpeed, fWaveNetUpdates(kEnd - k,
+				h[i - 1] + j, h[i] + j, hu[i - 1] + j, hu[i] + j, b[i - 1] + j, b[i] + j,
+				hLeft + k, hRight + k, huLeft + k, huRight + k
+			));
+		}
+		float* hCell = h[i - 1] + jBegin;
+		float* huCell = hu[i - 1] + jBegin;
+		for (int j = 0; j < rows; j++)
+		{
+			hCell[j] -= dtdx * (hCarried[j] + hLeft[j]);
+			huCell[j] -= dtdx * (huCarried[j] + huLeft[j]);
+		}
+		//the right net-updates of this column are carried to the next one
+		std::swap(hCarried, hRight);
+		std::swap(huCarried, huRight);
+	}
+	return maxWaveSpeed;
+}
+
+float SWE_DimensionalSplittingBlockSIMD::computeNumericalFluxesAndUpdateColumnsVertical(int iBegin, int iEnd, int t, float dtdy,
+	float& io_maxCellSpeedHorizontal, float& io_maxCellSpeedVertical)
+{
+	float maxWaveSpeed = (float) 0.;
+	//the net-updates of one column of edges are kept per thread
+	float* hBelow = hNetUpdatesBuffer[2*t];
+	float* hvBelow = huvNetUpdatesBuffer[2*t];
+	float* hAbove = hNetUpdatesBuffer[2*t + 1];
+	float* hvAbove = huvNetUpdatesBuffer[2*t + 1];
+	for (int i = iBegin; i < iEnd; i++)
+		maxWaveSpeed = std::max(maxWaveSpeed, computeNumericalFluxesAndUpdateColumnVertical(i, dtdy, hBelow, hAbove, hvBelow, hvAbove,
+			io_maxCellSpeedHorizontal, io_maxCellSpeedVertical));
+	return maxWaveSpeed;
+}
+
+float SWE_DimensionalSplittingBlockSIMD::computeNumericalFluxesStripEdge(int t)
+{
+	const int iBegin = (t*workPerThread_horizontal) + 1;
+	if (iBegin >= nx + 1)
+		return (float) 0.;
+	//the right net-updates are carried to the first column of the strip
+	return computeNumericalFluxesColumnHorizontal(iBegin,
+		hNetUpdatesStripEdge[t], hNetUpdatesBuffer[3*t + 2], huNetUpdatesStripEdge[t], huvNetUpdatesBuffer[3*t + 2]);
+}
+
+float SWE_DimensionalSplittingBlockSIMD::computeNumericalFluxesAndUpdateStrip(int t, float dtdx, float dtdy,
+	float& io_maxCellSpeedHorizontal, float& io_maxCellSpeedVertical)
+{
+	float maxWaveSpeed = (float) 0.;
+	const int iBegin = (t*workPerThread_horizontal) + 1;
+	const int iEnd = std::min(((t+1)*workPerThread_horizontal) + 1, nx + 1);
+	//the three buffers of the thread rotate: the carried right net-updates, the left ones and a spare one
+	float* hCarried = hNetUpdatesBuffer[3*t + 2];
+	float* huCarried = huvNetUpdatesBuffer[3*t + 2];
+	float* hLeft = hNetUpdatesBuffer[3*t];
+	float* huLeft = huvNetUpdatesBuffer[3*t];
+	float* hRight = hNetUpdatesBuffer[3*t + 1];
+	float* huRight = huvNetUpdatesBuffer[3*t + 1];
+	for (int i = iBegin + 1; i <= iEnd; i++)
+	{
+		//the last edge of a strip is the first edge of the next one, except for the right boundary
+		if (i == iEnd && i < nx + 1)
+		{
+			std::copy(hNetUpdatesStripEdge[t + 1], hNetUpdatesStripEdge[t + 1] + ny, hLeft);
+			std::copy(huNetUpdatesStripEdge[t + 1], huNetUpdatesStripEdge[t + 1] + ny, huLeft);
+			for (int tj = 0; tj < nTilesY; tj++)
+			{
+				//the first edge of the next strip is not computed between quiet tiles
+				if (!hasActiveVerticalEdges(i, tj))
+				{
+					std::fill(hLeft + tileBeginY(tj) - 1, hLeft + tileEndY(tj) - 1, 0.f);
+					std::fill(huLeft + tileBeginY(tj) - 1, huLeft + tileEndY(tj) - 1, 0.f);
+					std::fill(hCarried + tileBeginY(tj) - 1, hCarried + tileEndY(tj) - 1, 0.f);
+					std::fill(huCarried + tileBeginY(tj) - 1, huCarried + tileEndY(tj) - 1, 0.f);
+				}
+			}
+		}
+		else
+		{
+			maxWaveSpeed = std::max(maxWaveSpeed, computeNumericalFluxesColumnHorizontal(i, hLeft, hRight, huLeft, huRight));
+			for (int tj = 0; tj < nTilesY; tj++)
+			{
+				//cell i-1 is quiet, the net-updates of its edges are neglected
+				if (!hasActiveVerticalEdges(i, tj))
+				{
+					std::fill(hCarried + tileBeginY(tj) - 1, hCarried + tileEndY(tj) - 1, 0.f);
+					std::fill(huCarried + tileBeginY(tj) - 1, huCarried + tileEndY(tj) - 1, 0.f);
+				}
+			}
+		}
+		float* hCell = h[i - 1] + 1;
+		float* huCell = hu[i - 1] + 1;
+		for (int j = 0; j < ny; j++)
+		{
+			hCell[j] -= dtdx * (hCarried[j] + hLeft[j]);
+			huCell[j] -= dtdx * (huCarried[j] + huLeft[j]);
+		}
+		//the right net-updates of this column are carried to the next one
+		std::swap(hCarried, hRight);
+		std::swap(huCarried, huRight);
+		//column i-1 is complete in x direction, the vertical sweep only reads the column itself,
+		//the left and the spare buffers are free until the next column
+		maxWaveSpeed = std::max(maxWaveSpeed, computeNumericalFluxesAndUpdateColumnVertical(i - 1, dtdy, hLeft, hRight, huLeft, huRight,
+			io_maxCellSpeedHorizontal, io_maxCellSpeedVertical));
+	}
+	return maxWaveSpeed;
+}
+
+float SWE_DimensionalSplittingBlockSIMD::computeNumericalFluxesColumnHorizontal(int i,
+	float* o_hNetUpdatesLeft, float* o_hNetUpdatesRight, float* o_huNetUpdatesLeft, float* o_huNetUpdatesRight)
+{
+	float maxWaveSpeed = (float) 0.;
+	for (int tj = 0; tj < nTilesY; tj++)
+	{
+		const int j = tileBeginY(tj);
+		//the left boundary edges are always computed, as by the fused horizontal sweep
+		if (i > 1 && !hasActiveVerticalEdges(i, tj))
+		{
+			//the net-updates of the edges between quiet tiles are neglected
+			std::fill(o_hNetUpdatesLeft + j - 1, o_hNetUpdatesLeft + tileEndY(tj) - 1, 0.f);
+			std::fill(o_hNetUpdatesRight + j - 1, o_hNetUpdatesRight + tileEndY(tj) - 1, 0.f);
+			std::fill(o_huNetUpdatesLeft + j - 1, o_huNetUpdatesLeft + tileEndY(tj) - 1, 0.f);
+			std::fill(o_huNetUpdatesRight + j - 1, o_huNetUpdatesRight + tileEndY(tj) - 1, 0.f);
+			continue;
+		}
+		maxWaveSpeed = std::max(maxWaveSpeed, fWaveNetUpdates(tileEndY(tj) - j,
+			h[i - 1] + j, h[i] + j, hu[i - 1] + j, hu[i] + j, b[i - 1] + j, b[i] + j,
+			o_hNetUpdatesLeft + j - 1, o_hNetUpdatesRight + j - 1,
+			o_huNetUpdatesLeft + j - 1, o_huNetUpdatesRight + j - 1
+		));
+	}
+	return maxWaveSpeed;
+}
+
+float SWE_DimensionalSplittingBlockSIMD::computeNumericalFluxesAndUpdateColumnVertical(int i, float dtdy,
+	float* hBelow, float* hAbove, float* hvBelow, float* hvAbove,
+	float& io_maxCellSpeedHorizontal, float& io_maxCellSpeedVertical)
+{
+	float maxWaveSpeed = (float) 0.;
+	for (int tj = 0; tj < nTilesY; tj++)
+	{
+		//the last tile row includes the top boundary edge
+		const int j = tileBeginY(tj);
+		const int jEnd = (tj == nTilesY - 1) ? ny + 2 : tileEndY(tj);
+		if (!hasActiveHorizontalEdges(i, tj))
+		{
+			//the net-updates of the edges between quiet tiles are neglected
+			std::fill(hBelow + j - 1, hBelow + jEnd - 1, 0.f);
+			std::fill(hvBelow + j - 1, hvBelow + jEnd - 1, 0.f);
+			std::fill(hAbove + j - 1, hAbove + jEnd - 1, 0.f);
+			std::fill(hvAbove + j - 1, hvAbove + jEnd - 1, 0.f);
+			continue;
+		}
+		maxWaveSpeed = std::max(maxWaveSpeed, fWaveNetUpdates(jEnd - j,
+			h[i] + j - 1, h[i] + j, hv[i] + j - 1, hv[i] + j, b[i] + j - 1, b[i] + j,
+			hBelow + j - 1, hAbove + j - 1, hvBelow + j - 1, hvAbove + j - 1
+		));
+	}
+	float* hCell = h[i];
+	float* hvCell = hv[i];
+	const float* huCell = hu[i];
+	float speedX = io_maxCellSpeedHorizontal, speedY = io_maxCellSpeedVertical;
+	#pragma omp simd reduction(max: speedX, speedY)
+	for (int j = 1; j < ny + 1; j++)
+	{
+		hCell[j] -= dtdy * (hAbove[j - 1] + hBelow[j]);
+		hvCell[j] -= dtdy * (hvAbove[j - 1] + hvBelow[j]);
+		speedX = std::max(speedX, cellSpeed(hCell[j], huCell[j]));
+		speedY = std::max(speedY, cellSpeed(hCell[j], hvCell[j]));
+	}
+	io_maxCellSpeedHorizontal = speedX;
+	io_maxCellSpeedVertical = speedY;
+	return maxWaveSpeed;
+}
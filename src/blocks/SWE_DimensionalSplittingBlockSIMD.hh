@@ -0,0 +1,96 @@
+/**
+ * @file SWE_DimensionalSplittingBlockSIMD.hh
+ * @brief Defines a system for dimensional splitting, using explicitly vectorized f-wave kernels
+ */
+
+#ifndef _SWE_DIMENSIONAL_SPLITTING_SIMD_HPP
+#define _SWE_DIMENSIONAL_SPLITTING_SIMD_HPP
+
+#include "blocks/SWE_DimensionalSplittingBlock.hh"
+#include "blocks/SWE_FWaveSIMD.hh"
+
+/**
+ * @brief Dimensional splitting block, which solves the Riemann problems of
+ *  consecutive edges with SSE4, AVX or AVX-512 instructions.
+ *
+ * The edges of a sweep are contiguous in memory along the columns,
+ * so each vector holds the edges of 4, 8 or 16 neighbouring rows.
+ * The instruction set is selected at runtime, see simd::getFWaveKernel().
+ */
+class SWE_DimensionalSplittingBlockSIMD : public SWE_DimensionalSplittingBlock
+{
+
+private:
+
+    //! Net-updates for the heights of one column of edges per thread (left/below, right/above and a spare one), used by the fused sweeps
+    Float2D hNetUpdatesBuffer;
+    //! Net-updates for the momentums of one column of edges per thread (left/below, right/above and a spare one), used by the fused sweeps
+    Float2D huvNetUpdatesBuffer;
+
+    //! The f-wave kernel of the widest instruction set supported by the CPU
+    simd::FWaveNetUpdates fWaveNetUpdates;
+
+    /**
+     * @brief Computes the vertical edges left of column i, the edges between quiet tiles are set to zero
+     *
+     * @param i Column of the cells right of the edges
+     * @param o_hNetUpdatesLeft Net-updates for the heights of the cells left of the edges, one per row
+     * @param o_hNetUpdatesRight Net-updates for the heights of the cells right of the edges, one per row
+     * @param o_huNetUpdatesLeft Net-updates for the x-momentums of the cells left of the edges, one per row
+     * @param o_huNetUpdatesRight Net-updates for the x-momentums of the cells right of the edges, one per row
+     * @return Maximum wave speed of the edges
+     */
+    float computeNumericalFluxesColumnHorizontal(int i, float* o_hNetUpdatesLeft, float* o_hNetUpdatesRight,
+        float* o_huNetUpdatesLeft, float* o_huNetUpdatesRight);
+
+    /**
+     * @brief Computes the horizontal edges of column i and updates its cells
+     *
+     * Every cell of the column is written, so the wave speeds of all of them are reduced in the update loop.
+     *
+     * @param i Column
+     * @param dtdy delta time divided by the height of a cell
+     * @param hBelow Buffer for the net-updates of the heights below the edges (ny + 1 rows)
+     * @param hAbove Buffer for the net-updates of the heights above the edges (ny + 1 rows)
+     * @param hvBelow Buffer for the net-updates of the y-momentums below the edges (ny + 1 rows)
+     * @param hvAbove Buffer for the net-updates of the y-momentums above the edges (ny + 1 rows)
+     * @param io_maxCellSpeedHorizontal Maximum wave speed of the cells in x direction, raised to the cells of the column
+     * @param io_maxCellSpeedVertical Maximum wave speed of the cells in y direction, raised to the cells of the column
+     * @return Maximum wave speed of the edges
+     */
+    float computeNumericalFluxesAndUpdateColumnVertical(int i, float dtdy,
+        float* hBelow, float* hAbove, float* hvBelow, float* hvAbove,
+        float& io_maxCellSpeedHorizontal, float& io_maxCellSpeedVertical);
+
+    // the net-updates of the unfused sweeps and the strips of the fused sweeps, see SWE_DimensionalSplittingBlock
+    float computeNetUpdatesHorizontal(int iBegin, int iEnd);
+    float computeNetUpdatesVertical(int iBegin, int iEnd);
+    float computeNumericalFluxesAndUpdateRowsHorizontal(int jBegin, int jEnd, int t, float dtdx);
+    float computeNumericalFluxesAndUpdateColumnsVertical(int iBegin, int iEnd, int t, float dtdy,
+        float& io_maxCellSpeedHorizontal, float& io_maxCellSpeedVertical);
+    float computeNumericalFluxesStripEdge(int t);
+    float computeNumericalFluxesAndUpdateStrip(int t, float dtdx, float dtdy,
+        float& io_maxCellSpeedHorizontal, float& io_maxCellSpeedVertical);
+
+  public:
+
+    /**
+     * @brief Constructor
+     *
+     * @param l_nx Amount of cells in x dimension
+     * @param l_ny Amount of cells in y dimension
+     * @param l_dx Width of a cell
+     * @param l_dy Height of a cell
+     * @param numthreads The amount of parallel threads to use
+     * @param fused Wether to use the fused sweeps, which compute and apply the net-updates in one pass
+     */
+    SWE_DimensionalSplittingBlockSIMD(int l_nx, int l_ny, float l_dx, float l_dy, int numthreads, bool fused = false);
+
+    /**
+     * @brief Destructor
+     */
+    virtual ~SWE_DimensionalSplittingBlockSIMD() {}
+
+};
+
+#endif
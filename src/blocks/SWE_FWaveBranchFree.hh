@@ -0,0 +1,155 @@
+/**
+ * @file SWE_FWaveBranchFree.hh
+ * @brief F-wave solver without data-dependent branches
+ *
+ * The scalar counterpart of the explicitly vectorized f-wave kernel (see SWE_FWaveSIMD_kernels.hh):
+ * the same formulation, with conditional selects in place of the masks. Every edge executes the same
+ * instructions, wet or dry, so the compiler vectorizes the loops of SWE_BatchedSolver over the edges
+ * also along coastlines, without intrinsics and with any storage type of the unknowns.
+ *
+ * In the fast numerical mode (see FastMath.hh), the square roots and divisions of the depths
+ * are computed with reciprocal square roots.
+ */
+
+#ifndef _SWE_FWAVE_BRANCH_FREE_HPP
+#define _SWE_FWAVE_BRANCH_FREE_HPP
+
+#include <algorithm>
+#include <cmath>
+
+#include "tools/FastMath.hh"
+
+/**
+ * @brief F-wave solver of a single edge, with the interface of the solvers of the submodule
+ */
+class SWE_FWaveBranchFree
+{
+  private:
+    //! Dry tolerance, cells with less water are dry
+    float dryTol;
+    //! Gravity
+    float gravity;
+    //! Tolerance of the wave speeds, waves slower than this are split between both cells
+    float zeroTol;
+
+    //! b, if the condition holds, a otherwise: both operands are computed, so this is a blend, not a branch
+    static inline float select(bool i_condition, float a, float b) { return i_condition ? b : a; }
+
+  public:
+    /**
+     * @brief Constructor, with the tolerances of solver::FWave
+     */
+    SWE_FWaveBranchFree(float i_dryTol = 0.01f, float i_gravity = 9.81f, float i_zeroTol = 0.0000001f) :
+      dryTol(i_dryTol), gravity(i_gravity), zeroTol(i_zeroTol) {}
+
+    /**
+     * @brief Computes the net-updates of an edge
+     *
+     * A dry cell next to a wet one is replaced by the reflected wet cell (wall boundary) and
+     * receives no updates, an edge between two dry cells yields no updates and a wave speed of zero.
+     * The approximations are used, if the block was built in the fast numerical mode.
+     */
+    inline void computeNetUpdates(const float& i_hLeft, const float& i_hRight,
+        const float& i_huLeft, const float& i_huRight,
+        const float& i_bLeft, const float& i_bRight,
+        float& o_hUpdateLeft, float& o_hUpdateRight,
+        float& o_huUpdateLeft, float& o_huUpdateRight,
+        float& o_maxWaveSpeed) const
+    {
+        computeNetUpdatesT<fastmath::enabled>(i_hLeft, i_hRight, i_huLeft, i_huRight, i_bLeft, i_bRight,
+            o_hUpdateLeft, o_hUpdateRight, o_huUpdateLeft, o_huUpdateRight, o_maxWaveSpeed);
+    }
+
+    /**
+     * @brief Computes the net-updates of an edge, exactly or with the approximations of fastmath
+     *
+     * Both variants are available in every build, so they can be compared with each other.
+     */
+    template <bool fast>
+    inline void computeNetUpdatesT(const float& i_hLeft, const float& i_hRight,
+        const float& i_huLeft, const float& i_huRight,
+        const float& i_bLeft, const float& i_bRight,
+        float& o_hUpdateLeft, float& o_hUpdateRight,
+        float& o_huUpdateLeft, float& o_huUpdateRight,
+        float& o_maxWaveSpeed) const
+    {
+        //the non short-circuit operators keep the conditions branch-free
+        const bool dryLeft = i_hLeft < dryTol;
+        const bool dryRight = i_hRight < dryTol;
+        const bool dryBoth = dryLeft & dryRight;
+        const bool reflectLeft = dryLeft & !dryRight;
+        const bool reflectRight = dryRight & !dryLeft;
+
+        //reflect the wet cell at dry neighbours
+        float hLeft = select(reflectLeft, i_hLeft, i_hRight);
+        float huLeft = select(reflectLeft, i_huLeft, -i_huRight);
+        const float bLeft = select(reflectLeft, i_bLeft, i_bRight);
+        float hRight = select(reflectRight, i_hRight, i_hLeft);
+        float huRight = select(reflectRight, i_huRight, -i_huLeft);
+        const float bRight = select(reflectRight, i_bRight, i_bLeft);
+
+        //harmless values for edges without water, their results are discarded
+        hLeft = select(dryBoth, hLeft, 1.f);
+        hRight = select(dryBoth, hRight, 1.f);
+        huLeft = select(dryBoth, huLeft, 0.f);
+        huRight = select(dryBoth, huRight, 0.f);
+
+        //Roe averages and wave speeds
+        float uLeft, uRight, uRoe, cRoe;
+        //1 / (speed2 - speed1) = 1 / (2 cRoe)
+        float inverseSpeedDiff;
+        if (fast) {
+            //u = hu * rsqrt(h)^2, u * sqrt(h) = hu * rsqrt(h), c = gh * rsqrt(gh)
+            const float rsqrtHLeft = fastmath::rsqrt(hLeft);
+            const float rsqrtHRight = fastmath::rsqrt(hRight);
+            uLeft = huLeft * rsqrtHLeft * rsqrtHLeft;
+            uRight = huRight * rsqrtHRight * rsqrtHRight;
+            uRoe = (huLeft * rsqrtHLeft + huRight * rsqrtHRight) / (hLeft * rsqrtHLeft + hRight * rsqrtHRight);
+            const float cRoeSquared = gravity * (0.5f * (hRight + hLeft));
+            const float rsqrtCRoeSquared = fastmath::rsqrt(cRoeSquared);
+            cRoe = cRoeSquared * rsqrtCRoeSquared;
+            inverseSpeedDiff = 0.5f * rsqrtCRoeSquared;
+        } else {
+            uLeft = huLeft / hLeft;
+            uRight = huRight / hRight;
+            const float sqrtHLeft = std::sqrt(hLeft);
+            const float sqrtHRight = std::sqrt(hRight);
+            uRoe = (uLeft * sqrtHLeft + uRight * sqrtHRight) / (sqrtHLeft + sqrtHRight);
+            cRoe = std::sqrt(gravity * (0.5f * (hRight + hLeft)));
+        }
+        const float speed1 = uRoe - cRoe;
+        const float speed2 = uRoe + cRoe;
+
+        //jump in the fluxes including the bathymetry source term
+        const float halfGravity = 0.5f * gravity;
+        const float fluxDiff1 = huRight - huLeft;
+        const float fluxDiff2 = ((huRight * uRight + halfGravity * hRight * hRight)
+            - (huLeft * uLeft + halfGravity * hLeft * hLeft))
+            + halfGravity * (hRight + hLeft) * (bRight - bLeft);
+
+        //decompose into the eigenvectors
+        if (!fast)
+            inverseSpeedDiff = 1.f / (speed2 - speed1);
+        const float alpha1 = (speed2 * fluxDiff1 - fluxDiff2) * inverseSpeedDiff;
+        const float alpha2 = (fluxDiff2 - speed1 * fluxDiff1) * inverseSpeedDiff;
+
+        //share of each wave for the left and right cell: 1, 0 or 0.5 for (almost) standing waves
+        const float left1 = select(speed1 < -zeroTol, select(speed1 > zeroTol, 0.5f, 0.f), 1.f);
+        const float right1 = select(speed1 > zeroTol, select(speed1 < -zeroTol, 0.5f, 0.f), 1.f);
+        const float left2 = select(speed2 < -zeroTol, select(speed2 > zeroTol, 0.5f, 0.f), 1.f);
+        const float right2 = select(speed2 > zeroTol, select(speed2 < -zeroTol, 0.5f, 0.f), 1.f);
+
+        const float wave1Momentum = alpha1 * speed1;
+        const float wave2Momentum = alpha2 * speed2;
+
+        //dry cells do not receive updates
+        o_hUpdateLeft = select(dryLeft, left1 * alpha1 + left2 * alpha2, 0.f);
+        o_huUpdateLeft = select(dryLeft, left1 * wave1Momentum + left2 * wave2Momentum, 0.f);
+        o_hUpdateRight = select(dryRight, right1 * alpha1 + right2 * alpha2, 0.f);
+        o_huUpdateRight = select(dryRight, right1 * wave1Momentum + right2 * wave2Momentum, 0.f);
+
+        o_maxWaveSpeed = select(dryBoth, std::max(std::fabs(speed1), std::fabs(speed2)), 0.f);
+    }
+};
+
+#endif
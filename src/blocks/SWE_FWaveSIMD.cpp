@@ -0,0 +1,65 @@
+/**
+ * @file SWE_FWaveSIMD.cpp
+ * @brief Implements the functionality defined in SWE_FWaveSIMD.hh
+ */
+
+#include "SWE_FWaveSIMD.hh"
+
+#include <stdexcept>
+
+namespace
+{
+
+/**
+ * @brief An entry of the dispatch table
+ */
+struct Candidate
+{
+    //! The kernel
+    simd::FWaveKernel kernel;
+    //! Wether the CPU supports the instruction set of the kernel
+    bool (*isSupported)();
+};
+
+#if defined(VECTOR_DISPATCH) || defined(VECTOR_AVX512_FLOAT32)
+bool supportsAVX512() { return __builtin_cpu_supports("avx512f"); }
+#endif
+#if defined(VECTOR_DISPATCH) || defined(VECTOR_AVX_FLOAT32)
+bool supportsAVX() { return __builtin_cpu_supports("avx"); }
+#endif
+#if defined(VECTOR_DISPATCH) || defined(VECTOR_SSE4_FLOAT32)
+bool supportsSSE4() { return __builtin_cpu_supports("sse4.1"); }
+#endif
+
+//! The compiled kernels, widest first
+const Candidate candidates[] = {
+#if defined(VECTOR_DISPATCH) || defined(VECTOR_AVX512_FLOAT32)
+    { { "AVX-512", 16, simd::avx512::fWaveNetUpdates }, supportsAVX512 },
+#endif
+#if defined(VECTOR_DISPATCH) || defined(VECTOR_AVX_FLOAT32)
+    { { "AVX", 8, simd::avx::fWaveNetUpdates }, supportsAVX },
+#endif
+#if defined(VECTOR_DISPATCH) || defined(VECTOR_SSE4_FLOAT32)
+    { { "SSE4", 4, simd::sse4::fWaveNetUpdates }, supportsSSE4 },
+#endif
+};
+
+const simd::FWaveKernel& selectFWaveKernel()
+{
+    __builtin_cpu_init();
+    for (unsigned int i = 0; i < sizeof(candidates) / sizeof(candidates[0]); i++)
+    {
+        if (candidates[i].isSupported())
+            return candidates[i].kernel;
+    }
+    throw std::runtime_error("The CPU does not support the instruction set of the compiled f-wave kernels");
+}
+
+}
+
+const simd::FWaveKernel& simd::getFWaveKernel()
+{
+    //selected once, the initialization of local statics is thread-safe
+    static const FWaveKernel& kernel = selectFWaveKernel();
+    return kernel;
+}
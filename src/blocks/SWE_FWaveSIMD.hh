@@ -0,0 +1,66 @@
+/**
+ * @file SWE_FWaveSIMD.hh
+ * @brief Runtime selection of the explicitly vectorized f-wave kernel
+ *
+ * The kernel is compiled for every instruction set enabled by the simdExtensions build variable
+ * (all of SSE4, AVX and AVX-512 for simdExtensions=DISPATCH). The widest one supported by the CPU
+ * is picked the first time getFWaveKernel() is called.
+ */
+
+#ifndef _SWE_FWAVE_SIMD_HPP
+#define _SWE_FWAVE_SIMD_HPP
+
+namespace simd
+{
+
+/**
+ * @brief Computes the f-wave net-updates of n consecutive edges
+ *
+ * @param n Amount of edges
+ * @return Maximum wave speed of the edges
+ */
+typedef float (*FWaveNetUpdates)(int n,
+    const float* i_hLeft, const float* i_hRight,
+    const float* i_huLeft, const float* i_huRight,
+    const float* i_bLeft, const float* i_bRight,
+    float* o_hUpdateLeft, float* o_hUpdateRight,
+    float* o_huUpdateLeft, float* o_huUpdateRight);
+
+/**
+ * @brief An f-wave kernel for one instruction set
+ */
+struct FWaveKernel
+{
+    //! Name of the instruction set
+    const char* name;
+    //! Amount of edges processed by one vector instruction
+    int vectorLength;
+    //! The kernel itself
+    FWaveNetUpdates netUpdates;
+};
+
+/**
+ * @brief Returns the kernel of the widest instruction set supported by the CPU
+ *
+ * Throws a std::runtime_error, if the CPU supports none of the compiled instruction sets.
+ */
+const FWaveKernel& getFWaveKernel();
+
+// The instantiations, see SWE_FWaveSIMD_kernels.cpp
+#define SWE_FWAVE_SIMD_DECLARE(isa) \
+    namespace isa { \
+        float fWaveNetUpdates(int n, \
+            const float* i_hLeft, const float* i_hRight, \
+            const float* i_huLeft, const float* i_huRight, \
+            const float* i_bLeft, const float* i_bRight, \
+            float* o_hUpdateLeft, float* o_hUpdateRight, \
+            float* o_huUpdateLeft, float* o_huUpdateRight); \
+    }
+SWE_FWAVE_SIMD_DECLARE(sse4)
+SWE_FWAVE_SIMD_DECLARE(avx)
+SWE_FWAVE_SIMD_DECLARE(avx512)
+#undef SWE_FWAVE_SIMD_DECLARE
+
+}
+
+#endif
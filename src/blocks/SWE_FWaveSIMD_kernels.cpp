@@ -0,0 +1,23 @@
+/**
+ * @file SWE_FWaveSIMD_kernels.cpp
+ * @brief Instantiates the f-wave kernel for one instruction set
+ *
+ * This file is compiled once per instruction set (see SConscript),
+ * with the matching compiler flags and VECTOR_*_FLOAT32 define.
+ */
+
+#include "SWE_FWaveSIMD.hh"
+#include "SWE_FWaveSIMD_kernels.hh"
+
+float simd::SIMD_ISA::fWaveNetUpdates(int n,
+	const float* i_hLeft, const float* i_hRight,
+	const float* i_huLeft, const float* i_huRight,
+	const float* i_bLeft, const float* i_bRight,
+	float* o_hUpdateLeft, float* o_hUpdateRight,
+	float* o_huUpdateLeft, float* o_huUpdateRight)
+{
+	return computeNetUpdates(n,
+		i_hLeft, i_hRight, i_huLeft, i_huRight, i_bLeft, i_bRight,
+		o_hUpdateLeft, o_hUpdateRight, o_huUpdateLeft, o_huUpdateRight
+	);
+}
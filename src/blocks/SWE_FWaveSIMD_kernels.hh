@@ -0,0 +1,313 @@
+/**
+ * @file SWE_FWaveSIMD_kernels.hh
+ * @brief Explicitly vectorized f-wave kernel
+ *
+ * The instruction set is selected by the translation unit including this file,
+ * which defines one of VECTOR_SSE4_FLOAT32 (4 edges per instruction), VECTOR_AVX_FLOAT32 (8 edges)
+ * or VECTOR_AVX512_FLOAT32 (16 edges). The kernel is placed in the namespace simd::sse4, simd::avx
+ * or simd::avx512, so several instruction sets can be linked into one binary, see SWE_FWaveSIMD.hh.
+ */
+
+#ifndef _SWE_FWAVE_SIMD_KERNELS_HPP
+#define _SWE_FWAVE_SIMD_KERNELS_HPP
+
+#include <cstring>
+#include <immintrin.h>
+
+#if defined(VECTOR_AVX512_FLOAT32)
+#define SIMD_ISA avx512
+#elif defined(VECTOR_AVX_FLOAT32)
+#define SIMD_ISA avx
+#elif defined(VECTOR_SSE4_FLOAT32)
+#define SIMD_ISA sse4
+#else
+#error "The f-wave SIMD kernels require simdExtensions=SSE4, AVX, AVX512 or DISPATCH"
+#endif
+
+namespace simd
+{
+namespace SIMD_ISA
+{
+
+#if defined(VECTOR_AVX512_FLOAT32)
+
+    //! Amount of edges processed by one vector instruction
+    const int vectorLength = 16;
+    typedef __m512 real;
+    typedef __mmask16 mask;
+
+    inline real load(const float* p) { return _mm512_loadu_ps(p); }
+    inline void store(float* p, real a) { _mm512_storeu_ps(p, a); }
+    inline real set(float a) { return _mm512_set1_ps(a); }
+    inline real add(real a, real b) { return _mm512_add_ps(a, b); }
+    inline real sub(real a, real b) { return _mm512_sub_ps(a, b); }
+    inline real mul(real a, real b) { return _mm512_mul_ps(a, b); }
+    inline real div(real a, real b) { return _mm512_div_ps(a, b); }
+    inline real sqrt(real a) { return _mm512_sqrt_ps(a); }
+    //! Approximation of 1/sqrt(a), relative error below 2^-14
+    inline real rsqrtApprox(real a) { return _mm512_rsqrt14_ps(a); }
+    inline real max(real a, real b) { return _mm512_max_ps(a, b); }
+    inline real neg(real a) { return _mm512_sub_ps(_mm512_setzero_ps(), a); }
+    inline real abs(real a) { return _mm512_max_ps(a, neg(a)); }
+    inline mask lt(real a, real b) { return _mm512_cmp_ps_mask(a, b, _CMP_LT_OQ); }
+    inline mask gt(real a, real b) { return _mm512_cmp_ps_mask(a, b, _CMP_GT_OQ); }
+    inline mask andMask(mask a, mask b) { return a & b; }
+    //! a and not b
+    inline mask andNotMask(mask a, mask b) { return a & ~b; }
+    //! Lanes of b where m is set, lanes of a otherwise
+    inline real select(mask m, real a, real b) { return _mm512_mask_blend_ps(m, a, b); }
+    inline float reduceMax(real a) { return _mm512_reduce_max_ps(a); }
+
+#elif defined(VECTOR_AVX_FLOAT32)
+
+    //! Amount of edges processed by one vector instruction
+    const int vectorLength = 8;
+    typedef __m256 real;
+    typedef __m256 mask;
+
+    inline real load(const float* p) { return _mm256_loadu_ps(p); }
+    inline void store(float* p, real a) { _mm256_storeu_ps(p, a); }
+    inline real set(float a) { return _mm256_set1_ps(a); }
+    inline real add(real a, real b) { return _mm256_add_ps(a, b); }
+    inline real sub(real a, real b) { return _mm256_sub_ps(a, b); }
+    inline real mul(real a, real b) { return _mm256_mul_ps(a, b); }
+    inline real div(real a, real b) { return _mm256_div_ps(a, b); }
+    inline real sqrt(real a) { return _mm256_sqrt_ps(a); }
+    //! Approximation of 1/sqrt(a), relative error below 1.5 * 2^-12
+    inline real rsqrtApprox(real a) { return _mm256_rsqrt_ps(a); }
+    inline real max(real a, real b) { return _mm256_max_ps(a, b); }
+    inline real neg(real a) { return _mm256_xor_ps(a, _mm256_set1_ps(-0.f)); }
+    inline real abs(real a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.f), a); }
+    inline mask lt(real a, real b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+    inline mask gt(real a, real b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+    inline mask andMask(mask a, mask b) { return _mm256_and_ps(a, b); }
+    //! a and not b
+    inline mask andNotMask(mask a, mask b) { return _mm256_andnot_ps(b, a); }
+    //! Lanes of b where m is set, lanes of a otherwise (blendv is lowered to scalar code by some compilers without AVX2)
+    inline real select(mask m, real a, real b) { return _mm256_or_ps(_mm256_and_ps(m, b), _mm256_andnot_ps(m, a)); }
+    inline float reduceMax(real a)
+    {
+        __m128 l_max = _mm_max_ps(_mm256_castps256_ps128(a), _mm256_extractf128_ps(a, 1));
+        l_max = _mm_max_ps(l_max, _mm_movehl_ps(l_max, l_max));
+        l_max = _mm_max_ss(l_max, _mm_shuffle_ps(l_max, l_max, 1));
+        return _mm_cvtss_f32(l_max);
+    }
+
+#elif defined(VECTOR_SSE4_FLOAT32)
+
+    //! Amount of edges processed by one vector instruction
+    const int vectorLength = 4;
+    typedef __m128 real;
+    typedef __m128 mask;
+
+    inline real load(const float* p) { return _mm_loadu_ps(p); }
+    inline void store(float* p, real a) { _mm_storeu_ps(p, a); }
+    inline real set(float a) { return _mm_set1_ps(a); }
+    inline real add(real a, real b) { return _mm_add_ps(a, b); }
+    inline real sub(real a, real b) { return _mm_sub_ps(a, b); }
+    inline real mul(real a, real b) { return _mm_mul_ps(a, b); }
+    inline real div(real a, real b) { return _mm_div_ps(a, b); }
+    inline real sqrt(real a) { return _mm_sqrt_ps(a); }
+    //! Approximation of 1/sqrt(a), relative error below 1.5 * 2^-12
+    inline real rsqrtApprox(real a) { return _mm_rsqrt_ps(a); }
+    inline real max(real a, real b) { return _mm_max_ps(a, b); }
+    inline real neg(real a) { return _mm_xor_ps(a, _mm_set1_ps(-0.f)); }
+    inline real abs(real a) { return _mm_andnot_ps(_mm_set1_ps(-0.f), a); }
+    inline mask lt(real a, real b) { return _mm_cmplt_ps(a, b); }
+    inline mask gt(real a, real b) { return _mm_cmpgt_ps(a, b); }
+    inline mask andMask(mask a, mask b) { return _mm_and_ps(a, b); }
+    //! a and not b
+    inline mask andNotMask(mask a, mask b) { return _mm_andnot_ps(b, a); }
+    //! Lanes of b where m is set, lanes of a otherwise
+    inline real select(mask m, real a, real b) { return _mm_blendv_ps(a, b, m); }
+    inline float reduceMax(real a)
+    {
+        real l_max = _mm_max_ps(a, _mm_movehl_ps(a, a));
+        l_max = _mm_max_ss(l_max, _mm_shuffle_ps(l_max, l_max, 1));
+        return _mm_cvtss_f32(l_max);
+    }
+
+#endif
+
+    //! Dry tolerance of the f-wave solver
+    const float dryTol = 0.01f;
+    //! Tolerance of the wave speeds, waves slower than this are split between both cells
+    const float zeroTol = 0.0000001f;
+    //! Gravity
+    const float gravity = 9.81f;
+
+    /**
+     * @brief 1/sqrt(a) for a > 0: the approximation of the instruction set, improved by a Newton step
+     *
+     * Used in the fast numerical mode (see FastMath.hh), the relative error is below fastmath::rsqrtTolerance.
+     */
+    inline real rsqrt(real a)
+    {
+        const real y = rsqrtApprox(a);
+        return mul(y, sub(set(1.5f), mul(mul(set(0.5f), a), mul(y, y))));
+    }
+
+    /**
+     * @brief Computes the f-wave net-updates of vectorLength consecutive edges
+     *
+     * Wet/dry edges are handled with masks instead of branches:
+     * a dry cell next to a wet one is replaced by the reflected wet cell (wall boundary),
+     * edges between two dry cells yield no updates and a wave speed of zero.
+     *
+     * @param maxWaveSpeed Is updated with the maximum wave speeds of the edges (per lane)
+     */
+    inline void computeNetUpdates(
+        const float* i_hLeft, const float* i_hRight,
+        const float* i_huLeft, const float* i_huRight,
+        const float* i_bLeft, const float* i_bRight,
+        float* o_hUpdateLeft, float* o_hUpdateRight,
+        float* o_huUpdateLeft, float* o_huUpdateRight,
+        real& io_maxWaveSpeed)
+    {
+        const real zero = set(0.f);
+        const real one = set(1.f);
+        const real half = set(0.5f);
+        const real halfGravity = set(0.5f * gravity);
+
+        real hLeft = load(i_hLeft), hRight = load(i_hRight);
+        real huLeft = load(i_huLeft), huRight = load(i_huRight);
+        real bLeft = load(i_bLeft), bRight = load(i_bRight);
+
+        const mask dryLeft = lt(hLeft, set(dryTol));
+        const mask dryRight = lt(hRight, set(dryTol));
+        const mask dryBoth = andMask(dryLeft, dryRight);
+        const mask reflectLeft = andNotMask(dryLeft, dryRight);
+        const mask reflectRight = andNotMask(dryRight, dryLeft);
+
+        //reflect the wet cell at dry neighbours
+        const real hLeftWet = hLeft, huLeftWet = huLeft, bLeftWet = bLeft;
+        hLeft = select(reflectLeft, hLeft, hRight);
+        huLeft = select(reflectLeft, huLeft, neg(huRight));
+        bLeft = select(reflectLeft, bLeft, bRight);
+        hRight = select(reflectRight, hRight, hLeftWet);
+        huRight = select(reflectRight, huRight, neg(huLeftWet));
+        bRight = select(reflectRight, bRight, bLeftWet);
+
+        //harmless values for edges without water, their results are discarded
+        hLeft = select(dryBoth, hLeft, one);
+        hRight = select(dryBoth, hRight, one);
+        huLeft = select(dryBoth, huLeft, zero);
+        huRight = select(dryBoth, huRight, zero);
+
+        //Roe averages and wave speeds
+#ifdef FAST_MATH
+        //u = hu * rsqrt(h)^2, u * sqrt(h) = hu * rsqrt(h), c = gh * rsqrt(gh)
+        const real rsqrtHLeft = rsqrt(hLeft);
+        const real rsqrtHRight = rsqrt(hRight);
+        const real uLeft = mul(huLeft, mul(rsqrtHLeft, rsqrtHLeft));
+        const real uRight = mul(huRight, mul(rsqrtHRight, rsqrtHRight));
+        const real uRoe = div(add(mul(huLeft, rsqrtHLeft), mul(huRight, rsqrtHRight)),
+            add(mul(hLeft, rsqrtHLeft), mul(hRight, rsqrtHRight)));
+        const real cRoeSquared = mul(set(gravity), mul(half, add(hRight, hLeft)));
+        const real rsqrtCRoeSquared = rsqrt(cRoeSquared);
+        const real cRoe = mul(cRoeSquared, rsqrtCRoeSquared);
+#else
+        const real uLeft = div(huLeft, hLeft);
+        const real uRight = div(huRight, hRight);
+        const real sqrtHLeft = sqrt(hLeft);
+        const real sqrtHRight = sqrt(hRight);
+        const real uRoe = div(add(mul(uLeft, sqrtHLeft), mul(uRight, sqrtHRight)), add(sqrtHLeft, sqrtHRight));
+        const real cRoe = sqrt(mul(set(gravity), mul(half, add(hRight, hLeft))));
+#endif
+        const real speed1 = sub(uRoe, cRoe);
+        const real speed2 = add(uRoe, cRoe);
+
+        //jump in the fluxes including the bathymetry source term
+        const real fluxDiff1 = sub(huRight, huLeft);
+        const real fluxDiff2 = add(
+            sub(add(mul(huRight, uRight), mul(mul(halfGravity, hRight), hRight)),
+                add(mul(huLeft, uLeft), mul(mul(halfGravity, hLeft), hLeft))),
+            mul(mul(halfGravity, add(hRight, hLeft)), sub(bRight, bLeft)));
+
+        //decompose into the eigenvectors
+#ifdef FAST_MATH
+        //1 / (speed2 - speed1) = 1 / (2 cRoe)
+        const real inverseSpeedDiff = mul(half, rsqrtCRoeSquared);
+#else
+        const real inverseSpeedDiff = div(one, sub(speed2, speed1));
+#endif
+        const real alpha1 = mul(sub(mul(speed2, fluxDiff1), fluxDiff2), inverseSpeedDiff);
+        const real alpha2 = mul(sub(fluxDiff2, mul(speed1, fluxDiff1)), inverseSpeedDiff);
+
+        //share of each wave for the left and right cell: 1, 0 or 0.5 for (almost) standing waves
+        const real negZeroTol = set(-zeroTol), posZeroTol = set(zeroTol);
+        const real left1 = select(lt(speed1, negZeroTol), select(gt(speed1, posZeroTol), half, zero), one);
+        const real right1 = select(gt(speed1, posZeroTol), select(lt(speed1, negZeroTol), half, zero), one);
+        const real left2 = select(lt(speed2, negZeroTol), select(gt(speed2, posZeroTol), half, zero), one);
+        const real right2 = select(gt(speed2, posZeroTol), select(lt(speed2, negZeroTol), half, zero), one);
+
+        const real wave1Momentum = mul(alpha1, speed1);
+        const real wave2Momentum = mul(alpha2, speed2);
+
+        //dry cells do not receive updates
+        store(o_hUpdateLeft, select(dryLeft, add(mul(left1, alpha1), mul(left2, alpha2)), zero));
+        store(o_huUpdateLeft, select(dryLeft, add(mul(left1, wave1Momentum), mul(left2, wave2Momentum)), zero));
+        store(o_hUpdateRight, select(dryRight, add(mul(right1, alpha1), mul(right2, alpha2)), zero));
+        store(o_huUpdateRight, select(dryRight, add(mul(right1, wave1Momentum), mul(right2, wave2Momentum)), zero));
+
+        io_maxWaveSpeed = max(io_maxWaveSpeed, select(dryBoth, max(abs(speed1), abs(speed2)), zero));
+    }
+
+    /**
+     * @brief Computes the f-wave net-updates of n consecutive edges
+     *
+     * The remainder, which does not fill a whole vector, is padded with dry cells.
+     *
+     * @param n Amount of edges
+     * @return Maximum wave speed of the edges
+     */
+    inline float computeNetUpdates(int n,
+        const float* i_hLeft, const float* i_hRight,
+        const float* i_huLeft, const float* i_huRight,
+        const float* i_bLeft, const float* i_bRight,
+        float* o_hUpdateLeft, float* o_hUpdateRight,
+        float* o_huUpdateLeft, float* o_huUpdateRight)
+    {
+        real maxWaveSpeed = set(0.f);
+        int k = 0;
+        for (; k + vectorLength <= n; k += vectorLength)
+        {
+            computeNetUpdates(
+                i_hLeft + k, i_hRight + k, i_huLeft + k, i_huRight + k, i_bLeft + k, i_bRight + k,
+                o_hUpdateLeft + k, o_hUpdateRight + k, o_huUpdateLeft + k, o_huUpdateRight + k,
+                maxWaveSpeed
+            );
+        }
+
+        if (k < n)
+        {
+            //remainder, 10 padded input and output vectors
+            //memset and memcpy instead of std::fill and std::copy: the instantiations of the templates are shared
+            //between the translation units of all instruction sets, so the linker could pick the AVX-512 one
+            float l_buffer[10][vectorLength];
+            std::memset(l_buffer, 0, sizeof(l_buffer));
+            const size_t l_restBytes = (n - k) * sizeof(float);
+            std::memcpy(l_buffer[0], i_hLeft + k, l_restBytes);
+            std::memcpy(l_buffer[1], i_hRight + k, l_restBytes);
+            std::memcpy(l_buffer[2], i_huLeft + k, l_restBytes);
+            std::memcpy(l_buffer[3], i_huRight + k, l_restBytes);
+            std::memcpy(l_buffer[4], i_bLeft + k, l_restBytes);
+            std::memcpy(l_buffer[5], i_bRight + k, l_restBytes);
+            computeNetUpdates(
+                l_buffer[0], l_buffer[1], l_buffer[2], l_buffer[3], l_buffer[4], l_buffer[5],
+                l_buffer[6], l_buffer[7], l_buffer[8], l_buffer[9],
+                maxWaveSpeed
+            );
+            std::memcpy(o_hUpdateLeft + k, l_buffer[6], l_restBytes);
+            std::memcpy(o_hUpdateRight + k, l_buffer[7], l_restBytes);
+            std::memcpy(o_huUpdateLeft + k, l_buffer[8], l_restBytes);
+            std::memcpy(o_huUpdateRight + k, l_buffer[9], l_restBytes);
+        }
+
+        return reduceMax(maxWaveSpeed);
+    }
+
+}
+}
+
+#endif
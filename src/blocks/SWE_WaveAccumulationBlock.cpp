@@ -29,9 +29,12 @@
 
 #include "SWE_WaveAccumulationBlock.hh"
 
+#include <algorithm>
 #include <cassert>
+#include <cmath>
 #include <string>
 #include <limits>
+#include <vector>
 
 #ifdef LOOP_OPENMP
 #include <omp.h>
@@ -49,14 +52,16 @@
  * however, only values on [1,..,nx]*[1,..,ny] are used (i.e., ghost layers are not accessed).
  * Net updates are intended to hold the accumulated(!) net updates computed on the edges.
  *
+ * With deeper ghost layers (l_ghostWidth > 1), nx and ny include the inner ghost layers (see SWE_Block).
  */
 SWE_WaveAccumulationBlock::SWE_WaveAccumulationBlock(
 		int l_nx, int l_ny,
-		float l_dx, float l_dy):
-  SWE_Block(l_nx, l_ny, l_dx, l_dy),
-  hNetUpdates (nx+2, ny+2),
-  huNetUpdates(nx+2, ny+2),
-  hvNetUpdates(nx+2, ny+2)
+		float l_dx, float l_dy, int l_ghostWidth):
+  SWE_Block(l_nx, l_ny, l_dx, l_dy, l_ghostWidth),
+  hNetUpdates (nx+2, ny+2, true, true),
+  huNetUpdates(nx+2, ny+2, true, true),
+  hvNetUpdates(nx+2, ny+2, true, true),
+  maxInteriorWaveSpeed(0)
 {}
 
 /**
@@ -66,96 +71,148 @@ SWE_WaveAccumulationBlock::SWE_WaveAccumulationBlock(
  */
 void SWE_WaveAccumulationBlock::computeNumericalFluxes() {
 
-	float dx_inv = 1.0f/dx;
-	float dy_inv = 1.0f/dy;
-
 	//maximum (linearized) wave speed within one iteration
 	float maxWaveSpeed = (float) 0.;
 
-	// compute the net-updates for the vertical edges
+	//the ghost layers are set, skip the tiles which stay quiet in this time step
+	updateTileActivity();
 
 #ifdef LOOP_OPENMP
 #pragma omp parallel
 {
-	// thread-local maximum wave speed:
-	float l_maxWaveSpeed = (float) 0.;
-
-	// Use OpenMP for the outer loop
-	#pragma omp for
+	const int l_numberOfThreads = omp_get_num_threads();
+	const int l_threadId = omp_get_thread_num();
+#else // LOOP_OPENMP
+	const int l_numberOfThreads = 1;
+	const int l_threadId = 0;
 #endif // LOOP_OPENMP
-	for(int i = 1; i < nx+2; i++) {
-		const int ny_end = ny+1;	// compiler might refuse to vectorize j-loop without this ...
 
-#ifdef VECTORIZE // Vectorize the inner loop
-		#pragma simd
-#endif // VECTORIZE
-		for(int j = 1; j < ny_end; j++) {
+	// owner computes: every thread accumulates the net-updates of its own columns [iBegin, iEnd) only,
+	// so no two threads write the same cell, and every cell adds up its net-updates in the serial order
+	const int l_columnsPerThread = (nx + l_numberOfThreads - 1) / l_numberOfThreads;
+	const int l_iBegin = std::min(1 + l_threadId * l_columnsPerThread, nx + 1);
+	const int l_iEnd = std::min(l_iBegin + l_columnsPerThread, nx + 1);
 
-			float maxEdgeSpeed;
-			float hNetUpLeft, hNetUpRight;
-			float huNetUpLeft, huNetUpRight;
+	// thread-local maximum wave speed
+	const float l_maxWaveSpeed = accumulateNetUpdates(l_iBegin, l_iEnd, 1, ny+1);
 
-			wavePropagationSolver.computeNetUpdates( h[i-1][j], h[i][j],
-                                               hu[i-1][j], hu[i][j],
-                                               b[i-1][j], b[i][j],
-                                               hNetUpLeft, hNetUpRight,
-                                               huNetUpLeft, huNetUpRight,
-                                               maxEdgeSpeed );
-
-			// accumulate net updates to cell-wise net updates for h and hu
-			hNetUpdates[i-1][j]  += dx_inv * hNetUpLeft;
-			huNetUpdates[i-1][j] += dx_inv * huNetUpLeft;
-			hNetUpdates[i][j]    += dx_inv * hNetUpRight;
-			huNetUpdates[i][j]   += dx_inv * huNetUpRight;
-
-			#ifdef LOOP_OPENMP
-				//update the thread-local maximum wave speed
-				l_maxWaveSpeed = std::max(l_maxWaveSpeed, maxEdgeSpeed);
-			#else // LOOP_OPENMP
-				//update the maximum wave speed
-				maxWaveSpeed = std::max(maxWaveSpeed, maxEdgeSpeed);
-			#endif // LOOP_OPENMP
-		}
+#ifdef LOOP_OPENMP
+	#pragma omp critical
+	{
+		maxWaveSpeed = std::max(l_maxWaveSpeed, maxWaveSpeed);
 	}
 
-	// compute the net-updates for the horizontal edges
+} // #pragma omp parallel
+#else // LOOP_OPENMP
+	maxWaveSpeed = l_maxWaveSpeed;
+#endif // LOOP_OPENMP
+
+	setMaxTimestep(maxWaveSpeed);
+}
+
+/**
+ * Compute the net updates of the cells [2,..,nx-1]*[2,..,ny-1], which do not touch the ghost layers.
+ *
+ * The activity mask is updated without reading the ghost layers, which may still be received,
+ * computeNumericalFluxesBoundary() adds them.
+ * The inner ghost layers of deeper ghost layers are computed like cells, so then
+ * all edges are computed by computeNumericalFluxesBoundary().
+ */
+void SWE_WaveAccumulationBlock::computeNumericalFluxesInterior() {
 
-#ifdef LOOP_OPENMP // Use OpenMP for the outer loop
-	#pragma omp for
+	if (ghostWidth > 1)
+		return;
+
+	updateTileActivity(false);
+
+	maxInteriorWaveSpeed = (float) 0.;
+
+#ifdef LOOP_OPENMP
+#pragma omp parallel
+{
+	const int l_numberOfThreads = omp_get_num_threads();
+	const int l_threadId = omp_get_thread_num();
+#else // LOOP_OPENMP
+	const int l_numberOfThreads = 1;
+	const int l_threadId = 0;
 #endif // LOOP_OPENMP
-	for(int i = 1; i < nx+1; i++) {
-		const int ny_end = ny+2;	// compiler refused to vectorize j-loop without this ...
 
-#ifdef VECTORIZE // Vectorize the inner loop	
-		#pragma simd
-#endif // VECTORIZE
-		for(int j = 1; j < ny_end; j++) {
-			float maxEdgeSpeed;
-			float hNetUpDow, hNetUpUpw;
-			float hvNetUpDow, hvNetUpUpw;
-
-			wavePropagationSolver.computeNetUpdates( h[i][j-1], h[i][j],
-                                               hv[i][j-1], hv[i][j],
-                                               b[i][j-1], b[i][j],
-                                               hNetUpDow, hNetUpUpw,
-                                               hvNetUpDow, hvNetUpUpw,
-                                               maxEdgeSpeed );
-
-			// accumulate net updates to cell-wise net updates for h and hu
-			hNetUpdates[i][j-1]  += dy_inv * hNetUpDow;
-			hvNetUpdates[i][j-1] += dy_inv * hvNetUpDow;
-			hNetUpdates[i][j]    += dy_inv * hNetUpUpw;
-			hvNetUpdates[i][j]   += dy_inv * hvNetUpUpw;
-
-			#ifdef LOOP_OPENMP
-				//update the thread-local maximum wave speed
-				l_maxWaveSpeed = std::max(l_maxWaveSpeed, maxEdgeSpeed);
-			#else // LOOP_OPENMP
-				//update the maximum wave speed
-				maxWaveSpeed = std::max(maxWaveSpeed, maxEdgeSpeed);
-			#endif // LOOP_OPENMP
+	// owner computes, as in computeNumericalFluxes(), on the columns [2, nx)
+	const int l_columns = std::max(nx - 2, 0);
+	const int l_columnsPerThread = (l_columns + l_numberOfThreads - 1) / l_numberOfThreads;
+	const int l_iBegin = std::min(2 + l_threadId * l_columnsPerThread, 2 + l_columns);
+	const int l_iEnd = std::min(l_iBegin + l_columnsPerThread, 2 + l_columns);
+
+	const float l_maxWaveSpeed = accumulateNetUpdates(l_iBegin, l_iEnd, 2, ny);
+
+#ifdef LOOP_OPENMP
+	#pragma omp critical
+	{
+		maxInteriorWaveSpeed = std::max(l_maxWaveSpeed, maxInteriorWaveSpeed);
+	}
+
+} // #pragma omp parallel
+#else // LOOP_OPENMP
+	maxInteriorWaveSpeed = l_maxWaveSpeed;
+#endif // LOOP_OPENMP
+}
+
+/**
+ * Compute the net updates of the cells next to the ghost layers, which have to be set,
+ * and the maximum time step of all edges (see computeNumericalFluxesInterior()).
+ *
+ * Every cell adds up the net-updates of its edges in the same order as in computeNumericalFluxes(),
+ * the edges between the interior cells and the cells next to the ghost layers are computed twice.
+ */
+void SWE_WaveAccumulationBlock::computeNumericalFluxesBoundary() {
+
+	if (ghostWidth > 1) {
+		computeNumericalFluxes();
+		return;
+	}
+
+	addGhostLayersToTileActivity();
+
+	// the left and the right column and the remainders of the bottom and the top row,
+	// cut into pieces of a tile: iBegin, iEnd, jBegin, jEnd of every piece
+	std::vector<int> l_pieces;
+	for(int j = 1; j < ny+1; j += tileSize) {
+		const int l_jEnd = std::min(j + tileSize, ny+1);
+		const int l_left[] = { 1, 2, j, l_jEnd };
+		l_pieces.insert(l_pieces.end(), l_left, l_left + 4);
+		if (nx > 1) {
+			const int l_right[] = { nx, nx+1, j, l_jEnd };
+			l_pieces.insert(l_pieces.end(), l_right, l_right + 4);
 		}
 	}
+	for(int i = 2; i < nx; i += tileSize) {
+		const int l_iEnd = std::min(i + tileSize, nx);
+		const int l_bottom[] = { i, l_iEnd, 1, 2 };
+		l_pieces.insert(l_pieces.end(), l_bottom, l_bottom + 4);
+		if (ny > 1) {
+			const int l_top[] = { i, l_iEnd, ny, ny+1 };
+			l_pieces.insert(l_pieces.end(), l_top, l_top + 4);
+		}
+	}
+	const int l_numberOfPieces = (int) l_pieces.size() / 4;
+
+	float maxWaveSpeed = maxInteriorWaveSpeed;
+
+#ifdef LOOP_OPENMP
+#pragma omp parallel
+{
+	// thread-local maximum wave speed:
+	float l_maxWaveSpeed = (float) 0.;
+
+	#pragma omp for schedule(dynamic)
+#else // LOOP_OPENMP
+	float& l_maxWaveSpeed = maxWaveSpeed;
+#endif // LOOP_OPENMP
+	for(int p = 0; p < l_numberOfPieces; p++) {
+		const int* l_piece = &l_pieces[4*p];
+		l_maxWaveSpeed = std::max(l_maxWaveSpeed,
+		                          accumulateNetUpdates(l_piece[0], l_piece[1], l_piece[2], l_piece[3]));
+	}
 
 #ifdef LOOP_OPENMP
 	#pragma omp critical
@@ -164,9 +221,137 @@ void SWE_WaveAccumulationBlock::computeNumericalFluxes() {
 	}
 
 } // #pragma omp parallel
-#endif
+#endif // LOOP_OPENMP
+
+	setMaxTimestep(maxWaveSpeed);
+}
+
+/**
+ * Accumulates the net-updates of the cells [iBegin, iEnd) x [jBegin, jEnd) from all of their edges,
+ * the net-updates of the cells outside are not changed.
+ *
+ * The vertical edges are added before the horizontal ones, and both from left to right (bottom to top),
+ * so the result of every cell does not depend on the ranges it is computed in.
+ *
+ * @return maximum wave speed of the computed edges
+ */
+float SWE_WaveAccumulationBlock::accumulateNetUpdates(int i_iBegin, int i_iEnd, int i_jBegin, int i_jEnd) {
+
+	float dx_inv = 1.0f/dx;
+	float dy_inv = 1.0f/dy;
+
+	//maximum (linearized) wave speed of the edges
+	float maxWaveSpeed = (float) 0.;
+
+	if (i_iBegin >= i_iEnd || i_jBegin >= i_jEnd)
+		return maxWaveSpeed;
+
+	// compute the net-updates for the vertical edges
+	for(int i = i_iBegin; i < i_iEnd + 1; i++) {
+		// the left cell of the first edge and the right cell of the last edge are outside of the range
+		const bool l_updateLeft = (i > i_iBegin);
+		const bool l_updateRight = (i < i_iEnd);
+
+		for(int tj = 0; tj < nTilesY; tj++) {
+			//the edges between quiet tiles are skipped
+			if (!hasActiveVerticalEdges(i, tj))
+				continue;
+
+			const int ny_begin = std::max(tileBeginY(tj), i_jBegin);
+			const int ny_end = std::min(tileEndY(tj), i_jEnd);	// compiler might refuse to vectorize j-loop without this ...
+
+			// the edges are solved in batches of contiguous rows
+			for(int jBatch = ny_begin; jBatch < ny_end; jBatch += batchSize) {
+				const int l_n = std::min(batchSize, ny_end - jBatch);
+
+				float hNetUpLeft[batchSize], hNetUpRight[batchSize];
+				float huNetUpLeft[batchSize], huNetUpRight[batchSize];
+
+				float maxBatchSpeed = wavePropagationSolver.computeNetUpdates( l_n,
+                                               h[i-1] + jBatch, h[i] + jBatch,
+                                               hu[i-1] + jBatch, hu[i] + jBatch,
+                                               b[i-1] + jBatch, b[i] + jBatch,
+                                               hNetUpLeft, hNetUpRight,
+                                               huNetUpLeft, huNetUpRight );
+
+				// accumulate net updates to cell-wise net updates for h and hu
+#ifdef VECTORIZE // Vectorize the inner loop
+				#pragma simd
+#endif // VECTORIZE
+				for(int k = 0; k < l_n; k++) {
+					const int j = jBatch + k;
+					if (l_updateLeft) {
+						hNetUpdates[i-1][j]  += dx_inv * hNetUpLeft[k];
+						huNetUpdates[i-1][j] += dx_inv * huNetUpLeft[k];
+					}
+					if (l_updateRight) {
+						hNetUpdates[i][j]    += dx_inv * hNetUpRight[k];
+						huNetUpdates[i][j]   += dx_inv * huNetUpRight[k];
+					}
+				}
+
+				//update the maximum wave speed
+				maxWaveSpeed = std::max(maxWaveSpeed, maxBatchSpeed);
+			}
+		}
+	}
+
+	// compute the net-updates for the horizontal edges [jBegin, jEnd],
+	// the columns are independent, they are added after the ones of the vertical edges
+
+	for(int i = i_iBegin; i < i_iEnd; i++) {
+		for(int tj = 0; tj < nTilesY; tj++) {
+			//the edges between quiet tiles are skipped, the last tile row includes the top boundary edge
+			if (!hasActiveHorizontalEdges(i, tj))
+				continue;
+
+			const int ny_begin = std::max(tileBeginY(tj), i_jBegin);
+			const int ny_end = std::min((tj == nTilesY - 1) ? ny+2 : tileEndY(tj), i_jEnd + 1);	// compiler refused to vectorize j-loop without this ...
 
-	if(maxWaveSpeed > 0.00001) {
+			// the edges are solved in batches of contiguous rows
+			for(int jBatch = ny_begin; jBatch < ny_end; jBatch += batchSize) {
+				const int l_n = std::min(batchSize, ny_end - jBatch);
+
+				float hNetUpDow[batchSize], hNetUpUpw[batchSize];
+				float hvNetUpDow[batchSize], hvNetUpUpw[batchSize];
+
+				float maxBatchSpeed = wavePropagationSolver.computeNetUpdates( l_n,
+                                               h[i] + jBatch - 1, h[i] + jBatch,
+                                               hv[i] + jBatch - 1, hv[i] + jBatch,
+                                               b[i] + jBatch - 1, b[i] + jBatch,
+                                               hNetUpDow, hNetUpUpw,
+                                               hvNetUpDow, hvNetUpUpw );
+
+				// accumulate net updates to cell-wise net updates for h and hu,
+				// the cell above an edge is the cell below the next one, so this loop is not vectorized
+				for(int k = 0; k < l_n; k++) {
+					const int j = jBatch + k;
+					if (j > i_jBegin) {
+						hNetUpdates[i][j-1]  += dy_inv * hNetUpDow[k];
+						hvNetUpdates[i][j-1] += dy_inv * hvNetUpDow[k];
+					}
+					if (j < i_jEnd) {
+						hNetUpdates[i][j]    += dy_inv * hNetUpUpw[k];
+						hvNetUpdates[i][j]   += dy_inv * hvNetUpUpw[k];
+					}
+				}
+
+				//update the maximum wave speed
+				maxWaveSpeed = std::max(maxWaveSpeed, maxBatchSpeed);
+			}
+		}
+	}
+
+	return maxWaveSpeed;
+}
+
+/**
+ * Sets the member variable #maxTimestep for the maximum wave speed of all edges.
+ *
+ * @param i_maxWaveSpeed maximum (linearized) wave speed within the block
+ */
+void SWE_WaveAccumulationBlock::setMaxTimestep(float i_maxWaveSpeed) {
+	if(i_maxWaveSpeed > 0.00001) {
 		//TODO zeroTol
 
 		//compute the time step width
@@ -174,7 +359,7 @@ void SWE_WaveAccumulationBlock::computeNumericalFluxes() {
 		//(max. wave speed) * dt / dx < .5
 		// => dt = .5 * dx/(max wave speed)
 
-		maxTimestep = std::min( dx/maxWaveSpeed, dy/maxWaveSpeed );
+		maxTimestep = std::min( dx/i_maxWaveSpeed, dy/i_maxWaveSpeed );
 
 		// reduce maximum time step size by "safety factor"
 		maxTimestep *= (float) .4; //CFL-number = .5
@@ -183,6 +368,40 @@ void SWE_WaveAccumulationBlock::computeNumericalFluxes() {
 		maxTimestep = std::numeric_limits<float>::max();
 }
 
+/**
+ * Predicts the maximum time step of the next time step from the cells, before its edges are computed,
+ * and sets the member variable #maxTimestep to it.
+ *
+ * The wave speeds of the f-wave solver (WAVE_PROPAGATION_SOLVER 4) at an edge, Roe averages u +- sqrt(g*h)
+ * of its two cells, are bounded by the maximum velocity plus the maximum celerity of the cells,
+ * each taken separately. The ghost cells are included, so with this solver the minimum of the predictions
+ * of all blocks never exceeds the time step, which computeNumericalFluxes() computes for the edges.
+ * This is not shown for the augmented Riemann solver (WAVE_PROPAGATION_SOLVER 2), whose speeds depend on
+ * its middle states, e.g. u + 2*sqrt(g*h) at a front running onto a dry bed, so the prediction is no bound there.
+ *
+ * @return maximum time step for the cells and ghost cells of the block
+ */
+float SWE_WaveAccumulationBlock::predictMaxTimestep() {
+	float l_maxVelocity = (float) 0.;
+	float l_maxCelerity = (float) 0.;
+
+#ifdef LOOP_OPENMP
+	#pragma omp parallel for reduction(max: l_maxVelocity, l_maxCelerity)
+#endif // LOOP_OPENMP
+	for(int i = 0; i < nx+2; i++) {
+		for(int j = 0; j < ny+2; j++) {
+			const float hCell = h[i][j];
+			//updateUnknowns() zeroes the momentum of the cells below 0.1 and the negative depths
+			const float l_momentum = std::max(std::abs((float) hu[i][j]), std::abs((float) hv[i][j]));
+			l_maxVelocity = std::max(l_maxVelocity, (hCell > 0) ? l_momentum / hCell : (float) 0);
+			l_maxCelerity = std::max(l_maxCelerity, std::sqrt(g * std::max(hCell, (float) 0)));
+		}
+	}
+
+	setMaxTimestep(l_maxVelocity + l_maxCelerity);
+	return maxTimestep;
+}
+
 /**
  * Updates the unknowns with the already computed net-updates.
  *
@@ -195,36 +414,45 @@ void SWE_WaveAccumulationBlock::updateUnknowns(float dt) {
 	#pragma omp parallel for
 #endif // LOOP_OPENMP
 	for(int i = 1; i < nx+1; i++) {
+		for(int tj = 0; tj < nTilesY; tj++) {
+			//the cells of quiet tiles are skipped
+			if (!isTileActive(tileX(i), tj)) {
+				//at rest, the edges at the tile border may have added round-off to the quiet cells, which is neglected
+				if (waveFrontTracking) {
+					for(int j = tileBeginY(tj); j < tileEndY(tj); j++)
+						hNetUpdates[i][j] = huNetUpdates[i][j] = hvNetUpdates[i][j] = (float) 0;
+				}
+				continue;
+			}
 
 #ifdef VECTORIZE
-		// Tell the compiler that he can safely ignore all dependencies in this loop
-		#pragma ivdep
+			// Tell the compiler that he can safely ignore all dependencies in this loop
+			#pragma ivdep
 #endif // VECTORIZE
-		for(int j = 1; j < ny+1; j++) {
-
-			h[i][j]  -= dt * hNetUpdates[i][j];
-			hu[i][j] -= dt * huNetUpdates[i][j];
-			hv[i][j] -= dt * hvNetUpdates[i][j];
+			for(int j = tileBeginY(tj); j < tileEndY(tj); j++) {
 
-			hNetUpdates[i][j] = (float) 0;
-			huNetUpdates[i][j] = (float) 0;
-			hvNetUpdates[i][j] = (float) 0;
+				h[i][j]  -= dt * hNetUpdates[i][j];
+				hu[i][j] -= dt * huNetUpdates[i][j];
+				hv[i][j] -= dt * hvNetUpdates[i][j];
 
-			//TODO: proper dryTol
-			if (h[i][j] < 0.1)
-				hu[i][j] = hv[i][j] = 0.; //no water, no speed!
+				hNetUpdates[i][j] = (float) 0;
+				huNetUpdates[i][j] = (float) 0;
+				hvNetUpdates[i][j] = (float) 0;
 
-			if (h[i][j] < 0) {
+				//TODO: proper dryTol
+				const float hCell = h[i][j];
 #ifndef NDEBUG
 				// Only print this warning when debug is enabled
 				// Otherwise we cannot vectorize this loop
-				if (h[i][j] < -0.1) {
-					std::cerr << "Warning, negative height: (i,j)=(" << i << "," << j << ")=" << h[i][j] << std::endl;
+				if (hCell < -0.1) {
+					std::cerr << "Warning, negative height: (i,j)=(" << i << "," << j << ")=" << hCell << std::endl;
 					std::cerr << "         b: " << b[i][j] << std::endl;
 				}
 #endif // NDEBUG
-				//zero (small) negative depths
-				h[i][j] = (float) 0;
+				//no water, no speed! and zero (small) negative depths, with selects instead of branches
+				hu[i][j] = (hCell < 0.1f) ? (float) 0 : (float) hu[i][j];
+				hv[i][j] = (hCell < 0.1f) ? (float) 0 : (float) hv[i][j];
+				h[i][j] = (hCell < 0) ? (float) 0 : hCell;
 			}
 		}
 	}
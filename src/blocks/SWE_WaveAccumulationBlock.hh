@@ -31,6 +31,7 @@
 #define SWE_WAVEACCUMULATION_BLOCK_HH_
 
 #include "blocks/SWE_Block.hh"
+#include "blocks/SWE_BatchedSolver.hh"
 #ifdef DYNAMIC_DISPLACEMENTS
 #include "scenarios/Asagi.hpp"
 #endif
@@ -60,13 +61,16 @@
 class SWE_WaveAccumulationBlock: public SWE_Block {
 
 #if WAVE_PROPAGATION_SOLVER==2
-    //! Approximate Augmented Riemann solver
-    solver::AugRieFun<float> wavePropagationSolver;
+    //! Approximate Augmented Riemann solver, batched over the rows
+    SWE_BatchedSolver<solver::AugRieFun<float> > wavePropagationSolver;
 #elif WAVE_PROPAGATION_SOLVER==4
-    //! Vectorized FWave solver
-    solver::FWaveVec<float> wavePropagationSolver;
+    //! Vectorized FWave solver, batched over the rows
+    SWE_BatchedSolver<solver::FWaveVec<float> > wavePropagationSolver;
 #endif
 
+    //! Amount of edges, which are solved at once (see accumulateNetUpdates())
+    static const int batchSize = 64;
+
     //! net-updates for the heights of the cells (for accumulation)
     Float2D hNetUpdates;
 
@@ -76,18 +80,36 @@ class SWE_WaveAccumulationBlock: public SWE_Block {
     //! net-updates for the y-momentums of the cells (for accumulation)
     Float2D hvNetUpdates;
 
+    //! maximum wave speed of the edges computed by computeNumericalFluxesInterior()
+    float maxInteriorWaveSpeed;
+
+    //accumulates the net-updates of the cells [iBegin, iEnd) x [jBegin, jEnd), returns the maximum wave speed
+    float accumulateNetUpdates(int i_iBegin, int i_iEnd, int i_jBegin, int i_jEnd);
+
+    //sets the maximum time step for the maximum wave speed
+    void setMaxTimestep(float i_maxWaveSpeed);
+
   public:
     //constructor of a SWE_WaveAccumulationBlock.
-    SWE_WaveAccumulationBlock(int l_nx, int l_ny, float l_dx, float l_dy);
+    SWE_WaveAccumulationBlock(int l_nx, int l_ny, float l_dx, float l_dy, int l_ghostWidth = 1);
     //destructor of a SWE_WaveAccumulationBlock.
     virtual ~SWE_WaveAccumulationBlock() {}
 
     //computes the net-updates for the block
     void computeNumericalFluxes();
 
+    //computes the net-updates of the cells, which do not touch the ghost layers
+    void computeNumericalFluxesInterior();
+
+    //computes the net-updates of the cells next to the ghost layers and the maximum time step
+    void computeNumericalFluxesBoundary();
+
     //update the cells
     void updateUnknowns(float dt);
 
+    //predicts the maximum time step of the next time step from the cells, before its edges are computed (a bound for f-wave only)
+    float predictMaxTimestep();
+
     //updates the bathymetry with the current displacment values
 #ifdef DYNAMIC_DISPLACEMENTS
     bool updateBathymetryWithDynamicDisplacement(scenarios::Asagi &i_asagiScenario, float time);
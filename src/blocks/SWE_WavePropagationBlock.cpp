@@ -28,13 +28,14 @@
  */
 
 #include "SWE_WavePropagationBlock.hh"
+#include "tools/ThreadPool.hh"
 
 #include <cassert>
 #include <string>
 #include <limits>
 
 /**
- * Constructor of a SWE_WavePropagationBlock.
+ * Constructor of a SWE_WavePropagationBlockT.
  *
  * Allocates the variables for the simulation:
  *   unknowns h,hu,hv,b are defined on grid indices [0,..,nx+1]*[0,..,ny+1] (-> Abstract class SWE_Block)
@@ -77,17 +78,18 @@
  *   ***********
  * </pre>
  */
-SWE_WavePropagationBlock::SWE_WavePropagationBlock (int l_nx, int l_ny, float l_dx, float l_dy) :
+template <class RiemannSolver>
+SWE_WavePropagationBlockT<RiemannSolver>::SWE_WavePropagationBlockT (int l_nx, int l_ny, float l_dx, float l_dy) :
 	SWE_Block (l_nx, l_ny, l_dx, l_dy),
-	hNetUpdatesLeft (nx + 1, ny),
-	hNetUpdatesRight (nx + 1, ny),
-	huNetUpdatesLeft (nx + 1, ny),
-	huNetUpdatesRight (nx + 1, ny),
-
-	hNetUpdatesBelow (nx, ny + 1),
-	hNetUpdatesAbove (nx, ny + 1),
-	hvNetUpdatesBelow (nx, ny + 1),
-	hvNetUpdatesAbove (nx, ny + 1)
+	hNetUpdatesLeft (nx + 1, ny, true, true),
+	hNetUpdatesRight (nx + 1, ny, true, true),
+	huNetUpdatesLeft (nx + 1, ny, true, true),
+	huNetUpdatesRight (nx + 1, ny, true, true),
+
+	hNetUpdatesBelow (nx, ny + 1, true, true),
+	hNetUpdatesAbove (nx, ny + 1, true, true),
+	hvNetUpdatesBelow (nx, ny + 1, true, true),
+	hvNetUpdatesAbove (nx, ny + 1, true, true)
 {
 }
 
@@ -96,54 +98,31 @@ SWE_WavePropagationBlock::SWE_WavePropagationBlock (int l_nx, int l_ny, float l_
  * The member variable #maxTimestep will be updated with the 
  * maximum allowed time step size
  */
+template <class RiemannSolver>
 void
-SWE_WavePropagationBlock::computeNumericalFluxes ()
+SWE_WavePropagationBlockT<RiemannSolver>::computeNumericalFluxes ()
 {
 	//maximum (linearized) wave speed within one iteration
 	float maxWaveSpeed = (float) 0.;
 
-	/***************************************************************************************
-	 * compute the net-updates for the vertical edges
-	 **************************************************************************************/
-
-	for (int i = 1; i < nx+2; i++) {
-		for (int j=1; j < ny+1; ++j) {
-			float maxEdgeSpeed;
-
-			wavePropagationSolver.computeNetUpdates (
-				h[i - 1][j], h[i][j],
-				hu[i - 1][j], hu[i][j],
-				b[i - 1][j], b[i][j],
-				hNetUpdatesLeft[i - 1][j - 1], hNetUpdatesRight[i - 1][j - 1],
-				huNetUpdatesLeft[i - 1][j - 1], huNetUpdatesRight[i - 1][j - 1],
-				maxEdgeSpeed
-			);
-
-			//update the thread-local maximum wave speed
-			maxWaveSpeed = std::max(maxWaveSpeed, maxEdgeSpeed);
-		}
-	}
+	//the ghost layers are set, skip the tiles which stay quiet in this time step
+	updateTileActivity();
 
-	/***************************************************************************************
-	 * compute the net-updates for the horizontal edges
-	 **************************************************************************************/
-
-	for (int i=1; i < nx + 1; i++) {
-		for (int j=1; j < ny + 2; j++) {
-			float maxEdgeSpeed;
-
-			wavePropagationSolver.computeNetUpdates (
-				h[i][j - 1], h[i][j],
-				hv[i][j - 1], hv[i][j],
-				b[i][j - 1], b[i][j],
-				hNetUpdatesBelow[i - 1][j - 1], hNetUpdatesAbove[i - 1][j - 1],
-				hvNetUpdatesBelow[i - 1][j - 1], hvNetUpdatesAbove[i - 1][j - 1],
-				maxEdgeSpeed
-			);
-
-			//update the maximum wave speed
-			maxWaveSpeed = std::max (maxWaveSpeed, maxEdgeSpeed);
-		}
+	if (threadPool != NULL) {
+		//the tile columns are balanced among the threads of the pool, the last one includes the right boundary edges
+		auto l_tileColumn = [this](int ti, int) {
+			const int iEnd = std::min((ti + 1) * tileSize + 1, nx + 1);
+			float l_maxWaveSpeed = (ti == nTilesX - 1) ? computeNetUpdatesVerticalEdges(nx + 1) : (float) 0.;
+			for (int i = ti * tileSize + 1; i < iEnd; i++)
+				l_maxWaveSpeed = std::max(l_maxWaveSpeed, std::max(computeNetUpdatesVerticalEdges(i), computeNetUpdatesHorizontalEdges(i)));
+			return l_maxWaveSpeed;
+		};
+		maxWaveSpeed = threadPool->reduceMax(nTilesX, l_tileColumn);
+	} else {
+		for (int i = 1; i < nx+2; i++)
+			maxWaveSpeed = std::max(maxWaveSpeed, computeNetUpdatesVerticalEdges(i));
+		for (int i = 1; i < nx+1; i++)
+			maxWaveSpeed = std::max(maxWaveSpeed, computeNetUpdatesHorizontalEdges(i));
 	}
 
 	if (maxWaveSpeed > 0.00001) {
@@ -163,35 +142,136 @@ SWE_WavePropagationBlock::computeNumericalFluxes ()
 	}
 }
 
+/**
+ * Computes the net-updates of the vertical edges left of column i.
+ *
+ * @param i column of the cells right of the edges
+ * @return maximum wave speed of the edges
+ */
+template <class RiemannSolver>
+float
+SWE_WavePropagationBlockT<RiemannSolver>::computeNetUpdatesVerticalEdges (int i)
+{
+	float maxWaveSpeed = (float) 0.;
+	for (int tj = 0; tj < nTilesY; tj++) {
+		//the edges between quiet tiles are skipped
+		if (!hasActiveVerticalEdges(i, tj))
+			continue;
+
+		//the edges of the tile are one contiguous segment of the column
+		const int j = tileBeginY(tj);
+		float maxSegmentSpeed = wavePropagationSolver.computeNetUpdates (
+			tileEndY(tj) - j,
+			h[i - 1] + j, h[i] + j,
+			hu[i - 1] + j, hu[i] + j,
+			b[i - 1] + j, b[i] + j,
+			hNetUpdatesLeft[i - 1] + j - 1, hNetUpdatesRight[i - 1] + j - 1,
+			huNetUpdatesLeft[i - 1] + j - 1, huNetUpdatesRight[i - 1] + j - 1
+		);
+
+		//update the maximum wave speed
+		maxWaveSpeed = std::max(maxWaveSpeed, maxSegmentSpeed);
+	}
+	return maxWaveSpeed;
+}
+
+/**
+ * Computes the net-updates of the horizontal edges of column i.
+ *
+ * @param i column of the edges
+ * @return maximum wave speed of the edges
+ */
+template <class RiemannSolver>
+float
+SWE_WavePropagationBlockT<RiemannSolver>::computeNetUpdatesHorizontalEdges (int i)
+{
+	float maxWaveSpeed = (float) 0.;
+	for (int tj = 0; tj < nTilesY; tj++) {
+		//the edges between quiet tiles are skipped, the last tile row includes the top boundary edge
+		if (!hasActiveHorizontalEdges(i, tj))
+			continue;
+
+		const int j = tileBeginY(tj);
+		const int jEnd = (tj == nTilesY - 1) ? ny + 2 : tileEndY(tj);
+		float maxSegmentSpeed = wavePropagationSolver.computeNetUpdates (
+			jEnd - j,
+			h[i] + j - 1, h[i] + j,
+			hv[i] + j - 1, hv[i] + j,
+			b[i] + j - 1, b[i] + j,
+			hNetUpdatesBelow[i - 1] + j - 1, hNetUpdatesAbove[i - 1] + j - 1,
+			hvNetUpdatesBelow[i - 1] + j - 1, hvNetUpdatesAbove[i - 1] + j - 1
+		);
+
+		//update the maximum wave speed
+		maxWaveSpeed = std::max (maxWaveSpeed, maxSegmentSpeed);
+	}
+	return maxWaveSpeed;
+}
+
 /**
  * Updates the unknowns with the already computed net-updates.
  *
  * @param dt time step width used in the update.
  */
+template <class RiemannSolver>
+void
+SWE_WavePropagationBlockT<RiemannSolver>::updateUnknowns (float dt)
+{
+	if (threadPool != NULL) {
+		//the tile columns are balanced among the threads of the pool
+		auto l_tileColumn = [this, dt](int ti, int) {
+			const int iEnd = std::min((ti + 1) * tileSize + 1, nx + 1);
+			for (int i = ti * tileSize + 1; i < iEnd; i++)
+				updateUnknownsRow(dt, i);
+		};
+		threadPool->run(nTilesX, l_tileColumn);
+	} else {
+		for (int i = 1; i < nx+1; i++)
+			updateUnknownsRow(dt, i);
+	}
+}
+
+/**
+ * Updates the unknowns of the cells (i, *) with the already computed net-updates.
+ *
+ * @param dt time step width used in the update.
+ * @param i column of the cells
+ */
+template <class RiemannSolver>
 void
-SWE_WavePropagationBlock::updateUnknowns (float dt)
+SWE_WavePropagationBlockT<RiemannSolver>::updateUnknownsRow (float dt, int i)
 {
 	//update cell averages with the net-updates
-	for (int i = 1; i < nx+1; i++) {
-		for (int j = 1; j < ny + 1; j++) {
+	for (int tj = 0; tj < nTilesY; tj++) {
+		//the cells of quiet tiles are skipped
+		if (!isTileActive(tileX(i), tj))
+			continue;
+
+		for (int j = tileBeginY(tj); j < tileEndY(tj); j++) {
 			h[i][j] -= dt / dx * (hNetUpdatesRight[i - 1][j - 1] + hNetUpdatesLeft[i][j - 1]) + dt / dy * (hNetUpdatesAbove[i - 1][j - 1] + hNetUpdatesBelow[i - 1][j]);
 			hu[i][j] -= dt / dx * (huNetUpdatesRight[i - 1][j - 1] + huNetUpdatesLeft[i][j - 1]);
 			hv[i][j] -= dt / dy * (hvNetUpdatesAbove[i - 1][j - 1] + hvNetUpdatesBelow[i - 1][j]);
 
-			if (h[i][j] < 0) {
-				//TODO: dryTol
+			//TODO: dryTol
+			const float hCell = h[i][j];
 #ifndef NDEBUG
-				// Only print this warning when debug is enabled
-				// Otherwise we cannot vectorize this loop
-				if (h[i][j] < -0.1) {
-					std::cerr << "Warning, negative height: (i,j)=(" << i << "," << j << ")=" << h[i][j] << std::endl;
-					std::cerr << "         b: " << b[i][j] << std::endl;
-				}
+			// Only print this warning when debug is enabled
+			// Otherwise we cannot vectorize this loop
+			if (hCell < -0.1) {
+				std::cerr << "Warning, negative height: (i,j)=(" << i << "," << j << ")=" << hCell << std::endl;
+				std::cerr << "         b: " << b[i][j] << std::endl;
+			}
 #endif // NDEBUG
-				//zero (small) negative depths
-				h[i][j] = hu[i][j] = hv[i][j] = 0.;
-			} else if (h[i][j] < 0.1)
-				hu[i][j] = hv[i][j] = 0.; //no water, no speed!
+			//zero (small) negative depths, no water, no speed!
+			//selects instead of branches, to keep the loop vectorizable
+			h[i][j] = (hCell < 0) ? 0.f : hCell;
+			hu[i][j] = (hCell < 0.1f) ? 0.f : (float) hu[i][j];
+			hv[i][j] = (hCell < 0.1f) ? 0.f : (float) hv[i][j];
 		}
 	}
 }
+
+// The Riemann solvers, which can be selected at runtime (see SWE_BlockFactory.cpp)
+template class SWE_WavePropagationBlockT<solver::Hybrid<float> >;
+template class SWE_WavePropagationBlockT<SWE_FWaveBranchFree>;
+template class SWE_WavePropagationBlockT<solver::AugRie<float> >;
@@ -31,6 +31,8 @@
 #define SWEWAVEPROPAGATIONBLOCK_HH_
 
 #include "blocks/SWE_Block.hh"
+#include "blocks/SWE_BatchedSolver.hh"
+#include "blocks/SWE_FWaveBranchFree.hh"
 #include "tools/help.hh"
 
 #include <string>
@@ -38,42 +40,27 @@
 #define SUPPRESS_SOLVER_DEBUG_OUTPUT
 // #define SOLVER_DEBUG_OUTPUT_ONLYNONZERO
 
-//which wave propagation solver should be used
-//  0: Hybrid
-//  1: f-Wave
-//  2: Approximate Augmented Riemann solver
-#if WAVE_PROPAGATION_SOLVER==0
 #include "../submodules/solvers/src/solver/Hybrid.hpp"
-#elif WAVE_PROPAGATION_SOLVER==1
 #include "../submodules/solvers/src/solver/FWave.hpp"
-#elif WAVE_PROPAGATION_SOLVER==2
 #include "../submodules/solvers/src/solver/AugRie.hpp"
-#else
-#warning SWE_WavePropagationBlock should only be used with Riemann solvers 0, 1, and 2 (FWave, AugRie or Hybrid)
-#endif
 
 /**
- * SWE_WavePropagationBlock is an implementation of the SWE_Block abstract class.
- * It uses a wave propagation solver which is defined with the pre-compiler flag WAVE_PROPAGATION_SOLVER (see above).
+ * SWE_WavePropagationBlockT is an implementation of the SWE_Block abstract class.
+ * It uses the wave propagation solver given as template parameter, so the solver is
+ * inlined into the loops over the edges.
  *
  * Possible wave propagation solvers are:
  *  F-Wave, Apprximate Augmented Riemann, Hybrid (f-wave + augmented).
  *  (details can be found in the corresponding source files)
+ * The block is instantiated for all three of them (see SWE_WavePropagationBlock.cpp),
+ * the instances are selected at runtime with blocks::createBlock().
  */
-class SWE_WavePropagationBlock: public SWE_Block {
+template <class RiemannSolver>
+class SWE_WavePropagationBlockT: public SWE_Block {
 
 private:
-    //specify the wave propagation solver
-#if WAVE_PROPAGATION_SOLVER==0
-    //! Hybrid solver (f-wave + augmented)
-    solver::Hybrid<float> wavePropagationSolver;
-#elif WAVE_PROPAGATION_SOLVER==1
-    //! F-wave Riemann solver
-    solver::FWave<float> wavePropagationSolver;
-#elif WAVE_PROPAGATION_SOLVER==2
-    //! Approximate Augmented Riemann solver
-    solver::AugRie<float> wavePropagationSolver;
-#endif
+    //! the wave propagation solver, batched over the rows
+    SWE_BatchedSolver<RiemannSolver> wavePropagationSolver;
 
     //! net-updates for the heights of the cells on the left sides of the vertical edges.
     Float2D hNetUpdatesLeft;
@@ -95,9 +82,13 @@ private:
     //! net-updates for the y-momentums of the cells above the horizontal edges.
     Float2D hvNetUpdatesAbove;
 
+    //computes the net-updates of the vertical edges left of column i and of the horizontal edges of column i
+    float computeNetUpdatesVerticalEdges(int i);
+    float computeNetUpdatesHorizontalEdges(int i);
+
   public:
-    //constructor of a SWE_WavePropagationBlock.
-    SWE_WavePropagationBlock(int l_nx, int l_ny,
+    //constructor of a SWE_WavePropagationBlockT.
+    SWE_WavePropagationBlockT(int l_nx, int l_ny,
     					float l_dx, float l_dy);
 
     //computes the net-updates for the block
@@ -108,11 +99,26 @@ private:
     void updateUnknownsRow(float dt, int i);
 
     /**
-     * Destructor of a SWE_WavePropagationBlock.
+     * Destructor of a SWE_WavePropagationBlockT.
      *
      * In the case of a hybrid solver (NDEBUG not defined) information about the used solvers will be printed.
      */
-    virtual ~SWE_WavePropagationBlock() {}
+    virtual ~SWE_WavePropagationBlockT() {}
 };
 
+//which wave propagation solver is used by SWE_WavePropagationBlock,
+//the block of the examples with a build time choice of the solver
+//  0: Hybrid
+//  1: f-Wave (branch-free, see SWE_FWaveBranchFree.hh)
+//  2: Approximate Augmented Riemann solver
+#if WAVE_PROPAGATION_SOLVER==0
+typedef SWE_WavePropagationBlockT<solver::Hybrid<float> > SWE_WavePropagationBlock;
+#elif WAVE_PROPAGATION_SOLVER==1
+typedef SWE_WavePropagationBlockT<SWE_FWaveBranchFree> SWE_WavePropagationBlock;
+#elif WAVE_PROPAGATION_SOLVER==2
+typedef SWE_WavePropagationBlockT<solver::AugRie<float> > SWE_WavePropagationBlock;
+#else
+#warning SWE_WavePropagationBlock should only be used with Riemann solvers 0, 1, and 2 (FWave, AugRie or Hybrid)
+#endif
+
 #endif /* SWEWAVEPROPAGATIONBLOCK_HH_ */
@@ -86,15 +86,18 @@
  */
 SWE_WavePropagationBlockSIMD::SWE_WavePropagationBlockSIMD (int l_nx, int l_ny, float l_dx, float l_dy) :
 	SWE_Block (l_nx, l_ny, l_dx, l_dy),
-	hNetUpdatesLeft (nx + 1, ny),
-	hNetUpdatesRight (nx + 1, ny),
-	huNetUpdatesLeft (nx + 1, ny),
-	huNetUpdatesRight (nx + 1, ny),
-
-	hNetUpdatesBelow (nx, ny + 1),
-	hNetUpdatesAbove (nx, ny + 1),
-	hvNetUpdatesBelow (nx, ny + 1),
-	hvNetUpdatesAbove (nx, ny + 1)
+#if WAVE_PROPAGATION_SOLVER==1
+	fWaveNetUpdates (simd::getFWaveKernel().netUpdates),
+#endif
+	hNetUpdatesLeft (nx + 1, ny, true, true),
+	hNetUpdatesRight (nx + 1, ny, true, true),
+	huNetUpdatesLeft (nx + 1, ny, true, true),
+	huNetUpdatesRight (nx + 1, ny, true, true),
+
+	hNetUpdatesBelow (nx, ny + 1, true, true),
+	hNetUpdatesAbove (nx, ny + 1, true, true),
+	hvNetUpdatesBelow (nx, ny + 1, true, true),
+	hvNetUpdatesAbove (nx, ny + 1, true, true)
 #ifdef COUNTFLOPS
 	, // don't forget the comma, to extend the list above
 	flops(0),
@@ -156,6 +159,26 @@ SWE_WavePropagationBlockSIMD::computeNumericalFluxes ()
 #endif // LOOP_OPENMP
 		for (int i = 1; i < nx + 2; i++) {
 			int j = 1;
+#if WAVE_PROPAGATION_SOLVER==1
+			{
+				const float maxEdgeSpeed = fWaveNetUpdates (ny,
+					&h[i - 1][1], &h[i][1],
+					&hu[i - 1][1], &hu[i][1],
+					&b[i - 1][1], &b[i][1],
+					&hNetUpdatesLeft[i - 1][0], &hNetUpdatesRight[i - 1][0],
+					&huNetUpdatesLeft[i - 1][0], &huNetUpdatesRight[i - 1][0]
+				);
+				j = end_ny_1_1;
+
+#ifdef LOOP_OPENMP
+				//update the thread-local maximum wave speed
+				l_maxWaveSpeed = std::max (l_maxWaveSpeed, maxEdgeSpeed);
+#else // LOOP_OPENMP
+				//update the maximum wave speed
+				maxWaveSpeed = std::max (maxWaveSpeed, maxEdgeSpeed);
+#endif // LOOP_OPENMP
+			}
+#endif /* WAVE_PROPAGATION_SOLVER==1 */
 
 #if  WAVE_PROPAGATION_SOLVER==5 and (not defined VECTOR_NOVEC)
 			for (; j < end_ny_V_1; j += VECTOR_LENGTH) {
@@ -217,6 +240,26 @@ SWE_WavePropagationBlockSIMD::computeNumericalFluxes ()
 #endif // LOOP_OPENMP
 		for (int i = 1; i < nx + 1; i++) {
 			int j = 1;
+#if WAVE_PROPAGATION_SOLVER==1
+			{
+				const float maxEdgeSpeed = fWaveNetUpdates (ny + 1,
+					&h[i][0], &h[i][1],
+					&hv[i][0], &hv[i][1],
+					&b[i][0], &b[i][1],
+					&hNetUpdatesBelow[i - 1][0], &hNetUpdatesAbove[i - 1][0],
+					&hvNetUpdatesBelow[i - 1][0], &hvNetUpdatesAbove[i - 1][0]
+				);
+				j = end_ny_1_2;
+
+#ifdef LOOP_OPENMP
+				//update the thread-local maximum wave speed
+				l_maxWaveSpeed = std::max (l_maxWaveSpeed, maxEdgeSpeed);
+#else // LOOP_OPENMP
+				//update the maximum wave speed
+				maxWaveSpeed = std::max (maxWaveSpeed, maxEdgeSpeed);
+#endif // LOOP_OPENMP
+			}
+#endif /* WAVE_PROPAGATION_SOLVER==1 */
 #if  WAVE_PROPAGATION_SOLVER==5 and (not defined VECTOR_NOVEC)
 			for (; j < end_ny_V_2; j += VECTOR_LENGTH) {
 				float maxEdgeSpeed;
@@ -44,6 +44,7 @@
 //  3: Approximate Augmented Riemann solver which uses the underlying Fortran routines of GeoClaw directly.
 #if WAVE_PROPAGATION_SOLVER==1
 #include "solvers/FWave.hpp"
+#include "blocks/SWE_FWaveSIMD.hh"
 #elif WAVE_PROPAGATION_SOLVER==2
 #include "solvers/AugRie.hpp"
 #elif WAVE_PROPAGATION_SOLVER==3
@@ -90,6 +91,11 @@ class SWE_WavePropagationBlockSIMD : public SWE_Block {
 #endif
 #endif
 
+#if WAVE_PROPAGATION_SOLVER==1
+	//! f-wave kernel of the widest instruction set supported by the CPU, solves whole columns of edges
+	simd::FWaveNetUpdates fWaveNetUpdates;
+#endif
+
 	//! net-updates for the heights of the cells on the left sides of the vertical edges.
 	Float2D hNetUpdatesLeft;
 	//! net-updates for the heights of the cells on the right sides of the vertical edges.
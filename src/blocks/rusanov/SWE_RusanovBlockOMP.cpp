@@ -0,0 +1,220 @@
+/**
+ * @file SWE_RusanovBlockOMP.cpp
+ * @brief Implements the functionality defined in SWE_RusanovBlockOMP.hh
+ */
+
+#include "SWE_RusanovBlockOMP.hh"
+#include "tools/FastMath.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace
+{
+
+/**
+ * @brief Rusanov / local Lax-Friedrich flux of an edge, see SWE_RusanovBlock::computeFlux()
+ */
+inline float computeFlux(float fLow, float fHigh, float xiLow, float xiHigh, float llf)
+{
+	return 0.5f*(fLow+fHigh) - 0.5f*llf*(xiHigh-xiLow);
+}
+
+}
+
+SWE_RusanovBlockOMP::SWE_RusanovBlockOMP (int l_nx, int l_ny, float l_dx, float l_dy, int numthreads) :
+	SWE_Block (l_nx, l_ny, l_dx, l_dy),
+	hBalance (nx + 2, ny + 2, true, true),
+	huBalance (nx + 2, ny + 2, true, true),
+	hvBalance (nx + 2, ny + 2, true, true),
+	hFluxes (3 * numthreads, ny + 2, true, true),
+	huFluxes (3 * numthreads, ny + 2, true, true),
+	hvFluxes (3 * numthreads, ny + 2, true, true),
+	numThreads(numthreads)
+{
+	workPerThread_horizontal = (nx + numThreads - 1) / numThreads;
+}
+
+void SWE_RusanovBlockOMP::computeNumericalFluxes()
+{
+	float maxWaveSpeed = (float) 0.;
+#ifdef FAST_MATH
+	//reciprocals of the cell size, the balance is multiplied instead of divided
+	const float dx_inv = 1.f/dx;
+	const float dy_inv = 1.f/dy;
+#endif
+	//every thread owns a strip of columns, only the first vertical edge of a strip is computed twice
+	#pragma omp parallel for reduction(max: maxWaveSpeed)
+	for (int t = 0; t < numThreads; t++)
+	{
+		const int iBegin = (t*workPerThread_horizontal) + 1;
+		const int iEnd = std::min(((t+1)*workPerThread_horizontal) + 1, nx + 1);
+		if (iBegin >= iEnd)
+			continue;
+		float* hFluxLeft = hFluxes[3*t];
+		float* huFluxLeft = huFluxes[3*t];
+		float* hvFluxLeft = hvFluxes[3*t];
+		float* hFluxRight = hFluxes[3*t + 1];
+		float* huFluxRight = huFluxes[3*t + 1];
+		float* hvFluxRight = hvFluxes[3*t + 1];
+		float* hFluxAbove = hFluxes[3*t + 2];
+		float* huFluxAbove = huFluxes[3*t + 2];
+		float* hvFluxAbove = hvFluxes[3*t + 2];
+
+		maxWaveSpeed = std::max(maxWaveSpeed, computeFluxesHorizontal(iBegin - 1, hFluxLeft, huFluxLeft, hvFluxLeft));
+		for (int i = iBegin; i < iEnd; i++)
+		{
+			maxWaveSpeed = std::max(maxWaveSpeed, computeFluxesHorizontal(i, hFluxRight, huFluxRight, hvFluxRight));
+			maxWaveSpeed = std::max(maxWaveSpeed, computeFluxesVertical(i, hFluxAbove, huFluxAbove, hvFluxAbove));
+
+			//flux differences and bathymetry source terms (depend on h) in one pass
+			#pragma omp simd
+			for (int j = 1; j < ny + 1; j++)
+			{
+				const float hCell = h[i][j];
+				const float bCell = b[i][j];
+				float bx = 0.f, by = 0.f;
+				if (hCell > 0)
+				{
+					if (h[i+1][j] == 0 && hCell + bCell < b[i+1][j])
+						bx = - g * 0.25f*h[i-1][j]*b[i-1][j];
+					else if (h[i-1][j] == 0 && hCell + bCell < b[i-1][j])
+						bx = g * 0.25f*h[i+1][j]*b[i+1][j];
+					else
+						bx = g * 0.5f*(h[i+1][j]+h[i-1][j]) * 0.5f*(b[i+1][j] - b[i-1][j]);
+
+					if (h[i][j+1] == 0 && hCell + bCell < b[i][j+1])
+						by = g * 0.25f*h[i][j-1]*b[i][j-1];
+					else if (h[i][j-1] == 0 && hCell + bCell < b[i][j-1])
+						by = g * 0.25f*h[i][j+1]*b[i][j+1];
+					else
+						by = g * 0.5f*(h[i][j+1]+h[i][j-1]) * 0.5f*(b[i][j+1] - b[i][j-1]);
+				}
+#ifdef FAST_MATH
+				hBalance[i][j] = (hFluxRight[j] - hFluxLeft[j])*dx_inv + (hFluxAbove[j] - hFluxAbove[j-1])*dy_inv;
+				huBalance[i][j] = (huFluxRight[j] - huFluxLeft[j] + bx)*dx_inv + (huFluxAbove[j] - huFluxAbove[j-1])*dy_inv;
+				hvBalance[i][j] = (hvFluxRight[j] - hvFluxLeft[j])*dx_inv + (hvFluxAbove[j] - hvFluxAbove[j-1] + by)*dy_inv;
+#else
+				hBalance[i][j] = (hFluxRight[j] - hFluxLeft[j])/dx + (hFluxAbove[j] - hFluxAbove[j-1])/dy;
+				huBalance[i][j] = (huFluxRight[j] - huFluxLeft[j])/dx + (huFluxAbove[j] - huFluxAbove[j-1])/dy + bx/dx;
+				hvBalance[i][j] = (hvFluxRight[j] - hvFluxLeft[j])/dx + (hvFluxAbove[j] - hvFluxAbove[j-1])/dy + by/dy;
+#endif
+			}
+
+			//the right edges of this column are the left edges of the next one
+			std::swap(hFluxLeft, hFluxRight);
+			std::swap(huFluxLeft, huFluxRight);
+			std::swap(hvFluxLeft, hvFluxRight);
+		}
+	}
+
+	if (maxWaveSpeed > 0.00001)
+	{
+		//CFL-Condition with the more pessimistic choice of SWE_RusanovBlock
+		maxTimestep = std::min(dx/maxWaveSpeed, dy/maxWaveSpeed);
+		maxTimestep *= (float) .4 * (float) .5;
+	}
+	else
+	{
+		//might happen in dry cells
+		maxTimestep = std::numeric_limits<float>::max();
+	}
+}
+
+float SWE_RusanovBlockOMP::computeFluxesHorizontal(int i, float* o_hFlux, float* o_huFlux, float* o_hvFlux)
+{
+	float maxWaveSpeed = (float) 0.;
+	#pragma omp simd reduction(max: maxWaveSpeed)
+	for (int j = 1; j < ny + 1; j++)
+	{
+		const float hLow = h[i][j], hHigh = h[i+1][j];
+		const float huLow = hu[i][j], huHigh = hu[i+1][j];
+		const float hvLow = hv[i][j], hvHigh = hv[i+1][j];
+
+#ifdef FAST_MATH
+		//1/h = g * rsqrt(gh)^2 and sqrt(gh) = gh * rsqrt(gh), see FastMath.hh
+		const float ghLow = g*hLow, ghHigh = g*hHigh;
+		const float rsqrtGhLow = fastmath::rsqrt(ghLow), rsqrtGhHigh = fastmath::rsqrt(ghHigh);
+		const float uLow = (hLow > 0) ? huLow*g*rsqrtGhLow*rsqrtGhLow : 0.f;
+		const float uHigh = (hHigh > 0) ? huHigh*g*rsqrtGhHigh*rsqrtGhHigh : 0.f;
+		//local signal velocity
+		const float svLow = (hLow > 0) ? std::abs(uLow) + ghLow*rsqrtGhLow : 0.f;
+		const float svHigh = (hHigh > 0) ? std::abs(uHigh) + ghHigh*rsqrtGhHigh : 0.f;
+#else
+		const float uLow = (hLow > 0) ? huLow/hLow : 0.f;
+		const float uHigh = (hHigh > 0) ? huHigh/hHigh : 0.f;
+		//local signal velocity
+		const float svLow = (hLow > 0) ? std::abs(uLow) + std::sqrt(g*hLow) : 0.f;
+		const float svHigh = (hHigh > 0) ? std::abs(uHigh) + std::sqrt(g*hHigh) : 0.f;
+#endif
+		const float llf = std::max(svLow, svHigh);
+		const float upwind = std::max(std::abs(uLow), std::abs(uHigh));
+
+		o_hFlux[j] = computeFlux(huLow, huHigh, hLow, hHigh, upwind);
+		o_huFlux[j] = computeFlux(huLow*uLow + 0.5f*g*hLow*hLow, huHigh*uHigh + 0.5f*g*hHigh*hHigh, huLow, huHigh, llf);
+		o_hvFlux[j] = computeFlux(uLow*hvLow, uHigh*hvHigh, hvLow, hvHigh, llf);
+		maxWaveSpeed = std::max(maxWaveSpeed, llf);
+	}
+	return maxWaveSpeed;
+}
+
+float SWE_RusanovBlockOMP::computeFluxesVertical(int i, float* o_hFlux, float* o_huFlux, float* o_hvFlux)
+{
+	float maxWaveSpeed = (float) 0.;
+	#pragma omp simd reduction(max: maxWaveSpeed)
+	for (int j = 0; j < ny + 1; j++)
+	{
+		const float hLow = h[i][j], hHigh = h[i][j+1];
+		const float huLow = hu[i][j], huHigh = hu[i][j+1];
+		const float hvLow = hv[i][j], hvHigh = hv[i][j+1];
+
+#ifdef FAST_MATH
+		//1/h = g * rsqrt(gh)^2 and sqrt(gh) = gh * rsqrt(gh), see FastMath.hh
+		const float ghLow = g*hLow, ghHigh = g*hHigh;
+		const float rsqrtGhLow = fastmath::rsqrt(ghLow), rsqrtGhHigh = fastmath::rsqrt(ghHigh);
+		const float vLow = (hLow > 0) ? hvLow*g*rsqrtGhLow*rsqrtGhLow : 0.f;
+		const float vHigh = (hHigh > 0) ? hvHigh*g*rsqrtGhHigh*rsqrtGhHigh : 0.f;
+		//local signal velocity
+		const float svLow = (hLow > 0) ? std::abs(vLow) + ghLow*rsqrtGhLow : 0.f;
+		const float svHigh = (hHigh > 0) ? std::abs(vHigh) + ghHigh*rsqrtGhHigh : 0.f;
+#else
+		const float vLow = (hLow > 0) ? hvLow/hLow : 0.f;
+		const float vHigh = (hHigh > 0) ? hvHigh/hHigh : 0.f;
+		//local signal velocity
+		const float svLow = (hLow > 0) ? std::abs(vLow) + std::sqrt(g*hLow) : 0.f;
+		const float svHigh = (hHigh > 0) ? std::abs(vHigh) + std::sqrt(g*hHigh) : 0.f;
+#endif
+		const float llf = std::max(svLow, svHigh);
+		const float upwind = std::max(std::abs(vLow), std::abs(vHigh));
+
+		o_hFlux[j] = computeFlux(hvLow, hvHigh, hLow, hHigh, upwind);
+		o_huFlux[j] = computeFlux(huLow*vLow, huHigh*vHigh, huLow, huHigh, llf);
+		o_hvFlux[j] = computeFlux(hvLow*vLow + 0.5f*g*hLow*hLow, hvHigh*vHigh + 0.5f*g*hHigh*hHigh, hvLow, hvHigh, llf);
+		maxWaveSpeed = std::max(maxWaveSpeed, llf);
+	}
+	return maxWaveSpeed;
+}
+
+void SWE_RusanovBlockOMP::updateUnknowns(float dt)
+{
+	#pragma omp parallel for
+	for (int i = 1; i < nx + 1; i++)
+	{
+		#pragma omp simd
+		for (int j = 1; j < ny + 1; j++)
+		{
+			float hCell = h[i][j] - dt * hBalance[i][j];
+			float huCell = hu[i][j] - dt * huBalance[i][j];
+			float hvCell = hv[i][j] - dt * hvBalance[i][j];
+			if (!(hCell > 0))
+			{
+				// set all unknowns to 0, if h turns out non-positive
+				hCell = huCell = hvCell = 0.f;
+			}
+			h[i][j] = hCell;
+			hu[i][j] = huCell;
+			hv[i][j] = hvCell;
+		}
+	}
+}
@@ -0,0 +1,101 @@
+/**
+ * @file SWE_RusanovBlockOMP.hh
+ * @brief Defines a parallel and vectorized CPU implementation of the Rusanov block
+ */
+
+#ifndef _SWE_RUSANOV_BLOCK_OMP_HH
+#define _SWE_RUSANOV_BLOCK_OMP_HH
+
+#include "blocks/SWE_Block.hh"
+#include "tools/help.hh"
+
+/**
+ * @brief Rusanov flux (aka local Lax-Friedrich) with the bathymetry source terms of SWE_RusanovBlock,
+ *  parallelized with OpenMP and vectorized along the columns.
+ *
+ * Every thread owns a strip of columns. For each column, the fluxes of its vertical and horizontal
+ * edges are computed into buffers of the thread, then one loop over the rows adds the flux differences
+ * and the source terms to the balance of the cells. The loops over the rows are free of dependencies,
+ * so they are vectorized. The first vertical edge of a strip is computed by both adjacent threads.
+ */
+class SWE_RusanovBlockOMP : public SWE_Block
+{
+
+  private:
+
+    //! Balance of the heights: flux differences and source terms, divided by the cell size
+    Float2D hBalance;
+    //! Balance of the x-momentums
+    Float2D huBalance;
+    //! Balance of the y-momentums
+    Float2D hvBalance;
+
+    //! Fluxes of the heights of one column of edges, three per thread (left and right vertical edges, horizontal edges)
+    Float2D hFluxes;
+    //! Fluxes of the x-momentums of one column of edges, three per thread
+    Float2D huFluxes;
+    //! Fluxes of the y-momentums of one column of edges, three per thread
+    Float2D hvFluxes;
+
+    //! Amount of threads used
+    int numThreads;
+    //! Amount of columns per thread
+    int workPerThread_horizontal;
+
+    /**
+     * @brief Computes the fluxes of the vertical edges between column i and i+1
+     *
+     * @param i Column of the cells left of the edges
+     * @param o_hFlux Fluxes of the heights, indexed by row
+     * @param o_huFlux Fluxes of the x-momentums, indexed by row
+     * @param o_hvFlux Fluxes of the y-momentums, indexed by row
+     * @return Maximum local signal velocity of the edges
+     */
+    float computeFluxesHorizontal(int i, float* o_hFlux, float* o_huFlux, float* o_hvFlux);
+
+    /**
+     * @brief Computes the fluxes of the horizontal edges of column i, including the boundary edges
+     *
+     * @param i Column
+     * @param o_hFlux Fluxes of the heights, index j is the edge between row j and j+1
+     * @param o_huFlux Fluxes of the x-momentums
+     * @param o_hvFlux Fluxes of the y-momentums
+     * @return Maximum local signal velocity of the edges
+     */
+    float computeFluxesVertical(int i, float* o_hFlux, float* o_huFlux, float* o_hvFlux);
+
+  public:
+
+    /**
+     * @brief Constructor
+     *
+     * @param l_nx Amount of cells in x dimension
+     * @param l_ny Amount of cells in y dimension
+     * @param l_dx Width of a cell
+     * @param l_dy Height of a cell
+     * @param numthreads The amount of parallel threads to use
+     */
+    SWE_RusanovBlockOMP(int l_nx, int l_ny, float l_dx, float l_dy, int numthreads);
+
+    /**
+     * @brief Computes the fluxes and the source terms, and the balance of the cells
+     *
+     * The member variable maxTimestep will be updated with the maximum allowed time step size
+     */
+    void computeNumericalFluxes();
+
+    /**
+     * @brief Updates the cells with their balance (Euler time step)
+     *
+     * @param dt delta time
+     */
+    void updateUnknowns(float dt);
+
+    /**
+     * @brief Destructor
+     */
+    virtual ~SWE_RusanovBlockOMP() {}
+
+};
+
+#endif
@@ -4,10 +4,14 @@
  */
 
 #include <cassert>
+#include <chrono>
 #include <cstdlib>
+#include <limits>
+#include <stdexcept>
 #include <string>
 #include <iostream>
 #include <thread>
+#include <vector>
 #include <omp.h>
 
 //Use these macros to select x, y or both dimensions for splitting
@@ -18,7 +22,14 @@
 #define DIMSPLIT_SELECT DIMSPLIT_SELECT_XY
 
 #ifndef CUDA
+#include "blocks/SWE_BlockFactory.hh"
 #include "blocks/SWE_DimensionalSplittingBlock.hh"
+#include "tools/Autotuner.hh"
+#include "tools/Pinning.hh"
+#include "tools/ThreadPool.hh"
+#if defined(VECTOR_SSE4_FLOAT32) || defined(VECTOR_AVX_FLOAT32) || defined(VECTOR_AVX512_FLOAT32) || defined(VECTOR_DISPATCH)
+#include "blocks/SWE_FWaveSIMD.hh"
+#endif
 #else
 #include "blocks/cuda/SWE_DimensionalSplittingBlock.hh"
 #endif
@@ -66,6 +77,93 @@ void addArgument(tools::Args& args, string name,
   else args.addOption(name, shortOption, description, tools::Args::Argument::Optional, false);
 }
 
+/**
+ * @brief Advances the block by one time step, the ghost layers have to be set before
+ * 
+ * @param i_block The block
+ * @param i_dimensionalSplittingBlock The same block, if it is a dimensional splitting block, NULL otherwise
+ * @param i_fused Wether to use the fused sweeps
+ * @param i_tiled Wether to run the fused sweeps column by column, both at once
+ * 
+ * @return The time step width
+ */
+template <class DimensionalSplittingBlock>
+float simulateTimeStep(SWE_Block* i_block, DimensionalSplittingBlock* i_dimensionalSplittingBlock, bool i_fused, bool i_tiled)
+{
+  //maximum allowed time step width.
+  float l_maxTimeStepWidth;
+
+#ifndef CUDA
+  if(i_dimensionalSplittingBlock == NULL)
+  {
+    //no splitting: compute the net-updates of all edges, then update the cells
+    i_block->computeNumericalFluxes();
+    l_maxTimeStepWidth = i_block->getMaxTimestep();
+    i_block->updateUnknowns(l_maxTimeStepWidth);
+  }
+  else if(i_fused)
+  {
+    //approximate max timestep using upper bounds of the wavespeeds in both directions,
+    //which the vertical sweep of the previous time step reduced while it updated the cells
+    i_dimensionalSplittingBlock->computeMaxTimestep(i_dimensionalSplittingBlock->getMaxCellSpeedHorizontal(),
+      i_dimensionalSplittingBlock->getMaxCellSpeedVertical());
+    l_maxTimeStepWidth = i_dimensionalSplittingBlock->getMaxTimestep();
+    //compute and apply the x (horizontal) and the y (vertical) sweep
+    if(i_tiled) i_dimensionalSplittingBlock->computeNumericalFluxesAndUpdate(l_maxTimeStepWidth);
+    else
+    {
+      i_dimensionalSplittingBlock->computeNumericalFluxesAndUpdateHorizontal(l_maxTimeStepWidth);
+      i_dimensionalSplittingBlock->computeNumericalFluxesAndUpdateVertical(l_maxTimeStepWidth);
+    }
+  }
+  else
+#endif
+  {
+#if DIMSPLIT_SELECT != DIMSPLIT_SELECT_Y
+  //compute x (horizontal) sweep
+  float l_maxWaveSpeedHorizontal = i_dimensionalSplittingBlock->computeNumericalFluxesHorizontal();
+#if DIMSPLIT_SELECT == DIMSPLIT_SELECT_X || defined(CUDA)
+  //approximate max timestep using the max wavespeed in x direction
+  i_dimensionalSplittingBlock->computeMaxTimestep(l_maxWaveSpeedHorizontal, true);
+#else
+  //approximate max timestep using the max wavespeed in x direction and an upper bound of the one in y direction,
+  //which the vertical update of the previous time step reduced
+  i_dimensionalSplittingBlock->computeMaxTimestep(l_maxWaveSpeedHorizontal, i_dimensionalSplittingBlock->getMaxCellSpeedVertical());
+#endif
+  l_maxTimeStepWidth = i_dimensionalSplittingBlock->getMaxTimestep();
+  //update unknowns in x direction
+  i_dimensionalSplittingBlock->updateUnknownsHorizontal(l_maxTimeStepWidth);
+
+#if !defined(NDEBUG) || defined(DEBUG)
+  //Check CFL condition for x sweep
+  //assert(l_maxTimeStepWidth < 0.5 * (l_dX / l_maxWaveSpeedHorizontal));
+#endif
+
+#endif
+
+#if DIMSPLIT_SELECT != DIMSPLIT_SELECT_X
+  //compute y (vertical) sweep fluxes
+  float l_maxWaveSpeedVertical = i_dimensionalSplittingBlock->computeNumericalFluxesVertical();
+
+#if DIMSPLIT_SELECT == DIMSPLIT_SELECT_Y
+  //approximate max timestep using the max wavespeed in y direction
+  i_dimensionalSplittingBlock->computeMaxTimestep(l_maxWaveSpeedVertical, false);
+  l_maxTimeStepWidth = i_dimensionalSplittingBlock->getMaxTimestep();
+#endif
+
+  //update unknowns in y direction, reeuse max time step
+  i_dimensionalSplittingBlock->updateUnknownsVertical(l_maxTimeStepWidth);
+
+#if !defined(NDEBUG) || defined(DEBUG)
+  //Check CFL condition for y sweep
+  //assert(l_maxTimeStepWidth < 0.5 * (l_dY / l_maxWaveSpeedVertical));
+#endif
+
+#endif
+  }
+  return l_maxTimeStepWidth;
+}
+
 /**
  * @brief Main program for the simulation on a single SWE_DimensionalSplittingBlock
  * 
@@ -77,7 +175,7 @@ void addArgument(tools::Args& args, string name,
 int main(int argc, char** argv) 
 {
 
-  tools::Logger::logger.printString("\nThis is swe_dimensionalsplitting, using SWE_DimensionalSplittingBlock\n");
+  tools::Logger::logger.printString("\nThis is swe_dimensionalsplitting, using SWE_DimensionalSplittingBlock (or any other block selected with --block-type)\n");
 
   // Parse command line parameters
   tools::Args args;
@@ -98,6 +196,16 @@ int main(int argc, char** argv)
   addArgument(args, "simulate-failure", 'f', "Simulate failure after n timesteps");
   addArgument(args, "output-scale", 's', "Scale for the output file cell sizes");
   addArgument(args, "limit-threads", 'z', "Maximum number of threads used");
+  addArgument(args, "fused-sweeps", 0, "Compute and apply the net-updates in one pass per sweep (f-wave solver only)");
+  addArgument(args, "tiled-sweeps", 0, "Like fused-sweeps, but update each column in both directions while it is in the cache (f-wave solver only)");
+  addArgument(args, "wave-front-tracking", 0, "Skip the sea at rest until the wave arrives, optionally with the rest tolerance in m (default 0.001)");
+#ifndef CUDA
+  addArgument(args, "block-type", 0, "Block type: dimsplit, wavepropagation (no splitting), rusanov or dimsplit-simd (if built with simdExtensions)");
+  addArgument(args, "solver", 0, "Riemann solver: fwave (default), augrie, hybrid, or rusanov (rusanov block only, default if built with it)");
+  addArgument(args, "autotune", 0, "Time a few steps of the block types, tile sizes and thread counts, optionally with the cache file of the winners (default swe_autotune.txt)");
+  addArgument(args, "thread-pool", 0, "Run the sweeps on a persistent work-stealing thread pool instead of OpenMP");
+  addArgument(args, "pinning", 0, "Pin the threads to cores: compact, scatter or a list of logical CPUs like 0,2,4-7");
+#endif
 #endif
   tools::Args::Result ret = args.parse(argc, argv);
 
@@ -123,6 +231,20 @@ int main(int argc, char** argv)
   int l_failure = -1;
   int l_output_scale = 1;
   int l_limit_cpu = 1;
+  bool l_fused_sweeps = false;
+  bool l_tiled_sweeps = false;
+  bool l_wave_front_tracking = false;
+  float l_rest_tolerance = 0.001f;
+#ifndef CUDA
+  std::string l_block_type = blocks::getDefaultBlockType();
+  std::string l_solver = blocks::getDefaultSolver();
+  bool l_autotune = false;
+  std::string l_autotune_file = "swe_autotune.txt";
+  bool l_thread_pool = false;
+  tools::ThreadPool* l_threadPool = NULL;
+  //logical CPU of every thread, empty without pinning
+  std::vector<int> l_pinned_cpus;
+#endif
   //boundary conditions
   BoundaryType* l_bound_types = new BoundaryType[4]; 
   //l_baseName of the plots.
@@ -189,6 +311,51 @@ int main(int argc, char** argv)
   omp_set_num_threads(l_limit_cpu);
 #endif
   sstm << "Number of threads used:\t\t" << l_limit_cpu << "\n";
+  l_tiled_sweeps = args.isSet("tiled-sweeps");
+  //the tiled sweeps are fused sweeps, which run both directions at once
+  l_fused_sweeps = args.isSet("fused-sweeps") || l_tiled_sweeps;
+  sstm << "Fused sweeps:\t\t\t" << (l_fused_sweeps ? (l_tiled_sweeps ? "yes (tiled)" : "yes") : "no") << "\n";
+  l_wave_front_tracking = args.isSet("wave-front-tracking");
+  if(l_wave_front_tracking && !args.getArgument<std::string>("wave-front-tracking").empty())
+    l_rest_tolerance = args.getArgument<float>("wave-front-tracking");
+  sstm << "Wave-front tracking:\t\t";
+  if(l_wave_front_tracking) sstm << "yes (rest tolerance " << l_rest_tolerance << " m)\n";
+  else sstm << "no\n";
+#ifndef CUDA
+  if(args.isSet("block-type")) l_block_type = args.getArgument<std::string>("block-type");
+  if(args.isSet("solver")) l_solver = args.getArgument<std::string>("solver");
+  sstm << "Block type:\t\t\t" << l_block_type << "\n";
+  sstm << "Riemann solver:\t\t\t" << l_solver << "\n";
+  l_autotune = args.isSet("autotune");
+  if(l_autotune && !args.getArgument<std::string>("autotune").empty())
+    l_autotune_file = args.getArgument<std::string>("autotune");
+  sstm << "Autotuning:\t\t\t";
+  if(l_autotune) sstm << "yes (cache file " << l_autotune_file << ")\n";
+  else sstm << "no\n";
+  l_thread_pool = args.isSet("thread-pool");
+  sstm << "Thread pool:\t\t\t" << (l_thread_pool ? "yes" : "no") << "\n";
+  sstm << "Thread pinning:\t\t\t";
+  if(args.isSet("pinning"))
+  {
+    // the threads are pinned before the block is allocated, so its columns are first touched by the pinned threads
+    try
+    {
+      tools::Pinning l_pinning(args.getArgument<std::string>("pinning"), l_limit_cpu);
+      const bool l_pinned = l_pinning.pinOpenMPThreads();
+      l_pinned_cpus = l_pinning.getCpus();
+      sstm << l_pinning.toString() << (l_pinned ? "" : ", not all threads could be pinned") << "\n";
+    }
+    catch(const std::runtime_error& e)
+    {
+      tools::Logger::logger.printString(std::string(e.what()) + "\n");
+      return 1;
+    }
+  }
+  else sstm << "no\n";
+#endif
+#if defined(VECTOR_SSE4_FLOAT32) || defined(VECTOR_AVX_FLOAT32) || defined(VECTOR_AVX512_FLOAT32) || defined(VECTOR_DISPATCH)
+  sstm << "Vector instruction set:\t\t" << simd::getFWaveKernel().name << " (" << simd::getFWaveKernel().vectorLength << " edges)\n";
+#endif
 
   tools::Logger::logger.printString(sstm.str());
 #endif
@@ -258,13 +425,6 @@ if((l_timestep + 1) >= l_checkpoints)
     l_dX = (l_scenario->getBoundaryPos(BND_RIGHT) - l_scenario->getBoundaryPos(BND_LEFT))/l_nX;
     l_dY = (l_scenario->getBoundaryPos(BND_TOP) - l_scenario->getBoundaryPos(BND_BOTTOM))/l_nY;
   }
-  // create a single dimensional splitting block
-#ifndef CUDA
-  SWE_DimensionalSplittingBlock l_dimensionalSplittingBlock(l_nX,l_nY,l_dX,l_dY, l_limit_cpu);
-#else
-  SWE_DimensionalSplittingBlockCuda l_dimensionalSplittingBlock(l_nX,l_nY,l_dX,l_dY);
-#endif
-
   //origin of the simulation domain in x- and y-direction
   float l_originX, l_originY;
   if(isCheckpoint)
@@ -278,8 +438,139 @@ if((l_timestep + 1) >= l_checkpoints)
     l_originX = l_scenario->getBoundaryPos(BND_LEFT);
     l_originY = l_scenario->getBoundaryPos(BND_BOTTOM);
   }
-  // initialize the dimensional splitting block
-  l_dimensionalSplittingBlock.initScenario(l_originX, l_originY, *l_scenario);
+
+#ifndef CUDA
+  //the fused and tiled sweeps take the time step from the wave speeds of the cells, which bound the ones of the edges
+  //for the f-wave solver only, the augmented Riemann solvers may exceed them, e.g. at a front running onto a dry bed
+  if(l_fused_sweeps && l_solver != "fwave")
+  {
+    tools::Logger::logger.printString("The fused and tiled sweeps need the f-wave solver\n");
+    return 1;
+  }
+
+  //edge length of the tiles of the activity mask, zero keeps the default
+  int l_tile_size = 0;
+  if(l_autotune)
+  {
+    //the winner depends on the host, the grid, the solver and the options, which change the work per cell
+    std::ostringstream l_key;
+    l_key << l_nX << "x" << l_nY << "/" << l_solver;
+    if(l_tiled_sweeps) l_key << "/tiled";
+    else if(l_fused_sweeps) l_key << "/fused";
+    if(l_wave_front_tracking) l_key << "/tracking";
+    tools::Autotuner l_autotuner(l_autotune_file, l_key.str());
+
+    tools::Autotuner::Configuration l_configuration;
+    if(l_autotuner.lookup(l_configuration))
+      tools::Logger::logger.printString("Autotuning: using the cached configuration of " + l_autotune_file + "\n");
+    else
+    {
+      //only the variants of the dimensional splitting are candidates, they compute the same solution
+      std::vector<std::string> l_block_types;
+      if(args.isSet("block-type") || !blocks::isAvailable("dimsplit", l_solver)) l_block_types.push_back(l_block_type);
+      else
+      {
+        if(blocks::isAvailable("dimsplit-simd", l_solver)) l_block_types.push_back("dimsplit-simd");
+        l_block_types.push_back("dimsplit");
+      }
+      //the default tile size is the first candidate
+      std::vector<int> l_tile_sizes;
+      l_tile_sizes.push_back(32);
+      l_tile_sizes.push_back(16);
+      l_tile_sizes.push_back(64);
+      l_tile_sizes.push_back(128);
+      //powers of two up to the maximum number of threads
+      std::vector<int> l_thread_counts;
+      for(int n = 1; n < l_limit_cpu; n *= 2) l_thread_counts.push_back(n);
+      l_thread_counts.push_back(l_limit_cpu);
+
+      //times a few steps of the scenario on a fresh block, the first step only warms up the caches and the threads
+      const int l_autotune_steps = 5;
+      auto l_measure = [&](const tools::Autotuner::Configuration& i_configuration) -> double
+      {
+#ifdef USE_OMP
+        omp_set_num_threads(i_configuration.numThreads);
+#endif
+        SWE_Block* l_candidate = blocks::createBlock(i_configuration.blockType, l_solver,
+          l_nX, l_nY, l_dX, l_dY, i_configuration.numThreads, l_fused_sweeps);
+        if(l_candidate == NULL) return std::numeric_limits<double>::infinity();
+        SWE_DimensionalSplittingBlock* l_candidateSplitting = dynamic_cast<SWE_DimensionalSplittingBlock*>(l_candidate);
+        if(l_fused_sweeps && l_candidateSplitting == NULL)
+        {
+          delete l_candidate;
+          return std::numeric_limits<double>::infinity();
+        }
+        l_candidate->setTileSize(i_configuration.tileSize);
+        //every candidate gets a pool with its number of threads
+        tools::ThreadPool* l_candidatePool = l_thread_pool ? new tools::ThreadPool(i_configuration.numThreads, l_pinned_cpus) : NULL;
+        l_candidate->setThreadPool(l_candidatePool);
+        l_candidate->initScenario(l_originX, l_originY, *l_scenario);
+        l_candidate->setWaveFrontTracking(l_wave_front_tracking, l_rest_tolerance);
+        std::chrono::steady_clock::time_point l_start;
+        for(int s = 0; s <= l_autotune_steps; s++)
+        {
+          if(s == 1) l_start = std::chrono::steady_clock::now();
+          l_candidate->setGhostLayer();
+          simulateTimeStep(l_candidate, l_candidateSplitting, l_fused_sweeps, l_tiled_sweeps);
+        }
+        std::chrono::duration<double> l_duration = std::chrono::steady_clock::now() - l_start;
+        delete l_candidate;
+        delete l_candidatePool;
+        return l_duration.count() / l_autotune_steps;
+      };
+
+      double l_seconds_per_step;
+      l_configuration = tools::Autotuner::tune(l_block_types, l_tile_sizes, l_thread_counts, l_measure, l_seconds_per_step);
+      if(l_seconds_per_step == std::numeric_limits<double>::infinity())
+      {
+        tools::Logger::logger.printString("Autotuning: no candidate is available, available are: " + blocks::getAvailableBlocks() + "\n");
+        return 1;
+      }
+      l_autotuner.store(l_configuration, l_seconds_per_step);
+    }
+
+    l_block_type = l_configuration.blockType;
+    l_tile_size = l_configuration.tileSize;
+    l_limit_cpu = l_configuration.numThreads;
+#ifdef USE_OMP
+    omp_set_num_threads(l_limit_cpu);
+#endif
+    std::ostringstream l_message;
+    l_message << "Autotuning: selected " << l_block_type << ", tile size " << l_tile_size << ", " << l_limit_cpu << " threads\n";
+    tools::Logger::logger.printString(l_message.str());
+  }
+#endif
+
+  // create a single block of the selected type,
+  // the dimensional splitting block is NULL for the blocks without splitting
+#ifndef CUDA
+  SWE_Block* l_block = blocks::createBlock(l_block_type, l_solver, l_nX, l_nY, l_dX, l_dY, l_limit_cpu, l_fused_sweeps);
+  if(l_block == NULL)
+  {
+    tools::Logger::logger.printString("Unknown block type or solver, available are: " + blocks::getAvailableBlocks() + "\n");
+    return 1;
+  }
+  SWE_DimensionalSplittingBlock* l_dimensionalSplittingBlock = dynamic_cast<SWE_DimensionalSplittingBlock*>(l_block);
+  if(l_fused_sweeps && l_dimensionalSplittingBlock == NULL)
+  {
+    tools::Logger::logger.printString("The fused sweeps need a dimensional splitting block\n");
+    return 1;
+  }
+  if(l_tile_size > 0) l_block->setTileSize(l_tile_size);
+  if(l_dimensionalSplittingBlock != NULL) l_dimensionalSplittingBlock->setTiledSweeps(l_tiled_sweeps);
+  if(l_thread_pool)
+  {
+    l_threadPool = new tools::ThreadPool(l_limit_cpu, l_pinned_cpus);
+    l_block->setThreadPool(l_threadPool);
+  }
+#else
+  SWE_DimensionalSplittingBlockCuda* l_dimensionalSplittingBlock = new SWE_DimensionalSplittingBlockCuda(l_nX,l_nY,l_dX,l_dY);
+  SWE_Block* l_block = l_dimensionalSplittingBlock;
+#endif
+
+  // initialize the block
+  l_block->initScenario(l_originX, l_originY, *l_scenario);
+  l_block->setWaveFrontTracking(l_wave_front_tracking, l_rest_tolerance);
 
   //time when the simulation ends.
   float l_endSimulation = l_scenario->endSimulation();
@@ -303,18 +594,18 @@ if((l_timestep + 1) >= l_checkpoints)
 
 #ifdef WRITENETCDF
   //construct a NetCdfWriter
-  io::NetCdfWriter l_writer(l_fileName, l_baseName, l_dimensionalSplittingBlock.getBathymetry(),
+  io::NetCdfWriter l_writer(l_fileName, l_baseName, l_block->getBathymetry(),
     l_boundarySize, l_nX, l_nY, l_dX, l_dY, (int*)l_bound_types, l_time_dur, l_checkpoints, l_originX, l_originY, l_timestep, isCheckpoint, 1, false, l_output_scale);
 #else
   // consturct a VtkWriter
-  io::VtkWriter l_writer(l_fileName, l_dimensionalSplittingBlock.getBathymetry(),
+  io::VtkWriter l_writer(l_fileName, l_block->getBathymetry(),
     l_boundarySize, l_nX, l_nY, l_dX, l_dY );
 #endif
   if(!isCheckpoint)
   {
     // Write zero time step
-    l_writer.writeTimeStep(l_dimensionalSplittingBlock.getWaterHeight(),
-      l_dimensionalSplittingBlock.getDischarge_hu(), l_dimensionalSplittingBlock.getDischarge_hv(), (float) 0.);
+    l_writer.writeTimeStep(l_block->getWaterHeight(),
+      l_block->getDischarge_hu(), l_block->getDischarge_hv(), (float) 0.);
   }
 
 
@@ -337,52 +628,34 @@ if((l_timestep + 1) >= l_checkpoints)
        tools::Logger::logger.printString("Simulating catastrophic failure\n");
        abort(); //rough termination, no cleanup, no io flushing
     }
+#if !defined(CUDA) && DIMSPLIT_SELECT == DIMSPLIT_SELECT_XY
+    // reset the cpu clock
+    tools::Logger::logger.resetClockToCurrentTime("Cpu");
+
+    // do time steps until next checkpoint is reached, the block returns only at the checkpoint
+    const int l_steps = l_block->advance(l_t, l_checkPoints[c]);
+    l_iterations += l_steps;
+
+    // update the cpu time in the logger
+    tools::Logger::logger.updateTime("Cpu");
+    // print the current simulation time
+    progressBar.clear();
+    tools::Logger::logger.printSimulationTime(l_t);
+    // the skipped cells of all time steps to the checkpoint
+    if(l_wave_front_tracking) tools::Logger::logger.printSkippedCells(l_block->getSkippedCellsOfAdvance(), (long) l_nX * l_nY, l_steps);
+    progressBar.update(l_t);
+#else
     // do time steps until next checkpoint is reached
     while( l_t < l_checkPoints[c] )
     {
       // set values in ghost cells:
-      l_dimensionalSplittingBlock.setGhostLayer();
+      l_block->setGhostLayer();
       // reset the cpu clock
       tools::Logger::logger.resetClockToCurrentTime("Cpu");
 
-#if DIMSPLIT_SELECT != DIMSPLIT_SELECT_Y
-      //compute x (horizontal) sweep
-      float l_maxWaveSpeedHorizontal = l_dimensionalSplittingBlock.computeNumericalFluxesHorizontal();
-      //approximate max timestep using the max wavespeed in x direction
-      l_dimensionalSplittingBlock.computeMaxTimestep(l_maxWaveSpeedHorizontal, true);
-      //maximum allowed time step width.
-      float l_maxTimeStepWidth = l_dimensionalSplittingBlock.getMaxTimestep();
-      //update unknowns in x direction
-      l_dimensionalSplittingBlock.updateUnknownsHorizontal(l_maxTimeStepWidth);
-
-#if !defined(NDEBUG) || defined(DEBUG)
-      //Check CFL condition for x sweep
-      //assert(l_maxTimeStepWidth < 0.5 * (l_dX / l_maxWaveSpeedHorizontal));
-#endif
-
-#endif
+      //advance the block by one time step
+      float l_maxTimeStepWidth = simulateTimeStep(l_block, l_dimensionalSplittingBlock, l_fused_sweeps, l_tiled_sweeps);
 
-#if DIMSPLIT_SELECT != DIMSPLIT_SELECT_X
-      //compute y (vertical) sweep fluxes
-      float l_maxWaveSpeedVertical = l_dimensionalSplittingBlock.computeNumericalFluxesVertical();
-
-#if DIMSPLIT_SELECT == DIMSPLIT_SELECT_Y
-      //approximate max timestep using the max wavespeed in y direction
-      l_dimensionalSplittingBlock.computeMaxTimestep(l_maxWaveSpeedVertical, false);
-      //maximum allowed time step width.
-      float l_maxTimeStepWidth = l_dimensionalSplittingBlock.getMaxTimestep();
-#endif
-
-      //update unknowns in y direction, reeuse max time step
-      l_dimensionalSplittingBlock.updateUnknownsVertical(l_maxTimeStepWidth);
-
-#if !defined(NDEBUG) || defined(DEBUG)
-      //Check CFL condition for y sweep
-      //assert(l_maxTimeStepWidth < 0.5 * (l_dY / l_maxWaveSpeedVertical));
-#endif
-
-#endif
-     
       // update the cpu time in the logger
       tools::Logger::logger.updateTime("Cpu");
       // update simulation time with time step width.
@@ -391,16 +664,18 @@ if((l_timestep + 1) >= l_checkpoints)
       // print the current simulation time
       progressBar.clear();
       tools::Logger::logger.printSimulationTime(l_t);
+      if(l_wave_front_tracking) tools::Logger::logger.printSkippedCells(l_block->getSkippedCells(), (long) l_nX * l_nY);
       progressBar.update(l_t);
     }
+#endif
 
     // print current simulation time of the output
     progressBar.clear();
     tools::Logger::logger.printOutputTime(l_t);
     progressBar.update(l_t);
     // write output
-    l_writer.writeTimeStep( l_dimensionalSplittingBlock.getWaterHeight(),
-      l_dimensionalSplittingBlock.getDischarge_hu(), l_dimensionalSplittingBlock.getDischarge_hv(), l_t);
+    l_writer.writeTimeStep( l_block->getWaterHeight(),
+      l_block->getDischarge_hu(), l_block->getDischarge_hv(), l_t);
   }
 
   // write the statistics message
@@ -413,6 +688,10 @@ if((l_timestep + 1) >= l_checkpoints)
   // printer iteration counter
   tools::Logger::logger.printIterationsDone(l_iterations);
 
+  delete l_block;
+#ifndef CUDA
+  delete l_threadPool;
+#endif
   delete l_scenario;
   delete l_bound_types;
 
@@ -35,7 +35,14 @@
 #include <string>
 #include <vector>
 
-#ifndef CUDA
+#ifdef USE_OMP
+#include <omp.h>
+#endif
+
+#if defined(MPI_DIMSPLIT)
+#include "blocks/SWE_BlockFactory.hh"
+#include "blocks/SWE_DimensionalSplittingBlock.hh"
+#elif !defined(CUDA)
 #include "blocks/SWE_WavePropagationBlock.hh"
 #include "blocks/SWE_WaveAccumulationBlock.hh"
 #else
@@ -59,6 +66,7 @@
 #endif
 
 #include "tools/args.hh"
+#include "tools/GhostLayerExchange.hh"
 #include "tools/help.hh"
 #include "tools/Logger.hh"
 #include "tools/ProgressBar.hh"
@@ -80,18 +88,163 @@ int computeNumberOfBlockRows(int i_numberOfProcesses) {
   return l_numberOfRows;
 };
 
-// Exchanges the left and right ghost layers.
-void exchangeLeftRightGhostLayers( const int i_leftNeighborRank,  SWE_Block1D* o_leftInflow,  SWE_Block1D* i_leftOutflow,
-                                   const int i_rightNeighborRank, SWE_Block1D* o_rightInflow, SWE_Block1D* i_rightOutflow,
-                                   MPI_Datatype i_mpiCol);
+/**
+ * Minimum of the time steps of all blocks, which is reduced while the blocks compute.
+ *
+ * The time step of a block is predicted from its cells at the end of the previous time step,
+ * so the reduction can run during the exchange of the ghost layers and the computation of the fluxes
+ * of the next one, instead of a blocking MPI_Allreduce() between the fluxes and the update.
+ */
+struct TimeStepReduction {
+  //! predicted time step of the block
+  float local;
+  //! minimum of the predicted time steps of all blocks
+  float global;
+  //! request of the non-blocking reduction
+  MPI_Request request;
+
+  TimeStepReduction(): local(0.f), global(0.f), request(MPI_REQUEST_NULL) {}
+
+  //! starts the reduction of the predicted time step of the block
+  void start(float i_timeStep) {
+    local = i_timeStep;
+    MPI_Iallreduce(&local, &global, 1, MPI_FLOAT, MPI_MIN, MPI_COMM_WORLD, &request);
+  }
+
+  //! completes the reduction, if one was started
+  float wait() {
+    MPI_Wait(&request, MPI_STATUS_IGNORE);
+    return global;
+  }
+};
+
+#ifdef MPI_DIMSPLIT
+/**
+ * Advances a dimensional splitting block by one time step.
+ *
+ * Each sweep exchanges only the ghost layers it reads: the x-sweep the left and right ones,
+ * the y-sweep the bottom and top ones, which hold the cells of the neighbours after their x-sweep.
+ * Both sweeps use the same time step, the minimum of the time steps of all blocks.
+ * It is computed like in the single block driver, from the wave speeds of the x-sweep
+ * (or the cells for the fused sweeps) and the cells in y-direction, before the x-sweep updates the cells.
+ * With a time step reduction, the time step is predicted from the cells in both directions
+ * at the end of the previous time step, as for the fused sweeps, and reduced during the x-sweep.
+ * Like for the fused sweeps, the edges of the y-sweep may exceed the speeds of the cells before the x-sweep,
+ * these time steps are counted.
+ *
+ * @param i_block The block
+ * @param i_ghostLayerExchange Exchange of the ghost layers of the block
+ * @param i_fused Wether to use the fused sweeps
+ * @param io_timeStepReduction Reduction of the predicted time step, started by the previous time step,
+ *  NULL to reduce the time step with a blocking MPI_Allreduce()
+ * @param io_exceededTimeSteps Incremented, if the predicted time step exceeds the one of the edges of the block
+ * @return The global time step width
+ */
+float simulateTimeStepDimensionalSplitting(SWE_DimensionalSplittingBlock& i_block,
+                                           tools::GhostLayerExchange& i_ghostLayerExchange, bool i_fused,
+                                           TimeStepReduction* io_timeStepReduction, unsigned int& io_exceededTimeSteps) {
+  // exchange the left and right ghost layers for the x-sweep
+  i_ghostLayerExchange.startLeftRight();
+  i_ghostLayerExchange.waitLeftRight();
+
+  // reset the cpu clock
+  tools::Logger::logger.resetClockToCurrentTime("Cpu");
+
+  // set values in ghost cells
+  i_block.setGhostLayer();
+
+  //! maximum wave speed of the edges of the x-sweep
+  float l_maxWaveSpeedHorizontal = 0.f;
+
+  // compute the x-sweep, the fused sweeps need the time step first
+  if (!i_fused)
+    l_maxWaveSpeedHorizontal = i_block.computeNumericalFluxesHorizontal();
+
+  //! maximum allowed time steps of all blocks
+  float l_maxTimeStepWidthGlobal;
+
+  if (io_timeStepReduction != NULL) {
+    // update the cpu time in the logger
+    tools::Logger::logger.updateTime("Cpu");
+
+    // wait for the time step, which was predicted at the end of the previous time step
+    tools::Logger::logger.resetClockToCurrentTime("TimeStepWait");
+    l_maxTimeStepWidthGlobal = io_timeStepReduction->wait();
+    tools::Logger::logger.updateTime("TimeStepWait");
+  } else {
+    // approximate the time step with the upper bounds of the wave speeds of the cells, if the edges are not computed
+    if (i_fused)
+      i_block.computeMaxTimestep(i_block.getMaxCellSpeedHorizontal(), i_block.getMaxCellSpeedVertical());
+    else
+      i_block.computeMaxTimestep(l_maxWaveSpeedHorizontal, i_block.getMaxCellSpeedVertical());
+
+    //! maximum allowed time step width within a block.
+    float l_maxTimeStepWidth = i_block.getMaxTimestep();
+
+    // update the cpu time in the logger
+    tools::Logger::logger.updateTime("Cpu");
+
+    // determine smallest time step of all blocks
+    MPI_Allreduce(&l_maxTimeStepWidth, &l_maxTimeStepWidthGlobal, 1, MPI_FLOAT, MPI_MIN, MPI_COMM_WORLD);
+  }
+
+  // reset the cpu time
+  tools::Logger::logger.resetClockToCurrentTime("Cpu");
+
+  // update the cells in x-direction
+  if (i_fused)
+    l_maxWaveSpeedHorizontal = i_block.computeNumericalFluxesAndUpdateHorizontal(l_maxTimeStepWidthGlobal);
+  else
+    i_block.updateUnknownsHorizontal(l_maxTimeStepWidthGlobal);
+
+  // update the cpu time in the logger
+  tools::Logger::logger.updateTime("Cpu");
+
+  // exchange the bottom and top ghost layers for the y-sweep
+  i_ghostLayerExchange.startBottomTop();
+  i_ghostLayerExchange.waitBottomTop();
+
+  // reset the cpu clock
+  tools::Logger::logger.resetClockToCurrentTime("Cpu");
+
+  // set values in ghost cells, the bottom and top boundary conditions mirror the updated cells
+  i_block.setGhostLayer();
+
+  // the activity mask of the x-sweep was updated with the previous bottom and top ghost layers
+  i_block.addBottomTopGhostLayersToTileActivity();
+
+  //! maximum wave speed of the edges of the y-sweep
+  float l_maxWaveSpeedVertical;
+
+  // compute the y-sweep and update the cells in y-direction
+  if (i_fused) {
+    l_maxWaveSpeedVertical = i_block.computeNumericalFluxesAndUpdateVertical(l_maxTimeStepWidthGlobal);
+  } else {
+    l_maxWaveSpeedVertical = i_block.computeNumericalFluxesVertical();
+    i_block.updateUnknownsVertical(l_maxTimeStepWidthGlobal);
+  }
+
+  if (io_timeStepReduction != NULL) {
+    // check the prediction against the wave speeds of the edges
+    i_block.computeMaxTimestep(l_maxWaveSpeedHorizontal, l_maxWaveSpeedVertical);
+    if (l_maxTimeStepWidthGlobal > i_block.getMaxTimestep())
+      io_exceededTimeSteps++;
+
+    // predict the next time step from the updated cells and reduce it during the next x-sweep
+    i_block.computeMaxTimestep(i_block.getMaxCellSpeedHorizontal(), i_block.getMaxCellSpeedVertical());
+    io_timeStepReduction->start(i_block.getMaxTimestep());
+  }
+
+  // update the cpu time in the logger
+  tools::Logger::logger.updateTime("Cpu");
 
-// Exchanges the bottom and top ghist layers.
-void exchangeBottomTopGhostLayers( const int i_bottomNeighborRank, SWE_Block1D* o_bottomNeighborInflow, SWE_Block1D* i_bottomNeighborOutflow,
-                                   const int i_topNeighborRank,    SWE_Block1D* o_topNeighborInflow,    SWE_Block1D* i_topNeighborOutflow,
-                                   const MPI_Datatype i_mpiRow);
+  return l_maxTimeStepWidthGlobal;
+}
+#endif
 
 /**
- * Main program for the simulation on a single SWE_WavePropagationBlock or SWE_WaveAccumulationBlock.
+ * Main program for the simulation on a single SWE_WaveAccumulationBlock or, if built with dimensional splitting,
+ * SWE_DimensionalSplittingBlock per process.
  */
 int main( int argc, char** argv ) {
   /**
@@ -130,6 +283,19 @@ int main( int argc, char** argv ) {
   args.addOption("grid-size-y", 'y', "Number of cell in y direction");
   args.addOption("output-basepath", 'o', "Output base file name");
   args.addOption("output-steps-count", 'c', "Number of output time steps");
+  #if defined(MPI_DIMSPLIT)
+  args.addOption("block-type", 0, "Type of the dimensional splitting block: dimsplit or dimsplit-simd", tools::Args::Required, false);
+  args.addOption("solver", 0, "Riemann solver: fwave, augrie or hybrid", tools::Args::Required, false);
+  args.addOption("fused-sweeps", 0, "Compute and apply the net-updates in one pass per sweep (f-wave solver only)", tools::Args::No, false);
+  #else
+  args.addOption("blocking-exchange", 0, "Exchange the ghost layers before computing, instead of overlapping it with the interior edges", tools::Args::No, false);
+  #ifndef CUDA
+  args.addOption("ghost-width", 0, "Depth of the ghost layers, which are exchanged every ghost-width time steps (default: 1)", tools::Args::Required, false);
+  #endif
+  #endif
+  #ifndef CUDA
+  args.addOption("overlap-reduction", 0, "Predict the time step from the cells and reduce it with MPI_Iallreduce, while the next fluxes are computed (f-wave solver only)", tools::Args::No, false);
+  #endif
   #ifdef ASAGI
   args.addOption("bathymetry-file", 'b', "File containing the bathymetry");
   args.addOption("displacement-file", 'd', "File containing the displacement");
@@ -165,6 +331,58 @@ int main( int argc, char** argv ) {
   l_baseName = args.getArgument<std::string>("output-basepath");
   #endif
 
+  //! depth of the ghost layers, the blocks run this many time steps between two exchanges.
+  int l_ghostWidth = 1;
+  #if !defined(CUDA) && !defined(MPI_DIMSPLIT)
+  if (args.isSet("ghost-width"))
+    l_ghostWidth = args.getArgument<int>("ghost-width");
+  #endif
+
+  //! exchange the ghost layers with blocking MPI calls, before the fluxes are computed.
+  //! Deeper ghost layers are always exchanged this way, their inner layers are computed like the cells,
+  //! and so are the ghost layers of each sweep of the dimensional splitting.
+  bool l_blockingExchange = args.isSet("blocking-exchange") || l_ghostWidth > 1;
+  #ifdef MPI_DIMSPLIT
+  l_blockingExchange = true;
+
+  //! type of the dimensional splitting block and Riemann solver
+  std::string l_blockType = args.getArgument<std::string>("block-type", blocks::getDefaultBlockType());
+  std::string l_solver = args.getArgument<std::string>("solver", blocks::getDefaultSolver());
+
+  //! compute and apply the net-updates in one pass per sweep.
+  bool l_fusedSweeps = args.isSet("fused-sweeps");
+  #endif
+
+  //! reduce a predicted time step without blocking, instead of the time step of the edges between fluxes and update.
+  bool l_overlapReduction = args.isSet("overlap-reduction");
+
+  // the time step predicted from the cells bounds the one of the edges for the f-wave solver only,
+  // the augmented Riemann solvers may exceed it, e.g. at a front running onto a dry bed.
+  // The fused sweeps take their time step from the cells as well.
+  #if !defined(CUDA)
+  #if defined(MPI_DIMSPLIT)
+  const bool l_fWaveSolver = (l_solver == "fwave");
+  #elif WAVE_PROPAGATION_SOLVER==4
+  const bool l_fWaveSolver = true;
+  #else
+  const bool l_fWaveSolver = false;
+  #endif
+  if (l_overlapReduction && !l_fWaveSolver) {
+    if (l_mpiRank == 0)
+      std::cerr << "The time step reduction can only be overlapped with the f-wave solver." << std::endl;
+    MPI_Abort(MPI_COMM_WORLD, -1);
+    return 1;
+  }
+  #if defined(MPI_DIMSPLIT)
+  if (l_fusedSweeps && !l_fWaveSolver) {
+    if (l_mpiRank == 0)
+      std::cerr << "The fused sweeps need the f-wave solver." << std::endl;
+    MPI_Abort(MPI_COMM_WORLD, -1);
+    return 1;
+  }
+  #endif
+  #endif
+
   // read xml file
   #ifdef READXML
   assert(false); //TODO: not implemented.
@@ -224,8 +442,9 @@ int main( int argc, char** argv ) {
   SWE_AsagiScenario l_scenario(args.getArgument<std::string>("bathymetry-file"), args.getArgument<std::string>("displacement-file"),
                                simulationDuration, simulationArea);
   #else
-  // create a simple artificial scenario
-  SWE_RadialDamBreakScenario l_scenario;
+  // create a simple artificial scenario, the boundary conditions are set for the outer blocks below
+  BoundaryType l_boundaryTypes[4] = { OUTFLOW, OUTFLOW, OUTFLOW, OUTFLOW };
+  SWE_RadialDamBreakScenario l_scenario(l_boundaryTypes);
   #endif
 
   //! number of checkpoints for visualization (at each checkpoint in time, an output file is written).
@@ -257,9 +476,29 @@ int main( int argc, char** argv ) {
   l_originY = l_scenario.getBoundaryPos(BND_BOTTOM) + l_blockPositionY*l_nYLocal*l_dY;
 
   // create a single wave propagation block
-  #ifndef CUDA
+  #if defined(MPI_DIMSPLIT)
+  //! number of threads of the sweeps
+  int l_numberOfThreads = 1;
+  #ifdef USE_OMP
+  l_numberOfThreads = omp_get_max_threads();
+  #endif
+
+  SWE_Block* l_block = blocks::createBlock(l_blockType, l_solver, l_nXLocal, l_nYLocal, l_dX, l_dY,
+                                           l_numberOfThreads, l_fusedSweeps);
+  SWE_DimensionalSplittingBlock* l_dimensionalSplittingBlock = dynamic_cast<SWE_DimensionalSplittingBlock*>(l_block);
+  if (l_dimensionalSplittingBlock == NULL) {
+    if (l_mpiRank == 0)
+      std::cerr << "Unknown dimensional splitting block type or solver, available are: " << blocks::getAvailableBlocks() << std::endl;
+    MPI_Abort(MPI_COMM_WORLD, -1);
+    return 1;
+  }
+  SWE_Block& l_waveBlock = *l_block;
+
+  tools::Logger::logger.printString("Dimensional splitting block: " + l_blockType + "/" + l_solver
+                                    + (l_fusedSweeps ? ", fused sweeps" : ""));
+  #elif !defined(CUDA)
   // SWE_WavePropagationBlock l_waveBlock(l_nXLocal,l_nYLocal,l_dX,l_dY);
-  SWE_WaveAccumulationBlock l_waveBlock(l_nXLocal,l_nYLocal,l_dX,l_dY);
+  SWE_WaveAccumulationBlock l_waveBlock(l_nXLocal,l_nYLocal,l_dX,l_dY,l_ghostWidth);
   #else
   //! number of CUDA devices per node TODO: hardcoded
   int l_cudaDevicesPerNode = 7;
@@ -287,31 +526,24 @@ int main( int argc, char** argv ) {
   }
 
   /*
-   * Connect SWE blocks at boundaries
+   * Connect SWE blocks at boundaries,
+   * the ghost and copy layers of the inner boundaries are registered by the exchange below
    */
   // left and right boundaries
   tools::Logger::logger.printString("Connecting SWE blocks at left boundaries.");
-  SWE_Block1D* l_leftInflow  = l_waveBlock.grabGhostLayer(BND_LEFT);
-  SWE_Block1D* l_leftOutflow = l_waveBlock.registerCopyLayer(BND_LEFT);
   if (l_blockPositionX == 0)
     l_waveBlock.setBoundaryType(BND_LEFT, OUTFLOW);
 
   tools::Logger::logger.printString("Connecting SWE blocks at right boundaries.");
-  SWE_Block1D* l_rightInflow  = l_waveBlock.grabGhostLayer(BND_RIGHT);
-  SWE_Block1D* l_rightOutflow = l_waveBlock.registerCopyLayer(BND_RIGHT);
   if (l_blockPositionX == l_blocksX-1)
     l_waveBlock.setBoundaryType(BND_RIGHT, OUTFLOW);
 
   // bottom and top boundaries
   tools::Logger::logger.printString("Connecting SWE blocks at bottom boundaries.");
-  SWE_Block1D* l_bottomInflow  = l_waveBlock.grabGhostLayer(BND_BOTTOM);
-  SWE_Block1D* l_bottomOutflow = l_waveBlock.registerCopyLayer(BND_BOTTOM);
   if (l_blockPositionY == 0)
     l_waveBlock.setBoundaryType(BND_BOTTOM, OUTFLOW);
 
   tools::Logger::logger.printString("Connecting SWE blocks at top boundaries.");
-  SWE_Block1D* l_topInflow  = l_waveBlock.grabGhostLayer(BND_TOP);
-  SWE_Block1D* l_topOutflow = l_waveBlock.registerCopyLayer(BND_TOP);
   if (l_blockPositionY == l_blocksY-1)
     l_waveBlock.setBoundaryType(BND_TOP, OUTFLOW);
 
@@ -342,22 +574,14 @@ int main( int argc, char** argv ) {
    *  -> The stride for a row is ny+2, because we have to jump over a whole column
    *     for every row-element. This holds only in the CPU-version, in CUDA a buffer is implemented.
    *     See SWE_BlockCUDA.hh/.cu for details.
+   *     The columns of the CPU-version are padded to full cache lines, so the actual stride
+   *     is Float2D::getStride() >= ny+2.
    *  -> The stride for a column is 1, because we can access the elements linear in memory.
+   *
+   * The layers are packed into contiguous buffers with the stride of their proxies,
+   * so every neighbour gets a single message with the layers of h, hu and hv
+   * (all l_ghostWidth of them with deeper ghost layers).
    */
-  //! MPI row-vector: l_nXLocal+2 blocks, 1 element per block, stride of l_nYLocal+2
-  MPI_Datatype l_mpiRow;
-  #ifndef CUDA
-  MPI_Type_vector(l_nXLocal+2, 1          , l_nYLocal+2, MPI_FLOAT, &l_mpiRow);
-  #else
-  MPI_Type_vector(1,           l_nXLocal+2, 1          , MPI_FLOAT, &l_mpiRow);
-  #endif
-  MPI_Type_commit(&l_mpiRow);
-
-  //! MPI row-vector: 1 block, l_nYLocal+2 elements per block, stride of 1
-  MPI_Datatype l_mpiCol;
-  MPI_Type_vector(1,           l_nYLocal+2, 1,           MPI_FLOAT, &l_mpiCol);
-  MPI_Type_commit(&l_mpiCol);
-
   //! MPI ranks of the neighbors
   int l_leftNeighborRank, l_rightNeighborRank, l_bottomNeighborRank, l_topNeighborRank;
 
@@ -373,15 +597,34 @@ int main( int argc, char** argv ) {
                      << l_rightNeighborRank << " (right), "
                      << l_bottomNeighborRank << " (bottom), "
                      << l_topNeighborRank << " (top)" << std::endl;
+  tools::Logger::logger.cout() << "depth of the ghost layers: " << l_ghostWidth << std::endl;
+
+  //! persistent messages of the ghost and copy layers, one per neighbour
+  int l_neighborRanks[4] = { l_leftNeighborRank, l_rightNeighborRank, l_bottomNeighborRank, l_topNeighborRank };
+  tools::GhostLayerExchange* l_ghostLayerExchange =
+    new tools::GhostLayerExchange(l_waveBlock, l_neighborRanks);
 
   // intially exchange ghost and copy layers
-  exchangeLeftRightGhostLayers( l_leftNeighborRank,  l_leftInflow,  l_leftOutflow,
-                  l_rightNeighborRank, l_rightInflow, l_rightOutflow,
-                  l_mpiCol );
+  l_ghostLayerExchange->start();
+  l_ghostLayerExchange->wait();
 
-  exchangeBottomTopGhostLayers( l_bottomNeighborRank, l_bottomInflow, l_bottomOutflow,
-                  l_topNeighborRank,    l_topInflow,    l_topOutflow,
-                  l_mpiRow );
+  //! reduction of the predicted time step, which runs during the fluxes of the next time step.
+  TimeStepReduction l_timeStepReduction;
+  //! time steps, in which the predicted time step exceeded the one of the edges of the block.
+  unsigned int l_exceededTimeSteps = 0;
+
+  // start the reduction of the first time step
+  #ifndef CUDA
+  if (l_overlapReduction) {
+    #ifdef MPI_DIMSPLIT
+    l_dimensionalSplittingBlock->computeMaxTimestep(l_dimensionalSplittingBlock->getMaxCellSpeedHorizontal(),
+                                                    l_dimensionalSplittingBlock->getMaxCellSpeedVertical());
+    l_timeStepReduction.start(l_dimensionalSplittingBlock->getMaxTimestep());
+    #else
+    l_timeStepReduction.start(l_waveBlock.predictMaxTimestep());
+    #endif
+  }
+  #endif
 
   // Init fancy progressbar
   tools::ProgressBar progressBar(l_endSimulation, l_mpiRank);
@@ -392,7 +635,7 @@ int main( int argc, char** argv ) {
 
   std::string l_fileName = generateBaseFileName(l_baseName,l_blockPositionX,l_blockPositionY);
   //boundary size of the ghost layers
-  io::BoundarySize l_boundarySize = {{1, 1, 1, 1}};
+  io::BoundarySize l_boundarySize = {{l_ghostWidth, l_ghostWidth, l_ghostWidth, l_ghostWidth}};
 #ifdef WRITENETCDF
   //construct a NetCdfWriter
   io::NetCdfWriter l_writer( l_fileName,
@@ -437,23 +680,59 @@ int main( int argc, char** argv ) {
       //reset CPU-Communication clock
       tools::Logger::logger.resetClockToCurrentTime("CpuCommunication");
 
-      // exchange ghost and copy layers
-      exchangeLeftRightGhostLayers( l_leftNeighborRank,  l_leftInflow,  l_leftOutflow,
-                      l_rightNeighborRank, l_rightInflow, l_rightOutflow,
-                      l_mpiCol );
+      #ifdef MPI_DIMSPLIT
+      //! time step width of all blocks.
+      float l_maxTimeStepWidthGlobal =
+        simulateTimeStepDimensionalSplitting(*l_dimensionalSplittingBlock, *l_ghostLayerExchange, l_fusedSweeps,
+                                             l_overlapReduction ? &l_timeStepReduction : NULL, l_exceededTimeSteps);
+
+      // update the CPU-communication time in the logger
+      tools::Logger::logger.updateTime("CpuCommunication");
+      #else
+      if (l_blockingExchange) {
+        // exchange ghost and copy layers, the deeper ghost layers stay valid for l_ghostWidth time steps
+        if (l_iterations % l_ghostWidth == 0) {
+          l_ghostLayerExchange->start();
+          l_ghostLayerExchange->wait();
+        }
 
-      exchangeBottomTopGhostLayers( l_bottomNeighborRank, l_bottomInflow, l_bottomOutflow,
-                      l_topNeighborRank,    l_topInflow,    l_topOutflow,
-                      l_mpiRow );
+        // reset the cpu clock
+        tools::Logger::logger.resetClockToCurrentTime("Cpu");
 
-      // reset the cpu clock
-      tools::Logger::logger.resetClockToCurrentTime("Cpu");
+        // set values in ghost cells
+        l_waveBlock.setGhostLayer();
+
+        // compute numerical flux on each edge
+        l_waveBlock.computeNumericalFluxes();
+      } else {
+        // start the exchange of the ghost and copy layers
+        l_ghostLayerExchange->start();
+
+        // reset the cpu clocks
+        tools::Logger::logger.resetClockToCurrentTime("Cpu");
+        tools::Logger::logger.resetClockToCurrentTime("CpuOverlap");
+
+        // compute numerical flux on the edges, which do not need the ghost layers, while the messages are in flight
+        l_waveBlock.computeNumericalFluxesInterior();
+
+        // update the cpu time in the logger
+        tools::Logger::logger.updateTime("Cpu");
+        tools::Logger::logger.updateTime("CpuOverlap");
+
+        // wait for the ghost layers, the communication, which is not hidden behind the interior edges
+        tools::Logger::logger.resetClockToCurrentTime("CommunicationWait");
+        l_ghostLayerExchange->wait();
+        tools::Logger::logger.updateTime("CommunicationWait");
 
-      // set values in ghost cells
-      l_waveBlock.setGhostLayer();
+        // reset the cpu clock
+        tools::Logger::logger.resetClockToCurrentTime("Cpu");
 
-      // compute numerical flux on each edge
-      l_waveBlock.computeNumericalFluxes();
+        // set values in ghost cells
+        l_waveBlock.setGhostLayer();
+
+        // compute numerical flux on the remaining edges
+        l_waveBlock.computeNumericalFluxesBoundary();
+      }
 
       //! maximum allowed time step width within a block.
       float l_maxTimeStepWidth = l_waveBlock.getMaxTimestep();
@@ -464,8 +743,19 @@ int main( int argc, char** argv ) {
       //! maximum allowed time steps of all blocks
       float l_maxTimeStepWidthGlobal;
 
-      // determine smallest time step of all blocks
-      MPI_Allreduce(&l_maxTimeStepWidth, &l_maxTimeStepWidthGlobal, 1, MPI_FLOAT, MPI_MIN, MPI_COMM_WORLD);
+      if (l_overlapReduction) {
+        // wait for the time step, which was predicted at the end of the previous time step
+        tools::Logger::logger.resetClockToCurrentTime("TimeStepWait");
+        l_maxTimeStepWidthGlobal = l_timeStepReduction.wait();
+        tools::Logger::logger.updateTime("TimeStepWait");
+
+        // the prediction bounds the wave speeds of the edges, check it
+        if (l_maxTimeStepWidthGlobal > l_maxTimeStepWidth)
+          l_exceededTimeSteps++;
+      } else {
+        // determine smallest time step of all blocks
+        MPI_Allreduce(&l_maxTimeStepWidth, &l_maxTimeStepWidthGlobal, 1, MPI_FLOAT, MPI_MIN, MPI_COMM_WORLD);
+      }
 
       // reset the cpu time
       tools::Logger::logger.resetClockToCurrentTime("Cpu");
@@ -473,9 +763,16 @@ int main( int argc, char** argv ) {
       // update the cell values
       l_waveBlock.updateUnknowns(l_maxTimeStepWidthGlobal);
 
+      #ifndef CUDA
+      // predict the next time step from the updated cells, it is reduced during the next fluxes
+      if (l_overlapReduction)
+        l_timeStepReduction.start(l_waveBlock.predictMaxTimestep());
+      #endif
+
       // update the cpu and CPU-communication time in the logger
       tools::Logger::logger.updateTime("Cpu");
       tools::Logger::logger.updateTime("CpuCommunication");
+      #endif
 
       // update simulation time with time step width.
       l_t += l_maxTimeStepWidthGlobal;
@@ -518,6 +815,19 @@ int main( int argc, char** argv ) {
   // print CPU + Communication time
   tools::Logger::logger.printTime("CpuCommunication", "CPU + Communication time");
 
+  // print the part of the CPU time, which overlapped the exchange of the ghost layers, and the remaining wait time
+  if (!l_blockingExchange && l_iterations > 0) {
+    tools::Logger::logger.printTime("CpuOverlap", "CPU time overlapped with communication");
+    tools::Logger::logger.printTime("CommunicationWait", "Communication wait time");
+  }
+
+  // print the time, which the reduction of the predicted time steps was not hidden behind the computation
+  if (l_overlapReduction && l_iterations > 0) {
+    tools::Logger::logger.printTime("TimeStepWait", "Time step reduction wait time");
+    tools::Logger::logger.cout() << "time steps, in which the predicted time step exceeded the one of the edges: "
+                                 << l_exceededTimeSteps << std::endl;
+  }
+
   // print the wall clock time (includes plotting)
   tools::Logger::logger.printWallClockTime(time(NULL));
 
@@ -527,98 +837,16 @@ int main( int argc, char** argv ) {
   // print the finish message
   tools::Logger::logger.printFinishMessage();
 
-  // finalize MPI execution
+  // complete the reduction of the time step after the last one
+  l_timeStepReduction.wait();
+
+  // free the persistent requests and finalize MPI execution
+  delete l_ghostLayerExchange;
+  #ifdef MPI_DIMSPLIT
+  delete l_block;
+  #endif
   MPI_Finalize();
 
   return 0;
 }
 
-
-/**
- * Exchanges the left and right ghost layers with MPI's SendReceive.
- *
- * @param i_leftNeighborRank MPI rank of the  left neighbor.
- * @param o_leftInflow ghost layer, where the left neighbor writes into.
- * @param i_leftOutflow layer where the left neighbor reads from.
- * @param i_rightNeighborRank MPI rank of the right neighbor.
- * @param o_rightInflow ghost layer, where the right neighbor writes into.
- * @param i_rightOutflow layer, where the right neighbor reads form.
- * @param i_mpiCol MPI data type for the vertical gost layers.
- */
-void exchangeLeftRightGhostLayers( const int i_leftNeighborRank,  SWE_Block1D* o_leftInflow,  SWE_Block1D* i_leftOutflow,
-                                   const int i_rightNeighborRank, SWE_Block1D* o_rightInflow, SWE_Block1D* i_rightOutflow,
-                                   MPI_Datatype i_mpiCol) {
-
-  MPI_Status l_status;
-
-  // send to left, receive from the right:
-  MPI_Sendrecv( i_leftOutflow->h.elemVector(), 1, i_mpiCol, i_leftNeighborRank,  1,
-                o_rightInflow->h.elemVector(), 1, i_mpiCol, i_rightNeighborRank, 1,
-                MPI_COMM_WORLD, &l_status );
-
-  MPI_Sendrecv( i_leftOutflow->hu.elemVector(), 1, i_mpiCol, i_leftNeighborRank,  2,
-                o_rightInflow->hu.elemVector(), 1, i_mpiCol, i_rightNeighborRank, 2,
-                MPI_COMM_WORLD, &l_status );
-
-  MPI_Sendrecv( i_leftOutflow->hv.elemVector(), 1, i_mpiCol, i_leftNeighborRank,  3,
-                o_rightInflow->hv.elemVector(), 1, i_mpiCol, i_rightNeighborRank, 3,
-                MPI_COMM_WORLD, &l_status );
-
-  // send to right, receive from the left:
-  MPI_Sendrecv( i_rightOutflow->h.elemVector(), 1, i_mpiCol, i_rightNeighborRank, 4,
-                o_leftInflow->h.elemVector(),   1, i_mpiCol, i_leftNeighborRank,  4,
-                MPI_COMM_WORLD, &l_status );
-
-  MPI_Sendrecv( i_rightOutflow->hu.elemVector(), 1, i_mpiCol, i_rightNeighborRank, 5,
-                o_leftInflow->hu.elemVector(),   1, i_mpiCol, i_leftNeighborRank,  5,
-                MPI_COMM_WORLD, &l_status);
-
-  MPI_Sendrecv( i_rightOutflow->hv.elemVector(), 1, i_mpiCol, i_rightNeighborRank, 6,
-                o_leftInflow->hv.elemVector(),   1, i_mpiCol, i_leftNeighborRank,  6,
-                MPI_COMM_WORLD, &l_status );
-
-}
-
-/**
- * Exchanges the bottom and top ghost layers with MPI's SendReceive.
- *
- * @param i_bottomNeighborRank MPI rank of the bottom neighbor.
- * @param o_bottomNeighborInflow ghost layer, where the bottom neighbor writes into.
- * @param i_bottomNeighborOutflow host layer, where the bottom neighbor reads from.
- * @param i_topNeighborRank MPI rank of the top neighbor.
- * @param o_topNeighborInflow ghost layer, where the top neighbor writes into.
- * @param i_topNeighborOutflow ghost layer, where the top neighbor reads from.
- * @param i_mpiRow MPI data type for the horizontal ghost layers.
- */
-void exchangeBottomTopGhostLayers( const int i_bottomNeighborRank, SWE_Block1D* o_bottomNeighborInflow, SWE_Block1D* i_bottomNeighborOutflow,
-                                   const int i_topNeighborRank,    SWE_Block1D* o_topNeighborInflow,    SWE_Block1D* i_topNeighborOutflow,
-                                   const MPI_Datatype i_mpiRow) {
-  MPI_Status l_status;
-
-  // send to bottom, receive from the top:
-  MPI_Sendrecv( i_bottomNeighborOutflow->h.elemVector(), 1, i_mpiRow, i_bottomNeighborRank, 11,
-                o_topNeighborInflow->h.elemVector(),     1, i_mpiRow, i_topNeighborRank,11,
-                MPI_COMM_WORLD, &l_status );
-
-  MPI_Sendrecv( i_bottomNeighborOutflow->hu.elemVector(), 1, i_mpiRow, i_bottomNeighborRank, 12,
-                o_topNeighborInflow->hu.elemVector(),     1, i_mpiRow, i_topNeighborRank,    12,
-                MPI_COMM_WORLD, &l_status );
-
-  MPI_Sendrecv( i_bottomNeighborOutflow->hv.elemVector(), 1, i_mpiRow, i_bottomNeighborRank, 13,
-                o_topNeighborInflow->hv.elemVector(),     1, i_mpiRow, i_topNeighborRank, 13,
-                MPI_COMM_WORLD, &l_status);
-
-  // send to top, receive from the bottom:
-  MPI_Sendrecv( i_topNeighborOutflow->h.elemVector(),   1, i_mpiRow, i_topNeighborRank,    14,
-                o_bottomNeighborInflow->h.elemVector(), 1, i_mpiRow, i_bottomNeighborRank, 14,
-                MPI_COMM_WORLD, &l_status );
-
-  MPI_Sendrecv( i_topNeighborOutflow->hu.elemVector(),   1, i_mpiRow, i_topNeighborRank, 15,
-                o_bottomNeighborInflow->hu.elemVector(), 1, i_mpiRow, i_bottomNeighborRank, 15,
-                MPI_COMM_WORLD, &l_status );
-
-  MPI_Sendrecv( i_topNeighborOutflow->hv.elemVector(),   1, i_mpiRow, i_topNeighborRank,    16,
-                o_bottomNeighborInflow->hv.elemVector(), 1, i_mpiRow, i_bottomNeighborRank, 16,
-                MPI_COMM_WORLD, &l_status );
-
-}
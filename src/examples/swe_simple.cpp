@@ -229,40 +229,19 @@ int main( int argc, char** argv ) {
   // loop over checkpoints
   for(int c=1; c<=l_numberOfCheckPoints; c++) {
 
-    // do time steps until next checkpoint is reached
-    while( l_t < l_checkPoints[c] ) {
-      // set values in ghost cells:
-      l_wavePropgationBlock.setGhostLayer();
-      
-      // reset the cpu clock
-      tools::Logger::logger.resetClockToCurrentTime("Cpu");
-
-      // approximate the maximum time step
-      // TODO: This calculation should be replaced by the usage of the wave speeds occuring during the flux computation
-      // Remark: The code is executed on the CPU, therefore a "valid result" depends on the CPU-GPU-synchronization.
-//      l_wavePropgationBlock.computeMaxTimestep();
-
-      // compute numerical flux on each edge
-      l_wavePropgationBlock.computeNumericalFluxes();
-
-      //! maximum allowed time step width.
-      float l_maxTimeStepWidth = l_wavePropgationBlock.getMaxTimestep();
-
-      // update the cell values
-      l_wavePropgationBlock.updateUnknowns(l_maxTimeStepWidth);
-
-      // update the cpu time in the logger
-      tools::Logger::logger.updateTime("Cpu");
-
-      // update simulation time with time step width.
-      l_t += l_maxTimeStepWidth;
-      l_iterations++;
-
-      // print the current simulation time
-      progressBar.clear();
-      tools::Logger::logger.printSimulationTime(l_t);
-      progressBar.update(l_t);
-    }
+    // reset the cpu clock
+    tools::Logger::logger.resetClockToCurrentTime("Cpu");
+
+    // do time steps until next checkpoint is reached, the block returns only at the checkpoint
+    l_iterations += l_wavePropgationBlock.advance(l_t, l_checkPoints[c]);
+
+    // update the cpu time in the logger
+    tools::Logger::logger.updateTime("Cpu");
+
+    // print the current simulation time
+    progressBar.clear();
+    tools::Logger::logger.printSimulationTime(l_t);
+    progressBar.update(l_t);
 
     // print current simulation time of the output
     progressBar.clear();
@@ -0,0 +1,176 @@
+/**
+ * @file Autotuner.hh
+ * @brief Selects the fastest configuration of a block by timing a few time steps
+ *
+ * The candidates are timed on the actual scenario, so the selection accounts for
+ * the host and the grid. The winner is cached per host, grid and solver in a small
+ * text file, later runs with the same key read it instead of tuning again.
+ * Every line of the cache file is "<key> <block type> <tile size> <threads> <seconds per step>".
+ */
+
+#ifndef _SWE_AUTOTUNER_HH
+#define _SWE_AUTOTUNER_HH
+
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+#include "tools/Logger.hh"
+
+namespace tools
+{
+
+/**
+ * @brief Searches the thread count, the tile size and the block type one after another
+ *
+ * Starting with the first candidate of each parameter, every parameter is set to the
+ * fastest of its candidates, while the others keep their best value so far.
+ * This needs the sum instead of the product of the candidate counts of timings.
+ */
+class Autotuner
+{
+  public:
+    /**
+     * @brief A configuration of the block
+     */
+    struct Configuration
+    {
+      //! Name of the block type, see blocks::createBlock()
+      std::string blockType;
+      //! Edge length of the tiles of the activity mask
+      int tileSize;
+      //! Amount of parallel threads
+      int numThreads;
+    };
+
+  private:
+    //! Path of the cache file
+    std::string cacheFile;
+    //! Key of the host, grid and solver
+    std::string key;
+
+  public:
+    /**
+     * @brief Constructor
+     *
+     * @param i_cacheFile Path of the cache file, it is created by the first store()
+     * @param i_key Key of the grid and the solver, without white space, the host name is prepended
+     */
+    Autotuner(const std::string& i_cacheFile, const std::string& i_key) :
+      cacheFile(i_cacheFile), key(getHostName() + "/" + i_key) {}
+
+    /**
+     * @brief Reads the configuration of the key from the cache file
+     *
+     * @param o_configuration The cached configuration
+     * @return Wether the cache file has an entry for the key, the last one is used
+     */
+    bool lookup(Configuration& o_configuration) const {
+      std::ifstream l_file(cacheFile.c_str());
+      std::string l_line;
+      bool l_found = false;
+      while (std::getline(l_file, l_line)) {
+        std::istringstream l_stream(l_line);
+        std::string l_key;
+        Configuration l_configuration;
+        if ((l_stream >> l_key >> l_configuration.blockType >> l_configuration.tileSize >> l_configuration.numThreads)
+            && l_key == key) {
+          o_configuration = l_configuration;
+          l_found = true;
+        }
+      }
+      return l_found;
+    }
+
+    /**
+     * @brief Appends the configuration of the key to the cache file
+     *
+     * @param i_configuration The configuration
+     * @param i_secondsPerStep Its measured time per step, only for information
+     */
+    void store(const Configuration& i_configuration, double i_secondsPerStep) const {
+      std::ofstream l_file(cacheFile.c_str(), std::ios::app);
+      l_file << key << " " << i_configuration.blockType << " " << i_configuration.tileSize
+        << " " << i_configuration.numThreads << " " << i_secondsPerStep << std::endl;
+      if (!l_file)
+        Logger::logger.printString("Could not write the autotuning cache file " + cacheFile + "\n");
+    }
+
+    /**
+     * @brief Searches the fastest configuration
+     *
+     * @param i_blockTypes Candidates of the block type
+     * @param i_tileSizes Candidates of the tile size
+     * @param i_threadCounts Candidates of the thread count
+     * @param i_measure Functor, which returns the seconds per time step of a configuration,
+     *        or infinity if the configuration is not available
+     * @param o_secondsPerStep The seconds per time step of the fastest configuration
+     * @return The fastest configuration
+     */
+    template <class Measure>
+    static Configuration tune(const std::vector<std::string>& i_blockTypes, const std::vector<int>& i_tileSizes,
+        const std::vector<int>& i_threadCounts, Measure i_measure, double& o_secondsPerStep) {
+      Configuration l_best = { i_blockTypes.front(), i_tileSizes.front(), i_threadCounts.front() };
+      o_secondsPerStep = std::numeric_limits<double>::infinity();
+
+      // the thread count has the largest effect, it is searched first
+      for (unsigned int i = 0; i < i_threadCounts.size(); i++) {
+        Configuration l_candidate = l_best;
+        l_candidate.numThreads = i_threadCounts[i];
+        timeCandidate(l_candidate, i_measure, l_best, o_secondsPerStep);
+      }
+      for (unsigned int i = 0; i < i_tileSizes.size(); i++) {
+        Configuration l_candidate = l_best;
+        l_candidate.tileSize = i_tileSizes[i];
+        if (l_candidate.tileSize != l_best.tileSize)
+          timeCandidate(l_candidate, i_measure, l_best, o_secondsPerStep);
+      }
+      for (unsigned int i = 0; i < i_blockTypes.size(); i++) {
+        Configuration l_candidate = l_best;
+        l_candidate.blockType = i_blockTypes[i];
+        if (l_candidate.blockType != l_best.blockType)
+          timeCandidate(l_candidate, i_measure, l_best, o_secondsPerStep);
+      }
+      return l_best;
+    }
+
+    /**
+     * @brief Name of the host, "unknown" if it is not available
+     */
+    static std::string getHostName() {
+      char l_name[256];
+      if (gethostname(l_name, sizeof(l_name)) != 0)
+        return "unknown";
+      l_name[sizeof(l_name) - 1] = '\0';
+      return l_name;
+    }
+
+  private:
+    /**
+     * @brief Times a candidate and keeps it, if it is faster than the best configuration
+     */
+    template <class Measure>
+    static void timeCandidate(const Configuration& i_candidate, Measure& i_measure,
+        Configuration& io_best, double& io_secondsPerStep) {
+      const double l_secondsPerStep = i_measure(i_candidate);
+      std::ostringstream l_message;
+      l_message << "Autotuning: " << i_candidate.blockType << ", tile size " << i_candidate.tileSize
+        << ", " << i_candidate.numThreads << " threads: ";
+      if (l_secondsPerStep == std::numeric_limits<double>::infinity())
+        l_message << "not available\n";
+      else
+        l_message << l_secondsPerStep << " s per time step\n";
+      Logger::logger.printString(l_message.str());
+      if (l_secondsPerStep < io_secondsPerStep) {
+        io_best = i_candidate;
+        io_secondsPerStep = l_secondsPerStep;
+      }
+    }
+};
+
+}
+
+#endif
@@ -0,0 +1,57 @@
+/**
+ * @file FastMath.hh
+ * @brief Approximations of the square roots and divisions in the CPU kernels
+ *
+ * The fast numerical mode is selected by the build variable fastMath, which defines FAST_MATH.
+ * The kernels then replace sqrt(x) and 1/x of their positive quantities (depths and celerities)
+ * by a reciprocal square root: sqrt(x) = x * rsqrt(x) and 1/x = rsqrt(x)^2.
+ * Without FAST_MATH, the kernels are unchanged and give the same results as before.
+ */
+
+#ifndef _SWE_FAST_MATH_HH
+#define _SWE_FAST_MATH_HH
+
+#include <cstring>
+#include <stdint.h>
+
+namespace fastmath
+{
+
+#ifdef FAST_MATH
+    //! Whether the kernels use the approximations
+    const bool enabled = true;
+#else
+    //! Whether the kernels use the approximations
+    const bool enabled = false;
+#endif
+
+    /**
+     * @brief Relative error bound of rsqrt() for every positive normal float
+     */
+    const float rsqrtTolerance = 5e-6f;
+
+    /**
+     * @brief Approximation of 1/sqrt(x) for x > 0
+     *
+     * An initial guess from the bit pattern of x, improved by two Newton steps,
+     * which only multiply and add. The function has no branches and no table,
+     * so the loops calling it are vectorized. The relative error is below rsqrtTolerance.
+     * For x = 0 the result is large but finite, so 0 * rsqrt(0) = 0.
+     */
+    inline float rsqrt(float x)
+    {
+        uint32_t l_bits;
+        std::memcpy(&l_bits, &x, sizeof(l_bits));
+        l_bits = 0x5f375a86u - (l_bits >> 1);
+        float y;
+        std::memcpy(&y, &l_bits, sizeof(y));
+
+        const float halfX = 0.5f * x;
+        y = y * (1.5f - halfX * y * y);
+        y = y * (1.5f - halfX * y * y);
+        return y;
+    }
+
+}
+
+#endif
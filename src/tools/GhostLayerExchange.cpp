@@ -0,0 +1,152 @@
+/**
+ * @file GhostLayerExchange.cpp
+ * @brief Implements the exchange of the ghost layers defined in GhostLayerExchange.hh
+ */
+
+#include "GhostLayerExchange.hh"
+
+tools::GhostLayerExchange::GhostLayerExchange(SWE_Block& i_block, const int i_neighbourRanks[4]) :
+  ghostWidth(i_block.getGhostWidth())
+{
+  for (int e = 0; e < 4; e++)
+  {
+    Edge& l_edge = edges[e];
+    l_edge.neighbourRank = i_neighbourRanks[e];
+    // the left and right layers are exchanged without the inner bottom and top ghost layers,
+    // the bottom and top layers include the inner left and right ghost layers, i.e. the corners
+    if (e == BND_LEFT || e == BND_RIGHT)
+    {
+      l_edge.begin = ghostWidth;
+      l_edge.size = i_block.getNy() - 2 * (ghostWidth - 1);
+    }
+    else
+    {
+      l_edge.begin = 1;
+      l_edge.size = i_block.getNx();
+    }
+    requests[e][0] = requests[e][1] = MPI_REQUEST_NULL;
+    if (l_edge.neighbourRank == MPI_PROC_NULL)
+      continue;
+
+    // the layer next to the cells is grabbed by the virtual methods, which other block types override
+    const BoundaryEdge l_boundaryEdge = (BoundaryEdge) e;
+    l_edge.ghostLayers.push_back(i_block.grabGhostLayer(l_boundaryEdge));
+    l_edge.copyLayers.push_back(i_block.registerCopyLayer(l_boundaryEdge));
+    for (int d = 1; d < ghostWidth; d++)
+    {
+      l_edge.ghostLayers.push_back(i_block.grabGhostLayer(l_boundaryEdge, d));
+      l_edge.copyLayers.push_back(i_block.registerCopyLayer(l_boundaryEdge, d));
+    }
+
+    const int l_layerSize = 3 * l_edge.size;
+    l_edge.sendBuffer.resize(l_layerSize * ghostWidth);
+    l_edge.receiveBuffer.resize(l_layerSize * ghostWidth);
+
+    // the tag is the edge of the sender, the neighbour receives at the opposite edge (left <-> right, bottom <-> top)
+    const int l_count = l_layerSize * ghostWidth;
+    MPI_Recv_init(&l_edge.receiveBuffer[0], l_count, MPI_FLOAT, l_edge.neighbourRank, e ^ 1, MPI_COMM_WORLD, &requests[e][0]);
+    MPI_Send_init(&l_edge.sendBuffer[0],    l_count, MPI_FLOAT, l_edge.neighbourRank, e,     MPI_COMM_WORLD, &requests[e][1]);
+  }
+}
+
+tools::GhostLayerExchange::~GhostLayerExchange()
+{
+  for (int e = 0; e < 4; e++)
+    for (int r = 0; r < 2; r++)
+      if (requests[e][r] != MPI_REQUEST_NULL)
+        MPI_Request_free(&requests[e][r]);
+
+  for (int e = 0; e < 4; e++)
+    for (size_t d = 0; d < edges[e].ghostLayers.size(); d++)
+    {
+      delete edges[e].ghostLayers[d];
+      delete edges[e].copyLayers[d];
+    }
+}
+
+void tools::GhostLayerExchange::start()
+{
+  startLeftRight();
+  // the corners of deeper ghost layers are sent on with the bottom and top layers
+  if (ghostWidth > 1)
+    waitLeftRight();
+  startBottomTop();
+}
+
+void tools::GhostLayerExchange::wait()
+{
+  if (ghostWidth == 1)
+    waitLeftRight();
+  waitBottomTop();
+}
+
+void tools::GhostLayerExchange::start(int i_edge)
+{
+  // post the receives first, so the messages of the neighbours need not be buffered
+  for (int e = i_edge; e < i_edge + 2; e++)
+    if (edges[e].neighbourRank != MPI_PROC_NULL)
+      MPI_Start(&requests[e][0]);
+
+  for (int e = i_edge; e < i_edge + 2; e++)
+  {
+    Edge& l_edge = edges[e];
+    if (l_edge.neighbourRank == MPI_PROC_NULL)
+      continue;
+    // the layer of depth d is sent to the ghost layer of depth d of the neighbour
+    for (int d = 0; d < ghostWidth; d++)
+      pack(*l_edge.copyLayers[d], l_edge.begin, l_edge.size, &l_edge.sendBuffer[3 * l_edge.size * d]);
+    MPI_Start(&requests[e][1]);
+  }
+}
+
+void tools::GhostLayerExchange::wait(int i_edge)
+{
+  // the requests of both edges, completed persistent requests stay allocated for the next start
+  MPI_Waitall(4, &requests[i_edge][0], MPI_STATUSES_IGNORE);
+
+  for (int e = i_edge; e < i_edge + 2; e++)
+  {
+    Edge& l_edge = edges[e];
+    for (size_t d = 0; d < l_edge.ghostLayers.size(); d++)
+      unpack(&l_edge.receiveBuffer[3 * l_edge.size * d], l_edge.begin, l_edge.size, *l_edge.ghostLayers[d]);
+  }
+}
+
+void tools::GhostLayerExchange::pack(SWE_Block1D& i_layer, int i_begin, int i_size, float* o_buffer)
+{
+  // a column is contiguous, a row has the stride of the columns: the loop gathers the three fields at once
+  const int l_stride = i_layer.h.getStride();
+  const float* l_h  = i_layer.h.elemVector() + i_begin * l_stride;
+  const float* l_hu = i_layer.hu.elemVector() + i_begin * l_stride;
+  const float* l_hv = i_layer.hv.elemVector() + i_begin * l_stride;
+  float* l_bufferH  = o_buffer;
+  float* l_bufferHu = o_buffer + i_size;
+  float* l_bufferHv = o_buffer + 2 * i_size;
+
+  #pragma omp simd
+  for (int k = 0; k < i_size; k++)
+  {
+    l_bufferH[k]  = l_h[k * l_stride];
+    l_bufferHu[k] = l_hu[k * l_stride];
+    l_bufferHv[k] = l_hv[k * l_stride];
+  }
+}
+
+void tools::GhostLayerExchange::unpack(const float* i_buffer, int i_begin, int i_size, SWE_Block1D& o_layer)
+{
+  const int l_stride = o_layer.h.getStride();
+  float* l_h  = o_layer.h.elemVector() + i_begin * l_stride;
+  float* l_hu = o_layer.hu.elemVector() + i_begin * l_stride;
+  float* l_hv = o_layer.hv.elemVector() + i_begin * l_stride;
+  const float* l_bufferH  = i_buffer;
+  const float* l_bufferHu = i_buffer + i_size;
+  const float* l_bufferHv = i_buffer + 2 * i_size;
+
+  #pragma omp simd
+  for (int k = 0; k < i_size; k++)
+  {
+    l_h[k * l_stride]  = l_bufferH[k];
+    l_hu[k * l_stride] = l_bufferHu[k];
+    l_hv[k * l_stride] = l_bufferHv[k];
+  }
+}
@@ -0,0 +1,116 @@
+/**
+ * @file GhostLayerExchange.hh
+ * @brief Exchanges the ghost layers of a block with the blocks of the neighbouring MPI ranks
+ *
+ * A rank sends one message per neighbour and step, which carries the copy layers of h, hu and hv.
+ * The layers are packed into contiguous buffers, which are allocated once,
+ * and the messages are persistent requests (MPI_Send_init(), MPI_Recv_init()),
+ * so a step only starts and completes them. With small blocks, the exchange is dominated
+ * by the latency of the messages: this sends 4 messages per step instead of 12.
+ *
+ * With ghost layers of depth k (see SWE_Block::getGhostWidth()), a message carries all k layers,
+ * and the driver exchanges them only every k time steps.
+ */
+
+#ifndef _SWE_GHOST_LAYER_EXCHANGE_HH
+#define _SWE_GHOST_LAYER_EXCHANGE_HH
+
+#include <mpi.h>
+#include <vector>
+
+#include "blocks/SWE_Block.hh"
+
+namespace tools
+{
+
+/**
+ * @brief Persistent messages of the ghost layers of the four edges of a block
+ *
+ * The left/right and the bottom/top layers are exchanged separately, so the steps of
+ * a dimensional splitting can exchange only the layers they need.
+ * The corners of the ghost layers are not exchanged, they are not used by the computation with a single layer.
+ * Deeper ghost layers need the corners: the bottom and top layers span the inner left and right ghost layers,
+ * so start() completes the left/right exchange before it sends them.
+ * Between the start and the end of an exchange, the copy layers must not be written
+ * and the ghost layers must not be read.
+ */
+class GhostLayerExchange
+{
+  private:
+    //! Layers and messages of one edge of the block
+    struct Edge
+    {
+      //! MPI rank of the neighbour, MPI_PROC_NULL at the boundary of the domain
+      int neighbourRank;
+      //! Ghost layers by depth, which are received from the neighbour
+      std::vector<SWE_Block1D*> ghostLayers;
+      //! Copy layers by depth, which are sent to the neighbour
+      std::vector<SWE_Block1D*> copyLayers;
+      //! First exchanged cell of a layer
+      int begin;
+      //! Exchanged cells of a layer
+      int size;
+      //! Packed copy layers of h, hu and hv
+      std::vector<float> sendBuffer;
+      //! Packed ghost layers of h, hu and hv
+      std::vector<float> receiveBuffer;
+    };
+
+    //! Depth of the ghost layers
+    int ghostWidth;
+    Edge edges[4];
+    //! Persistent receive and send request of every edge, MPI_REQUEST_NULL without neighbour
+    MPI_Request requests[4][2];
+
+    //! Starts the messages of the edges i_edge and i_edge+1
+    void start(int i_edge);
+    //! Completes the messages of the edges i_edge and i_edge+1 and unpacks the ghost layers
+    void wait(int i_edge);
+
+    /**
+     * @brief Copies the cells [begin, begin+size) of h, hu and hv of a layer one after another into a buffer
+     */
+    static void pack(SWE_Block1D& i_layer, int i_begin, int i_size, float* o_buffer);
+
+    /**
+     * @brief Copies a packed buffer into the cells [begin, begin+size) of h, hu and hv of a layer
+     */
+    static void unpack(const float* i_buffer, int i_begin, int i_size, SWE_Block1D& o_layer);
+
+    GhostLayerExchange(const GhostLayerExchange&);
+    GhostLayerExchange& operator=(const GhostLayerExchange&);
+
+  public:
+    /**
+     * @brief Grabs the ghost layers of the edges with a neighbour, allocates the buffers and creates the persistent requests
+     *
+     * The boundary conditions of the edges without neighbour have to be set by the caller.
+     *
+     * @param i_block Block, whose ghost layers are exchanged
+     * @param i_neighbourRanks MPI ranks of the neighbours indexed by BoundaryEdge, MPI_PROC_NULL without neighbour
+     */
+    GhostLayerExchange(SWE_Block& i_block, const int i_neighbourRanks[4]);
+
+    /**
+     * @brief Frees the persistent requests and the layer proxies, no exchange may be in progress
+     */
+    ~GhostLayerExchange();
+
+    //! Starts the exchange of the left and right ghost layers
+    void startLeftRight() { start(BND_LEFT); }
+    //! Completes the exchange of the left and right ghost layers
+    void waitLeftRight() { wait(BND_LEFT); }
+    //! Starts the exchange of the bottom and top ghost layers
+    void startBottomTop() { start(BND_BOTTOM); }
+    //! Completes the exchange of the bottom and top ghost layers
+    void waitBottomTop() { wait(BND_BOTTOM); }
+
+    //! Starts the exchange of all ghost layers
+    void start();
+    //! Completes the exchange of all ghost layers
+    void wait();
+};
+
+}
+
+#endif
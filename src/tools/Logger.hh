@@ -343,6 +343,41 @@ class tools::Logger {
       }
     }
 
+    /**
+     * Print the number of cells skipped in the current time step.
+     * (process rank 0 only)
+     *
+     * @param i_skippedCells number of skipped cells.
+     * @param i_numberOfCells total number of cells.
+     */
+    void printSkippedCells( const long i_skippedCells,
+                            const long i_numberOfCells ) {
+      if(processRank == 0) {
+        timeCout() << indentation
+                   << "Skipped cells: " << i_skippedCells << " of " << i_numberOfCells
+                   << " (" << 100. * i_skippedCells / i_numberOfCells << "%)" << std::endl;
+      }
+    }
+
+    /**
+     * Print the number of cells skipped in several time steps, in total and per time step.
+     * (process rank 0 only)
+     *
+     * @param i_skippedCells number of skipped cells, summed over the time steps.
+     * @param i_numberOfCells total number of cells.
+     * @param i_timeSteps number of time steps.
+     */
+    void printSkippedCells( const long i_skippedCells,
+                            const long i_numberOfCells,
+                            const int i_timeSteps ) {
+      if(processRank == 0 && i_timeSteps > 0) {
+        timeCout() << indentation
+                   << "Skipped cells: " << i_skippedCells << " of " << i_numberOfCells * i_timeSteps
+                   << " in " << i_timeSteps << " time steps (" << 100. * i_skippedCells / ((double) i_numberOfCells * i_timeSteps)
+                   << "%), " << i_skippedCells / i_timeSteps << " per time step" << std::endl;
+      }
+    }
+
     /**
      * Print the creation of an output file.
      *
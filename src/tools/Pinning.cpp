@@ -0,0 +1,183 @@
+/**
+ * @file Pinning.cpp
+ * @brief Implements the thread pinning defined in Pinning.hh
+ */
+
+#include "Pinning.hh"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#ifdef USE_OMP
+#include <omp.h>
+#endif
+
+//! Reads an integer of the topology of a CPU in sysfs, -1 if it is not available
+static int readTopology(int i_cpu, const char* i_name)
+{
+  std::ostringstream l_path;
+  l_path << "/sys/devices/system/cpu/cpu" << i_cpu << "/topology/" << i_name;
+  std::ifstream l_file(l_path.str().c_str());
+  int l_value = -1;
+  if (!(l_file >> l_value))
+    return -1;
+  return l_value;
+}
+
+std::vector<tools::Pinning::Cpu> tools::Pinning::getAvailableCpus()
+{
+  std::vector<int> l_ids;
+#ifdef __linux__
+  cpu_set_t l_set;
+  CPU_ZERO(&l_set);
+  if (sched_getaffinity(0, sizeof(l_set), &l_set) == 0)
+  {
+    for (int c = 0; c < CPU_SETSIZE; c++)
+      if (CPU_ISSET(c, &l_set))
+        l_ids.push_back(c);
+  }
+#endif
+  if (l_ids.empty())
+    l_ids.push_back(0);
+
+  //without topology information, every CPU is a core of its own on one socket
+  std::vector<Cpu> l_cpus(l_ids.size());
+  for (size_t c = 0; c < l_ids.size(); c++)
+  {
+    l_cpus[c].id = l_ids[c];
+    l_cpus[c].package = std::max(readTopology(l_ids[c], "physical_package_id"), 0);
+    l_cpus[c].core = readTopology(l_ids[c], "core_id");
+    if (l_cpus[c].core < 0)
+      l_cpus[c].core = l_ids[c];
+    l_cpus[c].smt = 0;
+    for (size_t d = 0; d < c; d++)
+      if (l_cpus[d].package == l_cpus[c].package && l_cpus[d].core == l_cpus[c].core)
+        l_cpus[c].smt++;
+  }
+  return l_cpus;
+}
+
+std::vector<int> tools::Pinning::parseList(const std::string& i_list)
+{
+  std::vector<int> l_cpus;
+  std::istringstream l_stream(i_list);
+  std::string l_item;
+  while (std::getline(l_stream, l_item, ','))
+  {
+    const size_t l_dash = l_item.find('-');
+    char* l_end;
+    const long l_first = std::strtol(l_item.c_str(), &l_end, 10);
+    long l_last = l_first;
+    if (l_end == l_item.c_str())
+      throw std::runtime_error("Invalid CPU list: " + i_list);
+    if (l_dash != std::string::npos)
+    {
+      const char* l_lastBegin = l_item.c_str() + l_dash + 1;
+      l_last = std::strtol(l_lastBegin, &l_end, 10);
+      if (l_end == l_lastBegin)
+        throw std::runtime_error("Invalid CPU list: " + i_list);
+    }
+    if (*l_end != '\0' || l_first < 0 || l_last < l_first)
+      throw std::runtime_error("Invalid CPU list: " + i_list);
+    for (long c = l_first; c <= l_last; c++)
+      l_cpus.push_back((int) c);
+  }
+  if (l_cpus.empty())
+    throw std::runtime_error("Invalid CPU list: " + i_list);
+  return l_cpus;
+}
+
+namespace
+{
+  //! Orders the cores socket by socket
+  struct CompactOrder
+  {
+    template <class Cpu>
+    bool operator()(const Cpu& a, const Cpu& b) const
+    {
+      if (a.smt != b.smt) return a.smt < b.smt;
+      if (a.package != b.package) return a.package < b.package;
+      if (a.core != b.core) return a.core < b.core;
+      return a.id < b.id;
+    }
+  };
+
+  //! Orders the cores round-robin over the sockets
+  struct ScatterOrder
+  {
+    template <class Cpu>
+    bool operator()(const Cpu& a, const Cpu& b) const
+    {
+      if (a.smt != b.smt) return a.smt < b.smt;
+      if (a.core != b.core) return a.core < b.core;
+      if (a.package != b.package) return a.package < b.package;
+      return a.id < b.id;
+    }
+  };
+}
+
+tools::Pinning::Pinning(const std::string& i_strategy, int i_numThreads) :
+  strategy(i_strategy)
+{
+  std::vector<int> l_order;
+  if (i_strategy == "compact" || i_strategy == "scatter")
+  {
+    std::vector<Cpu> l_cpus = getAvailableCpus();
+    if (i_strategy == "compact")
+      std::sort(l_cpus.begin(), l_cpus.end(), CompactOrder());
+    else
+      std::sort(l_cpus.begin(), l_cpus.end(), ScatterOrder());
+    for (size_t c = 0; c < l_cpus.size(); c++)
+      l_order.push_back(l_cpus[c].id);
+  }
+  else
+    l_order = parseList(i_strategy);
+
+  for (int t = 0; t < std::max(i_numThreads, 1); t++)
+    cpus.push_back(l_order[t % l_order.size()]);
+}
+
+std::string tools::Pinning::toString() const
+{
+  std::ostringstream l_string;
+  l_string << strategy << " (";
+  for (size_t t = 0; t < cpus.size(); t++)
+    l_string << (t > 0 ? ", " : "") << "thread " << t << ": cpu " << cpus[t];
+  l_string << ")";
+  return l_string.str();
+}
+
+bool tools::Pinning::pinOpenMPThreads() const
+{
+#ifdef USE_OMP
+  int l_failed = 0;
+  #pragma omp parallel reduction(+: l_failed)
+  if (!pinCurrentThread(cpus[omp_get_thread_num() % cpus.size()]))
+    l_failed++;
+  return l_failed == 0;
+#else
+  return pinCurrentThread(cpus[0]);
+#endif
+}
+
+bool tools::Pinning::pinCurrentThread(int i_cpu)
+{
+#ifdef __linux__
+  if (i_cpu < 0 || i_cpu >= CPU_SETSIZE)
+    return false;
+  cpu_set_t l_set;
+  CPU_ZERO(&l_set);
+  CPU_SET(i_cpu, &l_set);
+  return pthread_setaffinity_np(pthread_self(), sizeof(l_set), &l_set) == 0;
+#else
+  return false;
+#endif
+}
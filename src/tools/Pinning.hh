@@ -0,0 +1,100 @@
+/**
+ * @file Pinning.hh
+ * @brief Pins the threads of a run to fixed cores
+ *
+ * The arrays of a block are first touched column by column with a static schedule
+ * (see Array2D), so the pages of thread t are placed on the socket it runs on at that time.
+ * With pinning, thread t of OpenMP and worker t of the thread pool run on the same core
+ * for the whole run, and keep working on the columns they first touched.
+ */
+
+#ifndef _SWE_PINNING_HH
+#define _SWE_PINNING_HH
+
+#include <string>
+#include <vector>
+
+namespace tools
+{
+
+/**
+ * @brief Mapping of the threads to the logical CPUs
+ *
+ * The strategies are
+ * - compact: the cores of the first socket, then of the next one,
+ * - scatter: the sockets round-robin, so the threads share the memory bandwidth of all sockets,
+ * - a list of logical CPUs, like "0,2,4-7".
+ *
+ * compact and scatter use one hardware thread per core, before the second one of any core.
+ * They choose from the CPUs the process may run on. If there are more threads than CPUs, the CPUs are reused.
+ */
+class Pinning
+{
+  private:
+    //! A logical CPU and its place in the topology
+    struct Cpu
+    {
+      int id;
+      int package;
+      int core;
+      //! Index of the hardware thread within its core
+      int smt;
+    };
+
+    //! Strategy of the mapping, as given
+    std::string strategy;
+    //! Logical CPU of every thread
+    std::vector<int> cpus;
+
+    /**
+     * @brief Reads the CPUs, which the process may run on, and their sockets and cores
+     */
+    static std::vector<Cpu> getAvailableCpus();
+
+    /**
+     * @brief Parses a list of logical CPUs like "0,2,4-7"
+     */
+    static std::vector<int> parseList(const std::string& i_list);
+
+  public:
+    /**
+     * @brief Computes the mapping, throws std::runtime_error if the strategy is invalid
+     *
+     * Has to be called before any thread is pinned, pinned threads narrow the available CPUs.
+     *
+     * @param i_strategy compact, scatter or a list of logical CPUs
+     * @param i_numThreads Amount of threads
+     */
+    Pinning(const std::string& i_strategy, int i_numThreads);
+
+    /**
+     * @return Logical CPU of every thread
+     */
+    const std::vector<int>& getCpus() const { return cpus; }
+
+    /**
+     * @brief Describes the mapping, like "compact (thread 0: cpu 0, thread 1: cpu 1)"
+     */
+    std::string toString() const;
+
+    /**
+     * @brief Pins the thread of every OpenMP thread number to its CPU
+     *
+     * The threads of the OpenMP runtime persist, so they stay pinned for the later parallel regions
+     * with at most as many threads.
+     *
+     * @return Wether all threads were pinned
+     */
+    bool pinOpenMPThreads() const;
+
+    /**
+     * @brief Pins the calling thread to a logical CPU
+     *
+     * @return Wether the thread was pinned, pinning is supported on Linux only
+     */
+    static bool pinCurrentThread(int i_cpu);
+};
+
+}
+
+#endif
@@ -0,0 +1,158 @@
+/**
+ * @file ReducedFloat.hh
+ * @brief 16-bit floating point types for the storage of the unknowns
+ *
+ * The types only store a value: it is converted to float whenever it is read,
+ * and every arithmetic operation is done in float. Only the result is rounded
+ * (to nearest, ties to even) back to 16 bits, when it is written.
+ *
+ * The storage type of the unknowns is selected by the storage build variable:
+ * FP32 (float, the default), FP16 (Half, defines STORAGE_FP16) or BF16 (BFloat16, defines STORAGE_BF16).
+ */
+
+#ifndef _SWE_REDUCED_FLOAT_HH
+#define _SWE_REDUCED_FLOAT_HH
+
+#include <cstring>
+#include <stdint.h>
+
+#ifdef __F16C__
+#include <immintrin.h>
+#endif
+
+/**
+ * @brief IEEE 754 half precision number: 5 exponent bits and 10 mantissa bits
+ *
+ * The largest finite value is 65504, the precision is 11 bits (about 3 decimal digits).
+ * The conversion uses the F16C instructions, if the compiler is allowed to emit them.
+ */
+class Half
+{
+  public:
+    Half() {}
+
+    Half(float i_value) : bits(fromFloat(i_value)) {}
+
+    inline operator float() const { return toFloat(bits); }
+
+    inline Half& operator+=(float i_value) { bits = fromFloat(toFloat(bits) + i_value); return *this; }
+    inline Half& operator-=(float i_value) { bits = fromFloat(toFloat(bits) - i_value); return *this; }
+    inline Half& operator*=(float i_value) { bits = fromFloat(toFloat(bits) * i_value); return *this; }
+
+  private:
+    uint16_t bits;
+
+#ifdef __F16C__
+    static inline uint16_t fromFloat(float i_value) {
+      return _cvtss_sh(i_value, _MM_FROUND_TO_NEAREST_INT);
+    }
+
+    static inline float toFloat(uint16_t i_bits) {
+      return _cvtsh_ss(i_bits);
+    }
+#else
+    static inline uint16_t fromFloat(float i_value) {
+      uint32_t l_bits;
+      std::memcpy(&l_bits, &i_value, sizeof(l_bits));
+      const uint32_t l_sign = l_bits & 0x80000000u;
+      l_bits ^= l_sign;
+
+      uint32_t l_half;
+      if (l_bits >= (143u << 23)) {
+        // overflow (|value| >= 2^16) becomes infinity, NaN stays a (quiet) NaN
+        l_half = (l_bits > (255u << 23)) ? 0x7e00 : 0x7c00;
+      } else if (l_bits < (113u << 23)) {
+        // subnormal or zero: the addition aligns the mantissa and rounds it in hardware
+        const uint32_t l_magicBits = 126u << 23;
+        float l_magic, l_value;
+        std::memcpy(&l_magic, &l_magicBits, sizeof(l_magic));
+        std::memcpy(&l_value, &l_bits, sizeof(l_value));
+        l_value += l_magic;
+        std::memcpy(&l_half, &l_value, sizeof(l_half));
+        l_half -= l_magicBits;
+      } else {
+        // normal: rebias the exponent and round the mantissa to nearest even,
+        // a carry out of the mantissa correctly rounds up to the next exponent (or infinity)
+        const uint32_t l_odd = (l_bits >> 13) & 1;
+        l_bits += ((uint32_t) (15 - 127) << 23) + 0xfff + l_odd;
+        l_half = l_bits >> 13;
+      }
+      return (uint16_t) (l_half | (l_sign >> 16));
+    }
+
+    static inline float toFloat(uint16_t i_bits) {
+      const uint32_t l_exponentMask = 0x7c00u << 13;
+      uint32_t l_bits = (uint32_t) (i_bits & 0x7fff) << 13;
+      const uint32_t l_exponent = l_bits & l_exponentMask;
+      l_bits += (uint32_t) (127 - 15) << 23;
+
+      float l_value;
+      if (l_exponent == l_exponentMask) {
+        // infinity or NaN
+        l_bits += (uint32_t) (128 - 16) << 23;
+        std::memcpy(&l_value, &l_bits, sizeof(l_value));
+      } else if (l_exponent == 0) {
+        // subnormal or zero: renormalized by a subtraction
+        const uint32_t l_magicBits = 113u << 23;
+        float l_magic;
+        std::memcpy(&l_magic, &l_magicBits, sizeof(l_magic));
+        l_bits += 1u << 23;
+        std::memcpy(&l_value, &l_bits, sizeof(l_value));
+        l_value -= l_magic;
+      } else {
+        std::memcpy(&l_value, &l_bits, sizeof(l_value));
+      }
+      return (i_bits & 0x8000) ? -l_value : l_value;
+    }
+#endif
+};
+
+/**
+ * @brief Brain floating point number: the upper 16 bits of a float
+ *
+ * It has the range of a float, but only a precision of 8 bits (about 2 decimal digits).
+ */
+class BFloat16
+{
+  public:
+    BFloat16() {}
+
+    BFloat16(float i_value) : bits(fromFloat(i_value)) {}
+
+    inline operator float() const { return toFloat(bits); }
+
+    inline BFloat16& operator+=(float i_value) { bits = fromFloat(toFloat(bits) + i_value); return *this; }
+    inline BFloat16& operator-=(float i_value) { bits = fromFloat(toFloat(bits) - i_value); return *this; }
+    inline BFloat16& operator*=(float i_value) { bits = fromFloat(toFloat(bits) * i_value); return *this; }
+
+  private:
+    uint16_t bits;
+
+    static inline uint16_t fromFloat(float i_value) {
+      uint32_t l_bits;
+      std::memcpy(&l_bits, &i_value, sizeof(l_bits));
+      if ((l_bits & 0x7fffffffu) > 0x7f800000u)
+        // keep NaNs quiet, the rounding could turn them into infinity
+        return (uint16_t) ((l_bits >> 16) | 0x40);
+      // round to nearest, ties to even
+      l_bits += 0x7fffu + ((l_bits >> 16) & 1);
+      return (uint16_t) (l_bits >> 16);
+    }
+
+    static inline float toFloat(uint16_t i_bits) {
+      const uint32_t l_bits = (uint32_t) i_bits << 16;
+      float l_value;
+      std::memcpy(&l_value, &l_bits, sizeof(l_value));
+      return l_value;
+    }
+};
+
+#if defined(STORAGE_FP16)
+typedef Half StorageFloat;
+#elif defined(STORAGE_BF16)
+typedef BFloat16 StorageFloat;
+#else
+typedef float StorageFloat;
+#endif
+
+#endif
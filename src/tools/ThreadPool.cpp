@@ -0,0 +1,139 @@
+/**
+ * @file ThreadPool.cpp
+ * @brief Implements the thread pool defined in ThreadPool.hh
+ */
+
+#include "ThreadPool.hh"
+#include "Pinning.hh"
+
+//! Polls of a waiting thread for the next loop, before it sleeps on the condition variable
+static const int spinCount = 1000;
+
+tools::ThreadPool::ThreadPool(int i_numThreads, const std::vector<int>& i_cpus) :
+  numThreads(std::max(i_numThreads, 1)),
+  cpus(i_cpus),
+  queues(numThreads),
+  generation(0),
+  busyThreads(0),
+  stopping(false),
+  function(0),
+  body(0)
+{
+  if (!cpus.empty())
+    Pinning::pinCurrentThread(cpus[0]);
+  for (int w = 1; w < numThreads; w++)
+    threads.push_back(std::thread(&ThreadPool::wait, this, w));
+}
+
+tools::ThreadPool::~ThreadPool()
+{
+  {
+    std::lock_guard<std::mutex> l_lock(mutex);
+    stopping = true;
+  }
+  wakeUp.notify_all();
+  for (size_t t = 0; t < threads.size(); t++)
+    threads[t].join();
+}
+
+void tools::ThreadPool::execute(int i_numTasks, void (*i_function)(void*, int, int), void* i_body)
+{
+  if (i_numTasks <= 0)
+    return;
+  if (numThreads == 1)
+  {
+    for (int t = 0; t < i_numTasks; t++)
+      i_function(i_body, t, 0);
+    return;
+  }
+
+  //contiguous ranges, the threads are idle, so the mutex below publishes them
+  for (int w = 0; w < numThreads; w++)
+  {
+    queues[w].begin = (int) ((long) i_numTasks * w / numThreads);
+    queues[w].end = (int) ((long) i_numTasks * (w + 1) / numThreads);
+  }
+  {
+    std::lock_guard<std::mutex> l_lock(mutex);
+    function = i_function;
+    body = i_body;
+    busyThreads.store(numThreads - 1, std::memory_order_relaxed);
+    generation.fetch_add(1, std::memory_order_release);
+  }
+  wakeUp.notify_all();
+
+  work(0);
+  //the results of the other threads are visible, once they have left the loop
+  while (busyThreads.load(std::memory_order_acquire) != 0)
+    std::this_thread::yield();
+}
+
+void tools::ThreadPool::work(int i_worker)
+{
+  Queue& l_own = queues[i_worker];
+  while (true)
+  {
+    //take the next task of the own range
+    int l_task = -1;
+    {
+      std::lock_guard<std::mutex> l_lock(l_own.mutex);
+      if (l_own.begin < l_own.end)
+        l_task = l_own.begin++;
+    }
+    if (l_task >= 0)
+    {
+      function(body, l_task, i_worker);
+      continue;
+    }
+
+    //steal the back half of the range of another thread, starting with the next one
+    bool l_stolen = false;
+    for (int v = 1; v < numThreads && !l_stolen; v++)
+    {
+      Queue& l_victim = queues[(i_worker + v) % numThreads];
+      int l_begin = 0, l_end = 0;
+      {
+        std::lock_guard<std::mutex> l_lock(l_victim.mutex);
+        if (l_victim.begin < l_victim.end)
+        {
+          l_begin = l_victim.begin + (l_victim.end - l_victim.begin) / 2;
+          l_end = l_victim.end;
+          l_victim.end = l_begin;
+          l_stolen = true;
+        }
+      }
+      if (l_stolen)
+      {
+        std::lock_guard<std::mutex> l_lock(l_own.mutex);
+        l_own.begin = l_begin;
+        l_own.end = l_end;
+      }
+    }
+    //the ranges only shrink, so no task is left, if none could be stolen
+    if (!l_stolen)
+      return;
+  }
+}
+
+void tools::ThreadPool::wait(int i_worker)
+{
+  if (!cpus.empty())
+    Pinning::pinCurrentThread(cpus[i_worker % cpus.size()]);
+  unsigned long l_generation = 0;
+  while (true)
+  {
+    //poll a while, the next sweep usually follows soon
+    for (int s = 0; s < spinCount && generation.load(std::memory_order_acquire) == l_generation; s++)
+      std::this_thread::yield();
+    {
+      std::unique_lock<std::mutex> l_lock(mutex);
+      while (!stopping && generation.load(std::memory_order_relaxed) == l_generation)
+        wakeUp.wait(l_lock);
+      if (stopping)
+        return;
+      l_generation = generation.load(std::memory_order_relaxed);
+    }
+    work(i_worker);
+    busyThreads.fetch_sub(1, std::memory_order_release);
+  }
+}
@@ -0,0 +1,159 @@
+/**
+ * @file ThreadPool.hh
+ * @brief Persistent thread pool, which balances the tasks of a loop by work-stealing
+ *
+ * The blocks use it in place of OpenMP, if one is set (see SWE_Block::setThreadPool()).
+ * The threads are started once and wait for the next loop between the sweeps,
+ * so a sweep costs no fork of a thread team. The tasks are usually the tiles of
+ * the activity mask: their costs vary with the quiet tiles, which are skipped,
+ * and a thread, which runs out of tasks, steals half of the remaining ones of another.
+ */
+
+#ifndef _SWE_THREAD_POOL_HH
+#define _SWE_THREAD_POOL_HH
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace tools
+{
+
+/**
+ * @brief Runs the tasks of a loop on a fixed number of threads
+ *
+ * The tasks [0, n) are split into one contiguous range per thread. A thread takes the tasks of
+ * its range from the front, a thread without tasks steals the back half of the range of another one,
+ * so neighbouring tasks mostly stay on the same thread. The calling thread is worker 0.
+ * The ranges start the same in every loop, so, apart from the stolen tasks,
+ * a worker works on the same tiles in every loop.
+ * The loops of one pool must not be nested or run concurrently.
+ */
+class ThreadPool
+{
+  private:
+    //! Range of tasks of a thread, padded to its own cache line
+    struct Queue
+    {
+      std::mutex mutex;
+      int begin;
+      int end;
+      char padding[64];
+    };
+
+    //! Partial result of a thread, padded to its own cache line
+    struct Partial
+    {
+      float value;
+      char padding[64];
+    };
+
+    //! Keeps the maximum of the results of a body per thread
+    template <class Body>
+    struct MaxReduction
+    {
+      Body& body;
+      std::vector<Partial>& partials;
+      MaxReduction(Body& i_body, std::vector<Partial>& i_partials) : body(i_body), partials(i_partials) {}
+      void operator()(int i_task, int i_worker) { partials[i_worker].value = std::max(partials[i_worker].value, body(i_task, i_worker)); }
+    };
+
+    //! Calls the body of a loop
+    template <class Body>
+    static void callBody(void* i_body, int i_task, int i_worker) { (*static_cast<Body*>(i_body))(i_task, i_worker); }
+
+    //! Amount of threads, including the calling one
+    int numThreads;
+    //! Logical CPUs of the workers, empty if they are not pinned
+    std::vector<int> cpus;
+    //! Task ranges of the threads
+    std::vector<Queue> queues;
+    //! The threads besides the calling one
+    std::vector<std::thread> threads;
+
+    //! Protects the start of a loop and the shutdown, for the threads waiting on wakeUp
+    std::mutex mutex;
+    //! Wakes the waiting threads at the start of a loop
+    std::condition_variable wakeUp;
+    //! Counts the loops, a thread runs a loop, when the counter changes
+    std::atomic<unsigned long> generation;
+    //! Threads, which have not finished the current loop
+    std::atomic<int> busyThreads;
+    //! Wether the threads shall exit
+    bool stopping;
+
+    //! Body of the current loop
+    void (*function)(void*, int, int);
+    void* body;
+
+    /**
+     * @brief Runs function(body, task, worker) for the tasks [0, n)
+     */
+    void execute(int i_numTasks, void (*i_function)(void*, int, int), void* i_body);
+
+    /**
+     * @brief Runs tasks of the current loop, until none is left to take or to steal
+     */
+    void work(int i_worker);
+
+    /**
+     * @brief Main loop of the threads besides the calling one
+     */
+    void wait(int i_worker);
+
+  public:
+    /**
+     * @brief Starts the threads
+     *
+     * @param i_numThreads Amount of threads, including the calling one
+     * @param i_cpus Logical CPU of every worker (see Pinning), the calling thread is pinned to the first one.
+     *  The workers are not pinned, if it is empty.
+     */
+    explicit ThreadPool(int i_numThreads, const std::vector<int>& i_cpus = std::vector<int>());
+
+    /**
+     * @brief Stops and joins the threads
+     */
+    ~ThreadPool();
+
+    /**
+     * @return Amount of threads, including the calling one
+     */
+    int getNumThreads() const { return numThreads; }
+
+    /**
+     * @brief Runs i_body(task, worker) for the tasks [0, n) and returns, when all are done
+     *
+     * The worker is the index of the running thread in [0, getNumThreads()),
+     * the tasks of one worker never run concurrently, so per worker buffers need no locks.
+     * The body must not throw.
+     */
+    template <class Body>
+    void run(int i_numTasks, Body& i_body) { execute(i_numTasks, &callBody<Body>, &i_body); }
+
+    /**
+     * @brief Runs the tasks like run() and returns the maximum of the results of i_body(task, worker)
+     *
+     * @return Maximum result, zero without tasks
+     */
+    template <class Body>
+    float reduceMax(int i_numTasks, Body& i_body)
+    {
+      std::vector<Partial> l_partials(numThreads);
+      for (int w = 0; w < numThreads; w++)
+        l_partials[w].value = 0.f;
+      MaxReduction<Body> l_reduction(i_body, l_partials);
+      run(i_numTasks, l_reduction);
+      float l_max = 0.f;
+      for (int w = 0; w < numThreads; w++)
+        l_max = std::max(l_max, l_partials[w].value);
+      return l_max;
+    }
+};
+
+}
+
+#endif
@@ -29,92 +29,123 @@
 #ifndef __HELP_HH
 #define __HELP_HH
 
+#include <cstdlib>
 #include <cstring>
 #include <iostream>
 #include <fstream>
+#include <new>
 #include <sstream>
 
+#include "tools/ReducedFloat.hh"
+
 /**
- * class Float1D is a proxy class that can represent, for example, 
- * a column or row vector of a Float2D array, where row (sub-)arrays 
+ * class Array1D is a proxy class that can represent, for example, 
+ * a column or row vector of an Array2D array, where row (sub-)arrays 
  * are stored with a respective stride. 
  * Besides constructor/deconstructor, the class provides overloading of 
  * the []-operator, such that elements can be accessed as v[i] 
  * (independent of the stride).
  * The class will never allocate separate memory for the vectors, 
- * but point to the interior data structure of Float2D (or other "host" 
+ * but point to the interior data structure of Array2D (or other "host" 
  * data structures).
+ * The element type T is float, or one of the storage types of ReducedFloat.hh.
  */ 
-class Float1D
+template <typename T>
+class Array1D
 {
   public:
-	Float1D(float* _elem, int _rows, int _stride = 1) 
+	Array1D(T* _elem, int _rows, int _stride = 1) 
 	: rows(_rows),stride(_stride),elem(_elem)
 	{
 	}
 
-	~Float1D()
+	~Array1D()
 	{
 	}
 
-	inline float& operator[](int i) { 
+	inline T& operator[](int i) { 
 		return elem[i*stride]; 
 	}
 
-	inline const float& operator[](int i) const {
+	inline const T& operator[](int i) const {
 		return elem[i*stride]; 
 	}
 
-	inline float* elemVector() {
+	inline T* elemVector() {
 		return elem;
 	}
 
         inline int getSize() const { return rows; }; 
 
+        inline int getStride() const { return stride; };
+
   private:
     int rows;
     int stride;
-    float* elem;
+    T* elem;
 };
 
+/// proxy class of the float arrays
+typedef Array1D<float> Float1D;
+
 /**
- * class Float2D is a very basic helper class to deal with 2D float arrays:
+ * class Array2D is a very basic helper class to deal with 2D arrays:
  * indices represent columns (1st index, "horizontal"/x-coordinate) and 
  * rows (2nd index, "vertical"/y-coordinate) of a 2D grid;
  * values are sequentially ordered in memory using "column major" order.
  * Besides constructor/deconstructor, the class provides overloading of 
  * the []-operator, such that elements can be accessed as a[i][j]. 
+ *
+ * Allocated arrays are aligned to 64 bytes (a cache line). Optionally, the columns
+ * are padded, such that each column starts at a cache line as well: the stride
+ * between the columns is then a multiple of 64 bytes, but no multiple of 1 KiB, which would
+ * map neighbouring columns of power-of-two grids to the same cache sets.
+ *
+ * The element type T is float (see the typedef Float2D), or one of the 16-bit storage types
+ * of ReducedFloat.hh, which are converted to float whenever an element is read.
  */ 
-class Float2D {
+template <typename T>
+class Array2D {
   public:
   	/**
      * Constructor:
-	   * takes size of the 2D array as parameters and creates a respective Float2D object;
-		 * allocates memory for the array, but does not initialise value.
+	   * takes size of the 2D array as parameters and creates a respective Array2D object;
+		 * allocates memory for the array and initialises it with zero.
+     * The memory is first touched in parallel, by the same static OpenMP schedule over the
+     * columns as used by the compute loops, so that the pages are placed on the NUMA node
+     * of the thread, which works on them.
      * @param _cols	number of columns (i.e., elements in horizontal direction)
      * @param _rows rumber of rows (i.e., elements in vertical directions)
+     * @param _allocateMemory wether to allocate the memory
+     * @param _padded wether to pad the columns to full cache lines
      */
-    Float2D(int _cols, int _rows, bool _allocateMemory = true):
+    Array2D(int _cols, int _rows, bool _allocateMemory = true, bool _padded = false):
       rows(_rows),
       cols(_cols),
+      stride(_padded ? paddedStride(_rows) : _rows),
       allocateMemory(_allocateMemory) {
       if (_allocateMemory) {
-        elem = new float[rows*cols];
+        allocate();
+#pragma omp parallel for schedule(static)
+        for (int i=0; i<cols; i++) {
+          std::memset(static_cast<void*>(elem + stride*i), 0, stride*sizeof(T));
+        }
       }
 	  }
 
     /**
      * Constructor:
-		 * takes size of the 2D array as parameters and creates a respective Float2D object;
+		 * takes size of the 2D array as parameters and creates a respective Array2D object;
 		 * this constructor does not allocate memory for the array, but uses the allocated memory 
 		 * provided via the respective variable #_elem 
      * @param _cols	number of columns (i.e., elements in horizontal direction)
      * @param _rows rumber of rows (i.e., elements in vertical directions)
      * @param _elem pointer to a suitably allocated region of memory to be used for thew array elements
      */
-    Float2D(int _cols, int _rows, float* _elem):
+    Array2D(int _cols, int _rows, T* _elem):
       rows(_rows),
       cols(_cols),
+      stride(_rows),
       allocateMemory(false) {
 		  elem = _elem;
 	  }
@@ -122,70 +153,116 @@ class Float2D {
 
     /**
      * Constructor:
-     * takes size of the 2D array as parameters and creates a respective Float2D object;
+     * takes size of the 2D array as parameters and creates a respective Array2D object;
      * this constructor does not allocate memory for the array, but uses the allocated memory
      * provided via the respective variable #_elem
      * @param _cols number of columns (i.e., elements in horizontal direction)
      * @param _rows rumber of rows (i.e., elements in vertical directions)
      * @param _elem pointer to a suitably allocated region of memory to be used for thew array elements
      */
-    Float2D(Float2D& _elem, bool shallowCopy):
+    Array2D(Array2D& _elem, bool shallowCopy):
       rows(_elem.rows),
       cols(_elem.cols),
+      stride(_elem.stride),
       allocateMemory(!shallowCopy) {
       if (shallowCopy) {
         elem = _elem.elem;
         allocateMemory = false;
       }
       else {
-        elem = new float[rows*cols];
-        for (int i=0; i<rows*cols; i++) {
-          elem[i] = _elem.elem[i];
+        allocate();
+#pragma omp parallel for schedule(static)
+        for (int i=0; i<cols; i++) {
+          std::memcpy(static_cast<void*>(elem + stride*i), _elem.elem + stride*i, stride*sizeof(T));
         }
         allocateMemory = true;
       }
     }
 
-	  ~Float2D() {
+	  ~Array2D() {
 		  if (allocateMemory) {
-		    delete[] elem;
+		    std::free(elem);
 		  }
   	}
 
-	  inline float* operator[](int i) {
-  		return (elem + (rows * i));
+	  inline T* operator[](int i) {
+  		return (elem + (stride * i));
   	}
 
-	  inline float const* operator[](int i) const {
-  		return (elem + (rows * i));
+	  inline T const* operator[](int i) const {
+  		return (elem + (stride * i));
   	}
 
-	inline float* elemVector() {
+	inline T* elemVector() {
 		return elem;
 	}
 
         inline int getRows() const { return rows; }; 
         inline int getCols() const { return cols; }; 
+        /// distance between the first elements of two neighbouring columns (rows, if not padded)
+        inline int getStride() const { return stride; }; 
 
-	inline Float1D getColProxy(int i) {
+	inline Array1D<T> getColProxy(int i) {
 		// subarray elem[i][*]:
                 // starting at elem[i][0] with rows elements and unit stride
-		return Float1D(elem + (rows * i), rows);
+		return Array1D<T>(elem + (stride * i), rows);
 	};
 	
-	inline Float1D getRowProxy(int j) {
+	inline Array1D<T> getRowProxy(int j) {
 		// subarray elem[*][j]
-                // starting at elem[0][j] with cols elements and stride rows
-		return Float1D(elem + j, cols, rows);
+                // starting at elem[0][j] with cols elements and the column stride
+		return Array1D<T>(elem + j, cols, stride);
 	};
 
   private:
+    /// alignment of the allocated memory in bytes (one cache line)
+    static const int alignment = 64;
+
+    /// returns the column stride for the given number of rows, see the class description
+    static int paddedStride(int _rows) {
+      const int elemsPerLine = alignment / sizeof(T);
+      int paddedRows = (_rows + elemsPerLine - 1) / elemsPerLine * elemsPerLine;
+      if (paddedRows * sizeof(T) % (16 * alignment) == 0)
+        paddedRows += elemsPerLine;
+      return paddedRows;
+    }
+
+    /// allocates the aligned memory for all columns
+    void allocate() {
+      void* memory;
+      if (posix_memalign(&memory, alignment, (size_t) stride * cols * sizeof(T)) != 0)
+        throw std::bad_alloc();
+      elem = static_cast<T*>(memory);
+    }
+
     int rows;
     int cols;
-    float* elem;
+    int stride;
+    T* elem;
 	bool allocateMemory;
 };
 
+/// 2D float arrays
+typedef Array2D<float> Float2D;
+
+/// 2D arrays of the storage type of the unknowns (float, unless built with reduced precision storage)
+typedef Array2D<StorageFloat> Storage2D;
+/// proxy class of the arrays of the unknowns
+typedef Array1D<StorageFloat> Storage1D;
+
+/**
+ * Converts the unknowns to float, e.g., for the output; both arrays have the same size.
+ */
+template <typename T>
+inline void convertToFloat(const Array2D<T>& i_src, Float2D& o_dst) {
+#pragma omp parallel for schedule(static)
+  for (int i=0; i<i_src.getCols(); i++) {
+    for (int j=0; j<i_src.getRows(); j++) {
+      o_dst[i][j] = i_src[i][j];
+    }
+  }
+}
+
 //-------- Methods for Visualistion of Results --------
 
 /**
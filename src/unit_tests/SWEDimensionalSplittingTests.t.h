@@ -0,0 +1,186 @@
+/**
+ * @file SWEDimensionalSplittingTests.t.h
+ * @brief Unit tests for the dimensional splitting blocks, split into several blocks
+ */
+
+#include <cxxtest/TestSuite.h>
+
+#include <limits>
+#include <sstream>
+#include <string>
+
+using namespace std;
+
+#include "blocks/SWE_DimensionalSplittingBlock.hh"
+#include "scenarios/SWE_Scenario.hh"
+
+namespace swe_tests
+{
+    class SWEDimensionalSplittingTestsSuite;
+}
+
+/**
+ * @brief Compares a block with two blocks, which split its domain in y direction
+ *
+ * The blocks run the time steps of the MPI driver (see simulateTimeStepDimensionalSplitting() in swe_mpi.cpp):
+ * the bottom and top ghost layers are exchanged after the horizontal sweep, and the time step is the
+ * minimum of both blocks. The split blocks have to give the same unknowns as the single block.
+ * The blocks run the unfused sweeps, since the fused sweeps need the f-wave solver, which does not flood a dry bed.
+ */
+class swe_tests::SWEDimensionalSplittingTestsSuite : public CxxTest::TestSuite
+{
+
+    private:
+
+        //! Cells of the single block in each direction, the split blocks have half of the rows each
+        static const int n = 32;
+
+        //! Dam break in the lower left part of the domain [0,1]x[0,1], which floods the dry bed above the split
+        class DryBedDamBreakScenario : public SWE_Scenario
+        {
+            public:
+                float getWaterHeight(float x, float y) { return (x < 0.5f && y < 0.25f) ? 2.f : 0.f; }
+                float getBathymetry(float x, float y) { return (y > 0.75f) ? 0.1f : 0.f; }
+        };
+
+        //! Copies the copy layer at the edge i_from of block i_sender into the ghost layer at the edge i_to of block i_receiver
+        static void copyLayer(SWE_Block& i_sender, BoundaryEdge i_from, SWE_Block& i_receiver, BoundaryEdge i_to)
+        {
+            SWE_Block1D* l_copyLayer = i_sender.registerCopyLayer(i_from);
+            SWE_Block1D* l_ghostLayer = i_receiver.grabGhostLayer(i_to);
+            // the MPI exchange sends the rows without the corners
+            for (int i = 1; i <= n; i++)
+            {
+                l_ghostLayer->h[i] = l_copyLayer->h[i];
+                l_ghostLayer->hu[i] = l_copyLayer->hu[i];
+                l_ghostLayer->hv[i] = l_copyLayer->hv[i];
+            }
+            delete l_copyLayer;
+            delete l_ghostLayer;
+        }
+
+        //! Exchanges the bottom and top ghost layers of the blocks, from bottom to top
+        static void exchangeGhostLayers(SWE_DimensionalSplittingBlock* io_blocks[], int i_numBlocks)
+        {
+            for (int b = 0; b + 1 < i_numBlocks; b++)
+            {
+                copyLayer(*io_blocks[b], BND_TOP, *io_blocks[b + 1], BND_BOTTOM);
+                copyLayer(*io_blocks[b + 1], BND_BOTTOM, *io_blocks[b], BND_TOP);
+            }
+        }
+
+        /**
+         * @brief Runs the time steps of the driver on the blocks, which exchange their bottom and top ghost layers
+         *
+         * @param io_blocks Blocks, from bottom to top
+         * @param i_numBlocks Number of blocks
+         */
+        static void simulateTimeStep(SWE_DimensionalSplittingBlock* io_blocks[], int i_numBlocks)
+        {
+            float l_maxTimeStep = numeric_limits<float>::max();
+            for (int b = 0; b < i_numBlocks; b++)
+            {
+                SWE_DimensionalSplittingBlock& l_block = *io_blocks[b];
+                l_block.setGhostLayer();
+                l_block.computeMaxTimestep(l_block.computeNumericalFluxesHorizontal(), l_block.getMaxCellSpeedVertical());
+                l_maxTimeStep = min(l_maxTimeStep, l_block.getMaxTimestep());
+            }
+
+            for (int b = 0; b < i_numBlocks; b++)
+                io_blocks[b]->updateUnknownsHorizontal(l_maxTimeStep);
+
+            // exchange the bottom and top ghost layers after the horizontal sweep
+            exchangeGhostLayers(io_blocks, i_numBlocks);
+
+            for (int b = 0; b < i_numBlocks; b++)
+            {
+                SWE_DimensionalSplittingBlock& l_block = *io_blocks[b];
+                l_block.setGhostLayer();
+                l_block.addBottomTopGhostLayersToTileActivity();
+                l_block.computeNumericalFluxesVertical();
+                l_block.updateUnknownsVertical(l_maxTimeStep);
+            }
+        }
+
+        /**
+         * @brief Compares the single block with the split blocks over the time steps, in which the dam break floods the split
+         */
+        template <class RiemannSolver>
+        void compareSplitBlocks()
+        {
+            DryBedDamBreakScenario l_scenario;
+            const float l_cellSize = 1.f / n;
+            const int l_tileSize = 4;
+
+            SWE_DimensionalSplittingBlockT<RiemannSolver> l_single(n, n, l_cellSize, l_cellSize, 1);
+            SWE_DimensionalSplittingBlockT<RiemannSolver> l_bottom(n, n / 2, l_cellSize, l_cellSize, 1);
+            SWE_DimensionalSplittingBlockT<RiemannSolver> l_top(n, n / 2, l_cellSize, l_cellSize, 1);
+
+            SWE_DimensionalSplittingBlock* l_singleBlocks[1] = {&l_single};
+            SWE_DimensionalSplittingBlock* l_splitBlocks[2] = {&l_bottom, &l_top};
+            for (int b = 0; b < 3; b++)
+            {
+                SWE_DimensionalSplittingBlock& l_block = (b == 0) ? l_single : *l_splitBlocks[b - 1];
+                l_block.setTileSize(l_tileSize);
+                l_block.initScenario(0.f, (b == 2) ? 0.5f : 0.f, l_scenario, true);
+                l_block.setBoundaryType(BND_LEFT, WALL);
+                l_block.setBoundaryType(BND_RIGHT, WALL);
+                if (b != 2)
+                    l_block.setBoundaryType(BND_BOTTOM, WALL);
+                if (b != 1)
+                    l_block.setBoundaryType(BND_TOP, WALL);
+            }
+
+            // the initial exchange of the ghost layers
+            exchangeGhostLayers(l_splitBlocks, 2);
+
+            bool l_flooded = false;
+            for (int step = 0; step < 60; step++)
+            {
+                simulateTimeStep(l_singleBlocks, 1);
+                simulateTimeStep(l_splitBlocks, 2);
+
+                // the cells, which differ from the single block
+                int l_differentCells = 0;
+                for (int i = 1; i <= n; i++)
+                    for (int j = 1; j <= n; j++)
+                    {
+                        SWE_Block& l_split = (j <= n / 2) ? (SWE_Block&) l_bottom : (SWE_Block&) l_top;
+                        const int l_j = (j <= n / 2) ? j : j - n / 2;
+                        if (l_single.getWaterHeight()[i][j] != l_split.getWaterHeight()[i][l_j]
+                            || l_single.getDischarge_hu()[i][j] != l_split.getDischarge_hu()[i][l_j]
+                            || l_single.getDischarge_hv()[i][j] != l_split.getDischarge_hv()[i][l_j])
+                            l_differentCells++;
+                    }
+                ostringstream l_step;
+                l_step << "time step " << step;
+                TSM_ASSERT_EQUALS(l_step.str(), l_differentCells, 0);
+                if (l_differentCells > 0)
+                    return;
+
+                for (int i = 1; i <= n; i++)
+                    l_flooded = l_flooded || l_top.getWaterHeight()[i][1] > 0.f;
+            }
+
+            // the flood has to reach the top block, otherwise the test does not cover the exchange
+            TS_ASSERT(l_flooded);
+        }
+
+    public:
+
+        /**
+         * @test The split blocks with the augmented Riemann solver give the same unknowns as the single block
+         */
+        void testSplitBlocksAugRie()
+        {
+            compareSplitBlocks<solver::AugRie<float> >();
+        }
+
+        /**
+         * @test The split blocks with the hybrid solver give the same unknowns as the single block
+         */
+        void testSplitBlocksHybrid()
+        {
+            compareSplitBlocks<solver::Hybrid<float> >();
+        }
+};
@@ -0,0 +1,179 @@
+/**
+ * @file SWEFastMathTests.t.h
+ * @brief Unit tests for the fast numerical mode
+ */
+
+#include <cxxtest/TestSuite.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+using namespace std;
+
+#include "tools/FastMath.hh"
+#include "blocks/SWE_FWaveBranchFree.hh"
+#include "scenarios/SWE_simple_scenarios.hh"            //uses min() of namespace std
+
+namespace swe_tests
+{
+    class SWEFastMathTestsSuite;
+}
+
+/**
+ * @brief Compares the approximations of the fast numerical mode with the exact computation
+ */
+class swe_tests::SWEFastMathTestsSuite : public CxxTest::TestSuite
+{
+
+    private:
+
+        //! Bound of the deviation of the fast mode on the bundled scenarios, relative to the largest value
+        static const float scenarioTolerance;
+
+        /**
+         * @brief Simulates the row through the centre of a scenario with the f-wave solver
+         *
+         * Outflow boundaries, CFL number 0.4, the unknowns are returned in h and hu.
+         */
+        template <bool fast>
+        void simulateRow(SWE_Scenario& scenario, int cells, int steps, vector<float>& h, vector<float>& hu)
+        {
+            const SWE_FWaveBranchFree solver;
+            const float left = scenario.getBoundaryPos(BND_LEFT);
+            const float dx = (scenario.getBoundaryPos(BND_RIGHT) - left) / cells;
+            const float y = 0.5f * (scenario.getBoundaryPos(BND_BOTTOM) + scenario.getBoundaryPos(BND_TOP));
+
+            h.assign(cells + 2, 0.f);
+            hu.assign(cells + 2, 0.f);
+            vector<float> b(cells + 2, 0.f);
+            for (int i = 1; i <= cells; i++)
+            {
+                h[i] = scenario.getWaterHeight(left + (i - 0.5f) * dx, y);
+                b[i] = scenario.getBathymetry(left + (i - 0.5f) * dx, y);
+            }
+
+            vector<float> hUpdateLeft(cells + 1), hUpdateRight(cells + 1);
+            vector<float> huUpdateLeft(cells + 1), huUpdateRight(cells + 1);
+            for (int step = 0; step < steps; step++)
+            {
+                h[0] = h[1]; hu[0] = hu[1]; b[0] = b[1];
+                h[cells + 1] = h[cells]; hu[cells + 1] = hu[cells]; b[cells + 1] = b[cells];
+
+                float maxWaveSpeed = 0.f;
+                for (int i = 0; i <= cells; i++)
+                {
+                    float edgeSpeed;
+                    solver.computeNetUpdatesT<fast>(h[i], h[i + 1], hu[i], hu[i + 1], b[i], b[i + 1],
+                        hUpdateLeft[i], hUpdateRight[i], huUpdateLeft[i], huUpdateRight[i], edgeSpeed);
+                    maxWaveSpeed = max(maxWaveSpeed, edgeSpeed);
+                }
+                if (maxWaveSpeed <= 0.f)
+                    break;
+
+                const float dtdx = 0.4f / maxWaveSpeed;
+                for (int i = 1; i <= cells; i++)
+                {
+                    h[i] -= dtdx * (hUpdateRight[i - 1] + hUpdateLeft[i]);
+                    hu[i] -= dtdx * (huUpdateRight[i - 1] + huUpdateLeft[i]);
+                }
+            }
+        }
+
+        /**
+         * @brief Maximum deviation of b from a, relative to the largest absolute value of a
+         */
+        float relativeDeviation(const vector<float>& a, const vector<float>& b)
+        {
+            float maxDeviation = 0.f, maxValue = 0.f;
+            for (size_t i = 0; i < a.size(); i++)
+            {
+                maxDeviation = max(maxDeviation, abs(a[i] - b[i]));
+                maxValue = max(maxValue, abs(a[i]));
+            }
+            return maxValue > 0.f ? maxDeviation / maxValue : maxDeviation;
+        }
+
+        void checkScenario(SWE_Scenario& scenario)
+        {
+            vector<float> h, hu, hFast, huFast;
+            simulateRow<false>(scenario, 200, 100, h, hu);
+            simulateRow<true>(scenario, 200, 100, hFast, huFast);
+
+            TS_ASSERT_LESS_THAN(relativeDeviation(h, hFast), scenarioTolerance);
+            TS_ASSERT_LESS_THAN(relativeDeviation(hu, huFast), scenarioTolerance);
+        }
+
+    public:
+
+        /**
+         * @test Relative error of the reciprocal square root
+         *
+         * The approximation scales exactly with powers of 4, so [1, 4) covers every positive normal float.
+         */
+        void testReciprocalSquareRoot()
+        {
+            double maxError = 0.;
+            for (float x = 1.f; x < 4.f; x = nextafter(x, 4.f))
+                maxError = max(maxError, abs(fastmath::rsqrt(x) * sqrt((double) x) - 1.));
+            TS_ASSERT_LESS_THAN(maxError, fastmath::rsqrtTolerance);
+
+            TS_ASSERT_DELTA(fastmath::rsqrt(1e-8f) * 1e-4f, 1.f, fastmath::rsqrtTolerance);
+            TS_ASSERT_DELTA(fastmath::rsqrt(1e8f) * 1e4f, 1.f, fastmath::rsqrtTolerance);
+            TS_ASSERT_EQUALS(0.f * fastmath::rsqrt(0.f), 0.f);
+        }
+
+        /**
+         * @test Net-updates of single edges, wet, dry and wet/dry
+         */
+        void testNetUpdates()
+        {
+            const SWE_FWaveBranchFree solver;
+            const float states[][6] = {
+                //hLeft, hRight, huLeft, huRight, bLeft, bRight
+                { 10.f, 12.f, 0.f, 0.f, -10.f, -10.f },
+                { 260.f, 260.f, 30.f, -5.f, -260.f, -255.f },
+                { 2.f, 0.f, 1.5f, 0.f, -2.f, 1.f },
+                { 0.f, 0.5f, 0.f, -0.2f, 3.f, -0.5f },
+                { 0.f, 0.f, 0.f, 0.f, 1.f, 2.f },
+                { 0.05f, 4000.f, 0.01f, 100.f, -0.05f, -4000.f }
+            };
+            for (int k = 0; k < 6; k++)
+            {
+                const float* s = states[k];
+                float exact[5], fast[5];
+                solver.computeNetUpdatesT<false>(s[0], s[1], s[2], s[3], s[4], s[5],
+                    exact[0], exact[1], exact[2], exact[3], exact[4]);
+                solver.computeNetUpdatesT<true>(s[0], s[1], s[2], s[3], s[4], s[5],
+                    fast[0], fast[1], fast[2], fast[3], fast[4]);
+
+                //the net-updates are bounded by the flux jumps, which scale with h * (|u| + sqrt(gh))
+                const float scale = max(s[0], s[1]) * exact[4] + 1e-6f;
+                for (int l = 0; l < 4; l++)
+                    TS_ASSERT_DELTA(fast[l], exact[l], 1e-4f * scale);
+                TS_ASSERT_DELTA(fast[4], exact[4], 1e-4f * exact[4]);
+            }
+        }
+
+        /**
+         * @test Deviation of the fast mode on the bundled scenarios
+         */
+        void testScenarios()
+        {
+            BoundaryType outflow[4] = { OUTFLOW, OUTFLOW, OUTFLOW, OUTFLOW };
+            SWE_RadialDamBreakScenario radialDamBreak(outflow);
+            SWE_BathymetryDamBreakScenario bathymetryDamBreak;
+            SWE_SeaAtRestScenario seaAtRest;
+            SWE_SplashingPoolScenario splashingPool;
+            SWE_SplashingConeScenario splashingCone;
+
+            checkScenario(radialDamBreak);
+            checkScenario(bathymetryDamBreak);
+            checkScenario(seaAtRest);
+            checkScenario(splashingPool);
+            checkScenario(splashingCone);
+        }
+
+};
+
+const float swe_tests::SWEFastMathTestsSuite::scenarioTolerance = 1e-4f;
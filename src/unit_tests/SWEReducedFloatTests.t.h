@@ -0,0 +1,237 @@
+/**
+ * @file SWEReducedFloatTests.t.h
+ * @brief Unit tests for the 16-bit storage of the unknowns
+ */
+
+#include <cxxtest/TestSuite.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+using namespace std;
+
+#include "tools/ReducedFloat.hh"
+#include "blocks/SWE_FWaveBranchFree.hh"
+#include "scenarios/SWE_simple_scenarios.hh"            //uses min() of namespace std
+
+namespace swe_tests
+{
+    class SWEReducedFloatTestsSuite;
+}
+
+/**
+ * @brief Compares the 16-bit storage types with float
+ *
+ * The scenario tests bound the error, which is documented for the storage build variable in compile_swe.md.
+ */
+class swe_tests::SWEReducedFloatTestsSuite : public CxxTest::TestSuite
+{
+
+    private:
+
+        //! Bounds of the deviation from float storage on the bundled scenarios, relative to the largest value
+        static const float halfScenarioTolerance;
+        static const float bfloat16ScenarioTolerance;
+
+        /**
+         * @brief Largest relative rounding error of the conversion to StorageReal over all floats in [1, 2)
+         *
+         * The rounding scales exactly with powers of 2 in the normal range of the type.
+         */
+        template <class StorageReal>
+        double maxRoundingError()
+        {
+            double maxError = 0.;
+            for (float x = 1.f; x < 2.f; x = nextafter(x, 2.f))
+                maxError = max(maxError, abs((double) (float) StorageReal(x) - x) / x);
+            return maxError;
+        }
+
+        /**
+         * @brief Simulates the row through the centre of a scenario with the f-wave solver
+         *
+         * The unknowns are stored as StorageReal, the net-updates are computed in float.
+         * Outflow boundaries, CFL number 0.4, the unknowns are returned in h and hu.
+         */
+        template <class StorageReal>
+        void simulateRow(SWE_Scenario& scenario, int cells, int steps, vector<float>& o_h, vector<float>& o_hu)
+        {
+            const SWE_FWaveBranchFree solver;
+            const float left = scenario.getBoundaryPos(BND_LEFT);
+            const float dx = (scenario.getBoundaryPos(BND_RIGHT) - left) / cells;
+            const float y = 0.5f * (scenario.getBoundaryPos(BND_BOTTOM) + scenario.getBoundaryPos(BND_TOP));
+
+            vector<StorageReal> h(cells + 2, 0.f), hu(cells + 2, 0.f), b(cells + 2, 0.f);
+            for (int i = 1; i <= cells; i++)
+            {
+                h[i] = scenario.getWaterHeight(left + (i - 0.5f) * dx, y);
+                b[i] = scenario.getBathymetry(left + (i - 0.5f) * dx, y);
+            }
+
+            vector<float> hUpdateLeft(cells + 1), hUpdateRight(cells + 1);
+            vector<float> huUpdateLeft(cells + 1), huUpdateRight(cells + 1);
+            for (int step = 0; step < steps; step++)
+            {
+                h[0] = h[1]; hu[0] = hu[1]; b[0] = b[1];
+                h[cells + 1] = h[cells]; hu[cells + 1] = hu[cells]; b[cells + 1] = b[cells];
+
+                float maxWaveSpeed = 0.f;
+                for (int i = 0; i <= cells; i++)
+                {
+                    float edgeSpeed;
+                    solver.computeNetUpdatesT<false>(h[i], h[i + 1], hu[i], hu[i + 1], b[i], b[i + 1],
+                        hUpdateLeft[i], hUpdateRight[i], huUpdateLeft[i], huUpdateRight[i], edgeSpeed);
+                    maxWaveSpeed = max(maxWaveSpeed, edgeSpeed);
+                }
+                if (maxWaveSpeed <= 0.f)
+                    break;
+
+                const float dtdx = 0.4f / maxWaveSpeed;
+                for (int i = 1; i <= cells; i++)
+                {
+                    h[i] -= dtdx * (hUpdateRight[i - 1] + hUpdateLeft[i]);
+                    hu[i] -= dtdx * (huUpdateRight[i - 1] + huUpdateLeft[i]);
+                }
+            }
+
+            o_h.assign(h.begin(), h.end());
+            o_hu.assign(hu.begin(), hu.end());
+        }
+
+        /**
+         * @brief Maximum deviation of b from a, relative to the largest absolute value of a
+         */
+        float relativeDeviation(const vector<float>& a, const vector<float>& b)
+        {
+            float maxDeviation = 0.f, maxValue = 0.f;
+            for (size_t i = 0; i < a.size(); i++)
+            {
+                maxDeviation = max(maxDeviation, abs(a[i] - b[i]));
+                maxValue = max(maxValue, abs(a[i]));
+            }
+            return maxValue > 0.f ? maxDeviation / maxValue : maxDeviation;
+        }
+
+        /**
+         * @brief Maximum deviation of huReduced from hu, relative to the momentum h * sqrt(g * h) of the deepest cell
+         *
+         * The momentum of a scenario may be zero (sea at rest), so it is not a scale of its own.
+         */
+        float momentumDeviation(const vector<float>& h, const vector<float>& hu, const vector<float>& huReduced)
+        {
+            const float maxHeight = *max_element(h.begin(), h.end());
+            float maxDeviation = 0.f;
+            for (size_t i = 0; i < hu.size(); i++)
+                maxDeviation = max(maxDeviation, abs(hu[i] - huReduced[i]));
+            return maxDeviation / (maxHeight * sqrt(9.81f * maxHeight));
+        }
+
+        template <class StorageReal>
+        void checkScenario(SWE_Scenario& scenario, float tolerance)
+        {
+            vector<float> h, hu, hReduced, huReduced;
+            simulateRow<float>(scenario, 200, 100, h, hu);
+            simulateRow<StorageReal>(scenario, 200, 100, hReduced, huReduced);
+
+            TS_ASSERT_LESS_THAN(relativeDeviation(h, hReduced), tolerance);
+            TS_ASSERT_LESS_THAN(momentumDeviation(h, hu, huReduced), tolerance);
+        }
+
+        template <class StorageReal>
+        void checkScenarios(float tolerance)
+        {
+            BoundaryType outflow[4] = { OUTFLOW, OUTFLOW, OUTFLOW, OUTFLOW };
+            SWE_RadialDamBreakScenario radialDamBreak(outflow);
+            SWE_BathymetryDamBreakScenario bathymetryDamBreak;
+            SWE_SeaAtRestScenario seaAtRest;
+            SWE_SplashingPoolScenario splashingPool;
+            SWE_SplashingConeScenario splashingCone;
+
+            checkScenario<StorageReal>(radialDamBreak, tolerance);
+            checkScenario<StorageReal>(bathymetryDamBreak, tolerance);
+            checkScenario<StorageReal>(seaAtRest, tolerance);
+            checkScenario<StorageReal>(splashingPool, tolerance);
+            checkScenario<StorageReal>(splashingCone, tolerance);
+        }
+
+    public:
+
+        /**
+         * @test Rounding of float to half precision: to nearest, ties to even, overflow to infinity
+         */
+        void testHalfConversion()
+        {
+            TS_ASSERT_LESS_THAN_EQUALS(maxRoundingError<Half>(), ldexp(1., -11));
+
+            TS_ASSERT_EQUALS((float) Half(1.f + ldexp(1.f, -11)), 1.f);
+            TS_ASSERT_EQUALS((float) Half(1.f + 3.f * ldexp(1.f, -11)), 1.f + ldexp(1.f, -9));
+            TS_ASSERT_EQUALS((float) Half(-0.375f), -0.375f);
+            TS_ASSERT_EQUALS((float) Half(65504.f), 65504.f);
+            TS_ASSERT_EQUALS((float) Half(70000.f), numeric_limits<float>::infinity());
+            //smallest subnormal
+            TS_ASSERT_EQUALS((float) Half(ldexp(1.f, -24)), ldexp(1.f, -24));
+            TS_ASSERT_EQUALS((float) Half(ldexp(1.f, -26)), 0.f);
+            TS_ASSERT((float) Half(numeric_limits<float>::quiet_NaN()) != (float) Half(numeric_limits<float>::quiet_NaN()));
+        }
+
+        /**
+         * @test Rounding of float to bfloat16: to nearest, ties to even, NaNs stay NaNs
+         */
+        void testBFloat16Conversion()
+        {
+            TS_ASSERT_LESS_THAN_EQUALS(maxRoundingError<BFloat16>(), ldexp(1., -8));
+
+            TS_ASSERT_EQUALS((float) BFloat16(1.f + ldexp(1.f, -8)), 1.f);
+            TS_ASSERT_EQUALS((float) BFloat16(1.f + 3.f * ldexp(1.f, -8)), 1.f + ldexp(1.f, -6));
+            TS_ASSERT_EQUALS((float) BFloat16(-0.375f), -0.375f);
+            //range of float
+            TS_ASSERT_LESS_THAN_EQUALS(abs(BFloat16(1e38f) / 1e38 - 1.), ldexp(1., -8));
+            TS_ASSERT((float) BFloat16(numeric_limits<float>::quiet_NaN()) != (float) BFloat16(numeric_limits<float>::quiet_NaN()));
+        }
+
+        /**
+         * @test Updates below half of the resolution of the water height are rounded away
+         *
+         * At a depth of 100 m, half precision resolves 6.25 cm and bfloat16 50 cm, at 4000 m 2 m and 16 m.
+         */
+        void testResolutionOfTheWaterHeight()
+        {
+            Half hHalf = 100.f;
+            hHalf += 0.03f;
+            TS_ASSERT_EQUALS((float) hHalf, 100.f);
+            hHalf += 0.04f;
+            TS_ASSERT_EQUALS((float) hHalf, 100.0625f);
+
+            BFloat16 hBFloat16 = 100.f;
+            hBFloat16 += 0.2f;
+            TS_ASSERT_EQUALS((float) hBFloat16, 100.f);
+            hBFloat16 += 0.3f;
+            TS_ASSERT_EQUALS((float) hBFloat16, 100.5f);
+
+            Half hDeepHalf = 4000.f;
+            hDeepHalf += 0.9f;
+            TS_ASSERT_EQUALS((float) hDeepHalf, 4000.f);
+        }
+
+        /**
+         * @test Deviation of the half precision storage on the bundled scenarios
+         */
+        void testHalfScenarios()
+        {
+            checkScenarios<Half>(halfScenarioTolerance);
+        }
+
+        /**
+         * @test Deviation of the bfloat16 storage on the bundled scenarios
+         */
+        void testBFloat16Scenarios()
+        {
+            checkScenarios<BFloat16>(bfloat16ScenarioTolerance);
+        }
+
+};
+
+const float swe_tests::SWEReducedFloatTestsSuite::halfScenarioTolerance = 1e-2f;
+const float swe_tests::SWEReducedFloatTestsSuite::bfloat16ScenarioTolerance = 1e-1f;
@@ -0,0 +1,111 @@
+/**
+ * @file SWEThreadPoolTests.t.h
+ * @brief Unit tests for the work-stealing thread pool
+ */
+
+#include <cxxtest/TestSuite.h>
+
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+using namespace std;
+
+#include "tools/Pinning.hh"
+#include "tools/ThreadPool.hh"
+
+namespace swe_tests
+{
+    class SWEThreadPoolTestsSuite;
+}
+
+/**
+ * @brief Runs loops of uneven tasks on pools of different sizes
+ */
+class swe_tests::SWEThreadPoolTestsSuite : public CxxTest::TestSuite
+{
+
+    private:
+
+        //! Counts the runs of every task and checks the worker index
+        struct CountTasks
+        {
+            vector<atomic<int> >& runs;
+            int numThreads;
+            atomic<int> badWorkers;
+            CountTasks(vector<atomic<int> >& i_runs, int i_numThreads) : runs(i_runs), numThreads(i_numThreads), badWorkers(0) {}
+            void operator()(int task, int worker)
+            {
+                if (worker < 0 || worker >= numThreads)
+                    badWorkers++;
+                //the first tasks are expensive, so the other threads have to steal them
+                volatile float sink = 0.f;
+                for (int k = 0; k < (task < 8 ? 20000 : 10); k++)
+                    sink += 1.f;
+                runs[task]++;
+            }
+        };
+
+        //! Returns the task index as its result
+        struct TaskValue
+        {
+            float operator()(int task, int) { return (float) task; }
+        };
+
+    public:
+
+        /**
+         * @test Every task runs exactly once, on a valid worker, also in consecutive loops
+         */
+        void testAllTasksRunOnce()
+        {
+            for (int numThreads = 1; numThreads <= 4; numThreads++)
+            {
+                tools::ThreadPool pool(numThreads);
+                TS_ASSERT_EQUALS(pool.getNumThreads(), numThreads);
+                for (int numTasks = 0; numTasks < 70; numTasks += 23)
+                {
+                    vector<atomic<int> > runs(numTasks);
+                    for (int t = 0; t < numTasks; t++)
+                        runs[t] = 0;
+                    CountTasks count(runs, numThreads);
+                    for (int loop = 0; loop < 3; loop++)
+                        pool.run(numTasks, count);
+                    for (int t = 0; t < numTasks; t++)
+                        TS_ASSERT_EQUALS(runs[t].load(), 3);
+                    TS_ASSERT_EQUALS(count.badWorkers.load(), 0);
+                }
+            }
+        }
+
+        /**
+         * @test Maximum of the results, zero without tasks
+         */
+        void testReduceMax()
+        {
+            tools::ThreadPool pool(3);
+            TaskValue value;
+            TS_ASSERT_EQUALS(pool.reduceMax(100, value), 99.f);
+            TS_ASSERT_EQUALS(pool.reduceMax(1, value), 0.f);
+            TS_ASSERT_EQUALS(pool.reduceMax(0, value), 0.f);
+        }
+
+        /**
+         * @test Mapping of the threads to a list of CPUs, which is reused for more threads
+         */
+        void testPinningList()
+        {
+            tools::Pinning pinning("0,2,4-5", 6);
+            const int expected[] = { 0, 2, 4, 5, 0, 2 };
+            TS_ASSERT_EQUALS(pinning.getCpus(), vector<int>(expected, expected + 6));
+
+            TS_ASSERT_THROWS(tools::Pinning("3-1", 2), std::runtime_error);
+            TS_ASSERT_THROWS(tools::Pinning("0,,1", 2), std::runtime_error);
+            TS_ASSERT_THROWS(tools::Pinning("nearest", 2), std::runtime_error);
+
+            //every thread gets one of the available CPUs
+            tools::Pinning compact("compact", 3);
+            TS_ASSERT_EQUALS(compact.getCpus().size(), 3u);
+        }
+
+};
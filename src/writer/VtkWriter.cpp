@@ -39,8 +39,6 @@
  * @param i_offsetX x-offset of the block
  * @param i_offsetY y-offset of the block
  * @param i_dynamicBathymetry
- *
- * @todo This version can only handle a boundary layer of size 1
  */
 io::VtkWriter::VtkWriter( const std::string &i_baseName,
 		const Float2D &i_b,
@@ -88,29 +86,29 @@ void io::VtkWriter::writeTimeStep(
 
 	// Water surface height h
 	vtkFile << "<DataArray Name=\"h\" type=\"Float32\" format=\"ascii\">" << std::endl;
-	for (int j=1; j < nY+1; j++)
-		for (int i=1; i < nX+1; i++)
-			vtkFile << i_h[i][j] << std::endl;
+	for (int j=0; j < nY; j++)
+		for (int i=0; i < nX; i++)
+			vtkFile << i_h[i+boundarySize[0]][j+boundarySize[2]] << std::endl;
 	vtkFile << "</DataArray>" << std::endl;
 	
 	// Momentums
 	vtkFile << "<DataArray Name=\"hu\" type=\"Float32\" format=\"ascii\">" << std::endl;
-	for (int j=1; j < nY+1; j++)
-		for (int i=1; i < nX+1; i++)
-			vtkFile << i_hu[i][j] << std::endl;
+	for (int j=0; j < nY; j++)
+		for (int i=0; i < nX; i++)
+			vtkFile << i_hu[i+boundarySize[0]][j+boundarySize[2]] << std::endl;
 	vtkFile << "</DataArray>" << std::endl;
 
 	vtkFile << "<DataArray Name=\"hv\" type=\"Float32\" format=\"ascii\">" << std::endl;
-	for (int j=1; j < nY+1; j++)
-		for (int i=1; i<nX+1; i++)
-			vtkFile << i_hv[i][j] << std::endl;
+	for (int j=0; j < nY; j++)
+		for (int i=0; i < nX; i++)
+			vtkFile << i_hv[i+boundarySize[0]][j+boundarySize[2]] << std::endl;
 	vtkFile << "</DataArray>" << std::endl;
 
 	// Bathymetry
 	vtkFile << "<DataArray Name=\"b\" type=\"Float32\" format=\"ascii\">" << std::endl;
-	for (int j=1; j<nY+1; j++)
-		for (int i=1; i<nX+1; i++)
-			vtkFile << b[i][j] << std::endl;
+	for (int j=0; j < nY; j++)
+		for (int i=0; i < nX; i++)
+			vtkFile << b[i+boundarySize[0]][j+boundarySize[2]] << std::endl;
 	vtkFile << "</DataArray>" << std::endl;
 
 	vtkFile << "</CellData>" << std::endl